@@ -4,7 +4,12 @@ import serial
 import serial.tools.list_ports
 import threading
 import time
+import os
+import sys
 import random
+import struct
+import ctypes
+from collections import deque
 
 # ==============================================================================
 # [FCS K105A1 B-LINK]
@@ -14,23 +19,395 @@ import random
 # Protocol Constants
 STX = 0x02
 ETX = 0x03
-CMD_TARGET = 0xA1
+CMD_TARGET = 0xA1      # Legacy text payload "52,S,E,N,Alt"
+CMD_TARGET_BIN = 0xA2  # Binary FCS_TargetRecord_t
+CMD_TARGET_BATCH = 0xA3  # [first_idx][count][count x record]
+CMD_TARGET_DELTA = 0xA4  # [base][dE][dN][dAlt] zigzag varints (m)
+CMD_KNOWN_SET = 0xA5     # [id][record]
+CMD_FIRE_RESULT = 0xB1   # FCS_FireResult_t
+CMD_BATCH_RESULT = 0xB2  # [first_idx][count][count x result]
+CMD_KNOWN_ACK = 0xB3     # [id]
+CMD_STATUS_REQ = 0xC1
+CMD_STATUS_ACK = 0xC2    # FCS_StatusReply_t
+CMD_TELEM_SUB = 0xC3     # u16 period_ms, 0 = stop
+CMD_TELEMETRY = 0xC4     # [flags][count][mask][changed fields]
+CMD_STATS_REQ = 0xC5     # [start_idx][flags]
+CMD_STATS_ACK = 0xC6     # [start_idx][total][n x CMD_STAT]
+CMD_TASKS_REQ = 0xC7     # [start_idx][flags]
+CMD_TASKS_ACK = 0xC8     # [start_idx][total][n x TASK_STAT]
+CMD_PROBES_REQ = 0xC9    # [start_idx][flags]
+CMD_PROBES_ACK = 0xCA    # [start_idx][total][n x PROBE_STAT]
+CMD_BAUD_SET = 0xD1      # u32 baud
+CMD_BAUD_ACK = 0xD2      # u32 baud, sent at the old rate
+CMD_NAK = 0xE1           # [req_cmd][reason]
 MASTER_KEY = 0xA5
+BAUD_DEFAULT = 9600
+BAUD_RATES = [9600, 115200, 230400, 460800, 921600]
+BAUD_CONFIRM_MS = 1500     # Wait for the first reply at the new rate
+BAUD_KEEPALIVE_MS = 20000  # Firmware falls back to 9600 after 60 s idle
+FRAME_OVERHEAD = 7     # STX + CMD + SEQ + SALT + LEN + CRC + ETX
+PROTO_MAX_PAYLOAD = 120
+
+# Flow Control (firmware built with FCS_FLOW_CTRL): the serial driver pauses our
+# TX on RTS/CTS or XON/XOFF. With XON/XOFF the firmware escapes 0x11, 0x13 and
+# 0x7D in its replies as [0x7D][b ^ 0x20], so raw flow bytes never hit a frame.
+FLOW_MODES = ["NONE", "RTS/CTS", "XON/XOFF"]
+FLOW_ESC = 0x7D
+
+# COBS Framing (firmware built with FCS_PROTO_COBS=1):
+# COBS([CMD][SEQ][SALT][LEN][PAYLOAD][CRC]) + 0x00, same 7 bytes of overhead
+def cobs_encode(data):
+    out, block = bytearray(), bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out.extend(block)
+            block = bytearray()
+        else:
+            block.append(byte)
+            if len(block) == 254:
+                out.append(255)
+                out.extend(block)
+                block = bytearray()
+    out.append(len(block) + 1)
+    out.extend(block)
+    return bytes(out)
+
+def cobs_decode(data):
+    out, i = bytearray(), 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out.extend(data[i + 1:i + code])
+        i += code
+        if code < 255 and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+# Frame Version 1 (firmware built with FCS_PROTO_AEAD=1): ChaCha20-Poly1305.
+# SALT carries AEAD_VERSION, the payload is [SESS u32][CTR u32][ciphertext][tag].
+# Nonce = SESS|CTR|DIR (u32 LE each, DIR 0 = to the FCS, 1 = from it), the
+# header [CMD][SEQ][SALT][LEN] is authenticated. SESS is random per connection.
+AEAD_VERSION = 0x02
+AEAD_HDR = 8
+AEAD_TAG_LEN = 8           # Truncated tag, as FCS_AEAD_TAG_LEN
+AEAD_OVERHEAD = AEAD_HDR + AEAD_TAG_LEN
+AEAD_REPLAY_WINDOW = 32
+# Development key (FCS_AEAD_KEY_BYTES); provisioned units: FCS_AEAD_KEY=<64 hex digits>
+AEAD_KEY = bytes.fromhex(os.environ.get("FCS_AEAD_KEY", bytes(range(0x80, 0xA0)).hex()))
+AEAD_VECTORS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Tools", "aead_vectors.txt")
+
+def _rotl32(v, n):
+    return ((v << n) | (v >> (32 - n))) & 0xFFFFFFFF
+
+def chacha20_block(key, nonce, counter):
+    x = [0x61707865, 0x3320646E, 0x79622D32, 0x6B206574, *struct.unpack('<8I', key),
+         counter, *struct.unpack('<3I', nonce)]
+    w = list(x)
+    for _ in range(10):
+        for a, b, c, d in ((0, 4, 8, 12), (1, 5, 9, 13), (2, 6, 10, 14), (3, 7, 11, 15),
+                           (0, 5, 10, 15), (1, 6, 11, 12), (2, 7, 8, 13), (3, 4, 9, 14)):
+            w[a] = (w[a] + w[b]) & 0xFFFFFFFF; w[d] = _rotl32(w[d] ^ w[a], 16)
+            w[c] = (w[c] + w[d]) & 0xFFFFFFFF; w[b] = _rotl32(w[b] ^ w[c], 12)
+            w[a] = (w[a] + w[b]) & 0xFFFFFFFF; w[d] = _rotl32(w[d] ^ w[a], 8)
+            w[c] = (w[c] + w[d]) & 0xFFFFFFFF; w[b] = _rotl32(w[b] ^ w[c], 7)
+    return struct.pack('<16I', *((w[i] + x[i]) & 0xFFFFFFFF for i in range(16)))
+
+def chacha20_xor(key, nonce, counter, data):
+    out = bytearray(data)
+    for i in range(0, len(out), 64):
+        ks = chacha20_block(key, nonce, counter + i // 64)
+        for j in range(min(64, len(out) - i)):
+            out[i + j] ^= ks[j]
+    return bytes(out)
+
+def poly1305(key, msg, pad16=False):
+    # pad16: AEAD input, a short last block is zero-padded instead of 0x01-terminated
+    r = int.from_bytes(key[:16], 'little') & 0x0FFFFFFC0FFFFFFC0FFFFFFC0FFFFFFF
+    acc, p = 0, (1 << 130) - 5
+    for i in range(0, len(msg), 16):
+        blk = msg[i:i + 16]
+        if pad16:
+            blk = blk.ljust(16, b"\x00")
+        acc = (acc + int.from_bytes(blk + b"\x01", 'little')) * r % p
+    return ((acc + int.from_bytes(key[16:], 'little')) & ((1 << 128) - 1)).to_bytes(16, 'little')
+
+def aead_tag(key, nonce, aad, ct):
+    otk = chacha20_block(key, nonce, 0)[:32]
+    mac = (aad.ljust(-(-len(aad) // 16) * 16, b"\x00") + ct.ljust(-(-len(ct) // 16) * 16, b"\x00") +
+           struct.pack('<QQ', len(aad), len(ct)))
+    return poly1305(otk, mac)
+
+def aead_seal(key, nonce, aad, pt):
+    ct = chacha20_xor(key, nonce, 1, pt)
+    return ct, aead_tag(key, nonce, aad, ct)
+
+def aead_open(key, nonce, aad, ct, tag):
+    # Returns the plaintext, or None if the (possibly truncated) tag does not match
+    calc = aead_tag(key, nonce, aad, ct)
+    if not tag or calc[:len(tag)] != tag:
+        return None
+    return chacha20_xor(key, nonce, 1, ct)
+
+def aead_nonce(sess_ctr, direction):
+    return bytes(sess_ctr) + struct.pack('<I', direction)
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            if crc & 0x80:
+                crc = (crc << 1) ^ 0x07
+            else:
+                crc <<= 1
+        crc &= 0xFF
+    return crc
+
+def xor_crypt(data, salt):
+    # Rolling XOR (symmetric): Key = Master ^ Salt
+    session_key = MASTER_KEY ^ salt
+    return bytearray(byte ^ ((session_key + i) & 0xFF) for i, byte in enumerate(data))
+
+# Native Codec: the firmware's Core/Src/fcs_codec.c + fcs_aead.c as a shared
+# library, so frames are built and checked by the same code on both ends:
+#   gcc -O2 -shared -fPIC -ICore/Inc Core/Src/fcs_codec.c Core/Src/fcs_aead.c -o ClientApp/fcs_codec.so
+# (fcs_codec.dll / fcs_codec.dylib elsewhere; FCS_CODEC_LIB=<path> overrides).
+# Without it the Python code above is used; --selftest checks both against the vectors.
+CODEC_F_COBS = 0x01
+CODEC_F_AEAD = 0x02
+CODEC_DIR_TO_FCS = 0
+CODEC_DIR_FROM_FCS = 1
+CODEC_BUF = PROTO_MAX_PAYLOAD + FRAME_OVERHEAD + 1  # COBS worst case
+
+def load_codec():
+    path = os.environ.get("FCS_CODEC_LIB")
+    if path is None:
+        here = os.path.dirname(os.path.abspath(__file__))
+        found = [p for p in (os.path.join(here, "fcs_codec" + ext) for ext in (".so", ".dll", ".dylib"))
+                 if os.path.exists(p)]
+        if not found:
+            return None
+        path = found[0]
+    lib = ctypes.CDLL(path)
+    u8p, u8, u32 = ctypes.c_char_p, ctypes.c_uint8, ctypes.c_uint32
+    lib.FCS_Codec_Text_Ofs.argtypes, lib.FCS_Codec_Text_Ofs.restype = [u8], u8
+    lib.FCS_Codec_Seal.argtypes = [ctypes.c_void_p, u8, u8p, u32, u32, u8]
+    lib.FCS_Codec_Seal.restype = u8
+    lib.FCS_Codec_Open.argtypes, lib.FCS_Codec_Open.restype = [ctypes.c_void_p, u8, u8p, u8], ctypes.c_int
+    lib.FCS_Codec_Frame.argtypes, lib.FCS_Codec_Frame.restype = [ctypes.c_void_p, u8], u8
+    lib.FCS_Codec_Unframe.argtypes, lib.FCS_Codec_Unframe.restype = [ctypes.c_void_p, u8, u8], ctypes.c_int
+    lib.FCS_Codec_Scan.argtypes = [ctypes.c_void_p, u32, ctypes.POINTER(u32)]
+    lib.FCS_Codec_Scan.restype = u32
+    return lib
+
+CODEC = load_codec()
+
+def frame_build(cmd, seq, salt, text, flags, sess=0, ctr=0):
+    # Request wire bytes. With CODEC_F_AEAD, salt is replaced by AEAD_VERSION
+    if len(text) + (AEAD_OVERHEAD if flags & CODEC_F_AEAD else 0) > PROTO_MAX_PAYLOAD:
+        raise ValueError(f"payload of {len(text)} bytes does not fit a frame")
+    if CODEC:
+        ofs = CODEC.FCS_Codec_Text_Ofs(flags)
+        buf = ctypes.create_string_buffer(bytes([0, cmd, seq, salt, len(text)]) + bytes(ofs) + bytes(text), CODEC_BUF)
+        CODEC.FCS_Codec_Seal(ctypes.byref(buf, 1), flags, AEAD_KEY, sess, ctr, CODEC_DIR_TO_FCS)
+        n = CODEC.FCS_Codec_Frame(buf, flags)
+        return bytearray(buf.raw[:n])
+    if flags & CODEC_F_AEAD:
+        sess_ctr = struct.pack('<II', sess, ctr)
+        salt = AEAD_VERSION
+        aad = bytes([cmd, seq, salt, len(text) + AEAD_OVERHEAD])
+        ct, tag = aead_seal(AEAD_KEY, aead_nonce(sess_ctr, CODEC_DIR_TO_FCS), aad, bytes(text))
+        payload = sess_ctr + ct + tag[:AEAD_TAG_LEN]
+    else:
+        payload = xor_crypt(text, salt)
+    body = bytearray([cmd, seq, salt, len(payload)]) + payload
+    body.append(crc8(body))
+    if flags & CODEC_F_COBS:
+        return bytearray(cobs_encode(body) + b"\x00")
+    return bytearray([STX]) + body + bytearray([ETX])
+
+def frame_scan(buf):
+    # STX framing: (start, length) of the first valid frame, or (start, 0) with
+    # everything before start safe to drop
+    if CODEC:
+        start = ctypes.c_uint32(0)
+        total = CODEC.FCS_Codec_Scan(bytes(buf), len(buf), ctypes.byref(start))
+        return start.value, total
+    i = 0
+    while i < len(buf):
+        if buf[i] != STX:
+            i += 1
+            continue
+        if len(buf) - i < 5:
+            break
+        length = buf[i + 4]
+        total = length + FRAME_OVERHEAD
+        if length > PROTO_MAX_PAYLOAD:
+            i += 1
+            continue
+        if len(buf) - i < total:
+            break
+        if buf[i + total - 1] != ETX or crc8(buf[i + 1:i + total - 2]) != buf[i + total - 2]:
+            i += 1
+            continue
+        return i, total
+    return i, 0
+
+def frame_unframe(span):
+    # One COBS span (without the 0x00): checked body [CMD][SEQ][SALT][LEN][PAYLOAD], or None
+    if not span or len(span) >= CODEC_BUF:
+        return None
+    if CODEC:
+        buf = ctypes.create_string_buffer(bytes(span), len(span))
+        n = CODEC.FCS_Codec_Unframe(buf, len(span), CODEC_F_COBS)
+        return bytearray(buf.raw[:n - 1]) if n > 0 else None
+    body = cobs_decode(span)
+    if not body or len(body) < 5 or body[3] > PROTO_MAX_PAYLOAD or body[3] + 5 != len(body):
+        return None
+    if crc8(body[:-1]) != body[-1]:
+        return None
+    return bytearray(body[:-1])
+
+def frame_open(body, flags):
+    # Reply body without CRC: plaintext, or None if it is not authentic
+    if CODEC:
+        buf = ctypes.create_string_buffer(bytes(body), len(body))
+        n = CODEC.FCS_Codec_Open(buf, flags, AEAD_KEY, CODEC_DIR_FROM_FCS)
+        ofs = 4 + CODEC.FCS_Codec_Text_Ofs(flags)
+        return bytearray(buf.raw[ofs:ofs + n]) if n >= 0 else None
+    cmd, seq, salt, payload = body[0], body[1], body[2], bytes(body[4:4 + body[3]])
+    if not flags & CODEC_F_AEAD:
+        return xor_crypt(payload, salt)
+    if salt != AEAD_VERSION or len(payload) < AEAD_OVERHEAD:
+        return None
+    aad = bytes([cmd, seq, salt, len(payload)])
+    pt = aead_open(AEAD_KEY, aead_nonce(payload[:AEAD_HDR], CODEC_DIR_FROM_FCS), aad,
+                   payload[AEAD_HDR:-AEAD_TAG_LEN], payload[-AEAD_TAG_LEN:])
+    return None if pt is None else bytearray(pt)
+
+# Sliding Window: requests in flight at once, keyed by SEQ (echoed in replies)
+WINDOW_FRAMES = 4
+WINDOW_BYTES = 192     # Firmware FCS_FLOW_HIGH_WATER of its 256-byte RX ring: a full window
+                       # never trips flow control, and fits the ring without it
+RTO_MIN_MS = 300       # Serial runs on each RX byte, but may wait out one 100 ms panel push;
+                       # plus the solve, both frames' airtime at 9600 and HC-06 latency
+RTO_POLL_MS = 50
+RESYNC_GAP_MS = 550    # Line silence > firmware PARSER_TIMEOUT_MS resets its parser
+
+# Binary Target Record (little-endian, 12 bytes)
+# zone(u8) band(u8) easting_cm(u32) northing_cm(u32) alt_dm(i16)
+TARGET_RECORD = struct.Struct('<BBIIh')
+
+# Delta Target: [base] + whole-metre dE dN dAlt from a reference position,
+# each zigzag-mapped (0,-1,1,-2 -> 0,1,2,3) and sent as a base-128 varint
+DELTA_BASE_LAST = 0      # Previous target
+DELTA_BASE_BATTERY = 1
+DELTA_BASE_POINT = 2     # + known point id
+KNOWN_POINTS = 8
+TARGET_CMDS = (CMD_TARGET, CMD_TARGET_BIN, CMD_TARGET_BATCH, CMD_TARGET_DELTA)
+
+def zigzag_varint(v):
+    z = 2 * v if v >= 0 else -2 * v - 1
+    out = bytearray()
+    while z >= 0x80:
+        out.append((z & 0x7F) | 0x80)
+        z >>= 7
+    out.append(z)
+    return bytes(out)
+
+# Batch Result (little-endian, 6 bytes)
+# az_dmil(u16) el_dmil(i16) charge(u8) error(u8)
+BATCH_RESULT = struct.Struct('<HhBB')
+BATCH_HDR = 2
+FIRE_ERRORS = {0: "OK", 1: "RANGE", 2: "CHARGE", 3: "CALC"}
+
+# Fire Result (8 bytes): batch result + tof_ds(u16, 0.1 s)
+FIRE_RESULT = struct.Struct('<HhBBH')
+
+# Status Reply (59 bytes): ui_state zone band fire_error rx_overflow(u32)
+#   job_delay_max_us(u16) job_delay_mean_us(u16) job_busy(u16) pool_hwm pool_blocks
+#   aead_max_cyc(u16) aead_over(u16) auth_fail(u16) sleep_pm(u16) wake_dhz(u16)
+#   pass_over(u16) pass_max_us(u32) pass_task(4s) pass_streak reset_wdg
+#   boot_link_ms(u16) boot_done_ms(u16) first_fire_ms(u16) boot_fail
+#   clk_fast_ms(u32) clk_slow_ms(u32) clk_switches(u16) stack_hwm(u16) stack_budget(u16)
+STATUS_REPLY = struct.Struct('<BBBBIHHHBBHHHHHHI4sBBHHHBIIHHH')
+BOOT_DEVICES = ("BMP280", "OLED")  # boot_fail bit order
+# Telemetry fields in mask bit order: (name, struct)
+TELEM_FIELDS = [
+    ("env", struct.Struct('<hHh')),       # air_temp_dc pressure_dhpa prop_temp_dc
+    ("fire", FIRE_RESULT),
+    ("ui", struct.Struct('<BB')),         # ui_state cursor
+    ("loop", struct.Struct('<HH')),       # loop_us loop_max_us
+    ("serial", struct.Struct('<HHH')),    # rx_frames crc_errors rx_overflow
+]
+# Per-command handler cost: cmd(u8) count(u32) min/mean/max cycles(u32)
+CMD_STAT = struct.Struct('<BIIII')
+STATS_F_RESET = 0x01
+# Scheduler task: name(4s) period_ms(u16) runs(u32) overruns skipped mean_us max_us max_late_us (u16)
+TASK_STAT = struct.Struct('<4sHIHHHHH')
+# Cycle probe: name(4s) count(u32) min/mean/max cycles(u32) log2 histogram(16 x u16)
+PROBE_BINS = 16
+PROBE_BIN_SHIFT = 7  # Bin 0 < 2^8 cycles, bin k = [2^(k+7), 2^(k+8)), last bin open
+PROBE_STAT = struct.Struct('<4sIIII%dH' % PROBE_BINS)
+CPU_HZ = 84000000
+CMD_NAMES = {CMD_TARGET: "TARGET_TXT", CMD_TARGET_BIN: "TARGET_BIN", CMD_TARGET_BATCH: "BATCH",
+             CMD_TARGET_DELTA: "TARGET_DELTA", CMD_KNOWN_SET: "KNOWN_SET",
+             CMD_STATUS_REQ: "STATUS", CMD_TELEM_SUB: "TELEM_SUB", CMD_STATS_REQ: "STATS",
+             CMD_TASKS_REQ: "TASKS", CMD_PROBES_REQ: "PROBES", CMD_BAUD_SET: "BAUD_SET"}
+
+TELEM_F_KEY = 0x01
+TELEM_F_STREAM = 0x02
+TELEM_PERIODS = ["OFF", "250", "500", "1000", "2000"]
+
+UI_STATES = {0: "BOOT", 1: "BP_SETTING", 2: "WAITING", 3: "TARGET_LOCK", 4: "FIRE_DATA", 5: "ADJUSTMENT"}
+NAK_REASONS = {1: "CRC", 2: "LEN", 3: "PARSE", 4: "UNKNOWN_CMD", 5: "PARAM", 6: "BUSY", 7: "AUTH"}
 
 class FCS_ClientApp:
     def __init__(self, root):
         self.root = root
         self.root.title("K105A1 B-LINK v1.0")
-        self.root.geometry("600x750")
+        self.root.geometry("600x900")
         # Modern Style Setting
         self.style = ttk.Style()
         self.style.theme_use('clam') # Clean look
         
         self.ser = None
         self.connected = False
-        self.retry_count = 0
         self.max_retries = 2
-        self.last_packet = None # For retry
+        self.seq = 0
+        self.inflight = {}      # seq -> [cmd, packet, sent_at, retries]
+        self.txq = deque()      # (cmd, raw_payload) waiting for window space
+        self.srtt_ms = None
+        self.retransmits = 0
+        self.resync_pending = False  # Timeout seen; resend once the line has been quiet
+        self.quiet_until = 0.0
+        self.rx_buf = bytearray()
+        self.cobs = False         # Framing mode, fixed per connection
+        self.aead = False         # Frame version, fixed per connection
+        self.tx_sess = 0          # AEAD: our nonce prefix and frame counter
+        self.tx_ctr = 0
+        self.rx_sess = None       # AEAD: firmware prefix and newest counter seen
+        self.rx_ctr = 0
+        self.flow = "NONE"        # Flow control, fixed per connection
+        self.rx_esc = False       # XON/XOFF: escape byte seen at the end of the last read
+        self.baud = BAUD_DEFAULT
+        self.baud_pending = None  # Rate awaiting confirmation after BAUD_ACK
+        self.keepalive_id = None
+        self.batch = []         # Pending batch target records
+        self.batch_results = {}
+        self.batch_start = None
+        self.batch_retx = 0
+        self.telem = {}         # Field name -> last decoded tuple
+        self.telem_next = None  # Expected frame count; None = wait for keyframe
+        self.telem_period = 0
+        self.stats_rows = []
+        self.probe_rows = []
+        self.task_rows = []
+        self.last_target = None  # Record the firmware solved last (delta base), None = unknown
+        self.known_points = {}   # id -> record acknowledged by KNOWN_ACK
+        self.kp_pending = {}     # id -> record sent, not yet acknowledged
         
         self.init_ui()
         
@@ -54,6 +431,32 @@ class FCS_ClientApp:
         
         self.btn_conn = ttk.Button(header_frame, text="CONNECT", command=self.toggle_connection)
         self.btn_conn.pack(side=tk.LEFT)
+
+        self.cobs_var = tk.BooleanVar(value=False)
+        ttk.Checkbutton(header_frame, text="COBS", variable=self.cobs_var).pack(side=tk.LEFT, padx=5)
+        self.aead_var = tk.BooleanVar(value=False)
+        ttk.Checkbutton(header_frame, text="AEAD", variable=self.aead_var).pack(side=tk.LEFT, padx=5)
+
+        self.flow_var = tk.StringVar(value=FLOW_MODES[0])
+        ttk.Combobox(header_frame, textvariable=self.flow_var, values=FLOW_MODES,
+                     width=9, state="readonly").pack(side=tk.LEFT)
+
+        self.btn_status = ttk.Button(header_frame, text="STATUS", command=self.request_status)
+        self.btn_status.pack(side=tk.LEFT, padx=10)
+
+        ttk.Button(header_frame, text="STATS", command=self.request_stats).pack(side=tk.LEFT)
+        ttk.Button(header_frame, text="TASKS", command=self.request_tasks).pack(side=tk.LEFT, padx=5)
+        ttk.Button(header_frame, text="PROBES", command=self.request_probes).pack(side=tk.LEFT)
+
+        self.baud_var = tk.StringVar(value=str(BAUD_RATES[1]))
+        ttk.Combobox(header_frame, textvariable=self.baud_var, values=[str(b) for b in BAUD_RATES],
+                     width=7).pack(side=tk.LEFT)
+        ttk.Button(header_frame, text="SET BAUD", command=self.request_baud).pack(side=tk.LEFT, padx=5)
+
+        self.telem_var = tk.StringVar(value=TELEM_PERIODS[3])
+        ttk.Combobox(header_frame, textvariable=self.telem_var, values=TELEM_PERIODS,
+                     width=5).pack(side=tk.LEFT)
+        ttk.Button(header_frame, text="TELEM", command=self.request_telemetry).pack(side=tk.LEFT, padx=5)
         
         self.status_lbl = ttk.Label(header_frame, text="OFFLINE", foreground="red")
         self.status_lbl.pack(side=tk.RIGHT)
@@ -88,12 +491,30 @@ class FCS_ClientApp:
         self.btn_send = ttk.Button(main_frame, text="TRANSMIT FIRE DATA", command=self.prepare_and_send)
         self.btn_send.grid(row=4, column=0, columnspan=2, pady=20, sticky="ew")
 
+        # Batch List (one target per line: "52,S,333712,4132894,100")
+        ttk.Label(main_frame, text="BATCH LIST").grid(row=5, column=0, sticky="nw", pady=5)
+        self.batch_text = tk.Text(main_frame, height=5, width=32, font=("Consolas", 9))
+        self.batch_text.grid(row=5, column=1, sticky="w")
+        self.btn_batch = ttk.Button(main_frame, text="TRANSMIT BATCH", command=self.prepare_and_send_batch)
+        self.btn_batch.grid(row=6, column=0, columnspan=2, pady=10, sticky="ew")
+
+        # Known points: delta targets can then be sent relative to them
+        ttk.Label(main_frame, text="KNOWN POINT").grid(row=7, column=0, sticky="w", pady=5)
+        kp_frame = ttk.Frame(main_frame)
+        kp_frame.grid(row=7, column=1, sticky="w")
+        self.kp_var = tk.StringVar(value="0")
+        ttk.Combobox(kp_frame, textvariable=self.kp_var, values=[str(i) for i in range(KNOWN_POINTS)],
+                     width=3, state="readonly").pack(side=tk.LEFT)
+        ttk.Button(kp_frame, text="STORE TARGET AS KP", command=self.store_known_point).pack(side=tk.LEFT, padx=5)
+
         # [Result] Firing Data Return
         res_frame = ttk.LabelFrame(self.root, text="FIRE MISSION DATA", padding="15")
         res_frame.pack(fill=tk.BOTH, padx=10, pady=5)
         
         self.res_val_lbl = ttk.Label(res_frame, text="WAITING FOR DATA...", font=("Consolas", 14), anchor="center")
         self.res_val_lbl.pack(fill=tk.X, pady=10)
+        self.telem_lbl = ttk.Label(res_frame, text="TELEMETRY OFF", font=("Consolas", 9), anchor="center")
+        self.telem_lbl.pack(fill=tk.X)
 
         # [Logs] Secure Comm Monitor (Collapsible-ish)
         log_frame = ttk.LabelFrame(self.root, text="SECURE COMM LOG (DEBUG)", padding="5")
@@ -116,109 +537,651 @@ class FCS_ClientApp:
         if not self.connected:
             try:
                 port = self.port_var.get()
-                self.ser = serial.Serial(port, 9600, timeout=0.1)
+                self.flow = self.flow_var.get()
+                self.ser = serial.Serial(port, BAUD_DEFAULT, timeout=0.1,
+                                         rtscts=(self.flow == "RTS/CTS"),
+                                         xonxoff=(self.flow == "XON/XOFF"))
+                self.baud = BAUD_DEFAULT
+                self.baud_pending = None
+                self.cobs = self.cobs_var.get()
+                self.aead = self.aead_var.get()
+                self.tx_sess = struct.unpack('<I', os.urandom(4))[0]  # Fresh nonce prefix: counters restart safely
+                self.tx_ctr = 0
+                self.rx_sess = None
+                self.rx_esc = False
+                self.rx_buf = bytearray()
+                self.reset_window()
                 self.connected = True
                 self.btn_conn.config(text="DISCONNECT")
-                self.status_lbl.config(text="ONLINE", foreground="green")
+                self.show_link_status()
                 self.log(f"Connected to {port}")
+                self.root.after(RTO_POLL_MS, self.check_timeouts)
             except Exception as e:
                 messagebox.showerror("Error", str(e))
         else:
             if self.ser:
                 self.ser.close()
             self.connected = False
+            self.reset_window()
             self.btn_conn.config(text="CONNECT")
             self.status_lbl.config(text="OFFLINE", foreground="red")
             self.log("Disconnected")
 
-    def calc_crc8(self, data):
-        crc = 0
-        for byte in data:
-            crc ^= byte
-            for _ in range(8):
-                if crc & 0x80:
-                    crc = (crc << 1) ^ 0x07
-                else:
-                    crc <<= 1
-            crc &= 0xFF
-        return crc
+    def show_link_status(self):
+        self.status_lbl.config(text=f"ONLINE @ {self.baud}", foreground="green")
+
+    def request_baud(self):
+        if not self.connected:
+            messagebox.showwarning("Warning", "Connect to port first!")
+            return
+        rate = int(self.baud_var.get())
+        self.send_secure_packet(CMD_BAUD_SET, struct.pack('<I', rate))
+
+    def switch_baud(self, rate):
+        # Firmware has sent BAUD_ACK and switches after it; follow, then confirm
+        self.ser.baudrate = rate
+        self.baud = rate
+        if rate == BAUD_DEFAULT:
+            self.baud_pending = None
+            self.show_link_status()
+            return
+        self.baud_pending = rate
+        self.status_lbl.config(text=f"CONFIRMING @ {rate}", foreground="orange")
+        self.send_secure_packet(CMD_STATUS_REQ, b"")
+        self.root.after(BAUD_CONFIRM_MS, self.check_baud_confirm)
+
+    def check_baud_confirm(self):
+        if self.baud_pending is None or not self.connected:
+            return
+        # No reply at the new rate: firmware reverts after its probation window
+        self.log(f"Baud {self.baud_pending} not confirmed, back to {BAUD_DEFAULT}", "SYS")
+        self.baud_pending = None
+        self.ser.baudrate = BAUD_DEFAULT
+        self.baud = BAUD_DEFAULT
+        self.show_link_status()
+
+    def baud_keepalive(self):
+        self.keepalive_id = None
+        if not self.connected or self.baud == BAUD_DEFAULT:
+            return
+        self.send_secure_packet(CMD_STATUS_REQ, b"")
+        self.keepalive_id = self.root.after(BAUD_KEEPALIVE_MS, self.baud_keepalive)
 
     def prepare_and_send(self):
         if not self.connected:
             messagebox.showwarning("Warning", "Connect to port first!")
             return
 
-        # 1. Prepare Payload
-        # Format: "52,S,333712,4132894,100"
-        payload_str = f"{self.zone_var.get()},{self.band_var.get()},{self.east_var.get()},{self.north_var.get()},{self.alt_var.get()}"
-        payload_bytes = payload_str.encode('utf-8')
-        
-        self.send_secure_packet(CMD_TARGET, payload_bytes)
-        
-        # Start Timer for Retry? (Simplified: Just log sending)
+        # 1. Prepare Payload (Binary Target Record 0xA2, or a delta 0xA4 when shorter)
+        try:
+            zone = int(self.zone_var.get())
+            band = self.band_var.get().strip().upper()[:1] or "S"
+            payload_bytes = self.encode_target(zone, band, self.east_var.get(),
+                                               self.north_var.get(), self.alt_var.get())
+        except (ValueError, struct.error) as e:
+            messagebox.showerror("Error", f"Invalid target: {e}")
+            return
+        rec = TARGET_RECORD.unpack(payload_bytes)
+        cmd = CMD_TARGET_BIN
+        delta = self.encode_target_delta(rec)
+        if delta is not None and len(delta) < len(payload_bytes):
+            cmd, payload_bytes = CMD_TARGET_DELTA, delta
+
+        # Airtime vs. legacy text frame ("52,S,333712,4132894,100")
+        text_len = len(f"{zone},{band},{self.east_var.get()},{self.north_var.get()},{self.alt_var.get()}")
+        bin_ms = self.frame_airtime_ms(len(payload_bytes))
+        text_ms = self.frame_airtime_ms(text_len)
+        self.log(f"AIRTIME: {bin_ms:.1f} ms {CMD_NAMES[cmd]} {len(payload_bytes)} B "
+                 f"(text {text_ms:.1f} ms, -{text_ms - bin_ms:.1f} ms)", "SYS")
+
+        self.send_secure_packet(cmd, payload_bytes)
+        self.last_target = rec  # Used as a base once this one is answered
         self.res_val_lbl.config(text="TRANSMITTING...", foreground="orange")
 
+    def target_outstanding(self):
+        return (any(e[0] in TARGET_CMDS for e in self.inflight.values()) or
+                any(q[0] in TARGET_CMDS for q in self.txq))
+
+    def encode_target_delta(self, rec):
+        # Shortest [base][dE][dN][dAlt] for this record, or None without a usable base.
+        # The previous target only counts once nothing that could move it is outstanding.
+        bases = [(DELTA_BASE_POINT + i, kp) for i, kp in self.known_points.items()]
+        if self.last_target is not None and not self.target_outstanding():
+            bases.append((DELTA_BASE_LAST, self.last_target))
+        zone, band, e_cm, n_cm, alt_dm = rec
+        best = None
+        for ref, b in bases:
+            de, dn, da = e_cm - b[2], n_cm - b[3], alt_dm - b[4]
+            if b[0] != zone or b[1] != band or de % 100 or dn % 100 or da % 10:
+                continue  # Other grid square, or not a whole-metre offset
+            p = bytes([ref]) + zigzag_varint(de // 100) + zigzag_varint(dn // 100) + zigzag_varint(da // 10)
+            if best is None or len(p) < len(best):
+                best = p
+        return best
+
+    def store_known_point(self):
+        if not self.connected:
+            messagebox.showwarning("Warning", "Connect to port first!")
+            return
+        try:
+            kp = int(self.kp_var.get())
+            rec = self.encode_target(int(self.zone_var.get()), self.band_var.get().strip().upper()[:1] or "S",
+                                     self.east_var.get(), self.north_var.get(), self.alt_var.get())
+        except (ValueError, struct.error) as e:
+            messagebox.showerror("Error", f"Invalid target: {e}")
+            return
+        # Never a base while it is being replaced
+        self.known_points.pop(kp, None)
+        self.kp_pending[kp] = TARGET_RECORD.unpack(rec)
+        self.send_secure_packet(CMD_KNOWN_SET, bytes([kp]) + rec)
+
+    def request_status(self):
+        if not self.connected:
+            messagebox.showwarning("Warning", "Connect to port first!")
+            return
+        self.send_secure_packet(CMD_STATUS_REQ, b"")
+
+    def request_stats(self):
+        if not self.connected:
+            messagebox.showwarning("Warning", "Connect to port first!")
+            return
+        self.stats_rows = []
+        self.send_secure_packet(CMD_STATS_REQ, bytes([0, 0]))
+
+    def handle_stats(self, payload):
+        if len(payload) < 2:
+            return
+        start, total = payload[0], payload[1]
+        rows = [CMD_STAT.unpack_from(payload, off) for off in range(2, len(payload) - CMD_STAT.size + 1, CMD_STAT.size)]
+        if start == 0:
+            self.stats_rows = []
+        self.stats_rows.extend(rows)
+        if start + len(rows) < total and rows:
+            self.send_secure_packet(CMD_STATS_REQ, bytes([start + len(rows), 0]))
+            return
+        # Costliest first
+        self.log(f"{'CMD':<11}{'CALLS':>7}{'MIN us':>9}{'MEAN us':>9}{'MAX us':>9}", "SYS")
+        for cmd, count, lo, mean, hi in sorted(self.stats_rows, key=lambda r: -r[3]):
+            us = lambda c: c * 1e6 / CPU_HZ
+            self.log(f"{CMD_NAMES.get(cmd, hex(cmd)):<11}{count:>7}{us(lo):>9.1f}{us(mean):>9.1f}{us(hi):>9.1f}", "SYS")
+
+    def request_tasks(self):
+        if not self.connected:
+            messagebox.showwarning("Warning", "Connect to port first!")
+            return
+        self.task_rows = []
+        self.send_secure_packet(CMD_TASKS_REQ, bytes([0, 0]))
+
+    def handle_tasks(self, payload):
+        if len(payload) < 2:
+            return
+        start, total = payload[0], payload[1]
+        rows = [TASK_STAT.unpack_from(payload, off) for off in range(2, len(payload) - TASK_STAT.size + 1, TASK_STAT.size)]
+        if start == 0:
+            self.task_rows = []
+        self.task_rows.extend(rows)
+        if start + len(rows) < total and rows:
+            self.send_secure_packet(CMD_TASKS_REQ, bytes([start + len(rows), 0]))
+            return
+        self.log(f"{'TASK':<6}{'PERIOD':>7}{'RUNS':>8}{'OVERRUN':>8}{'SKIP':>6}{'MEAN us':>9}{'MAX us':>8}{'LATE us':>9}", "SYS")
+        for name, period, runs, over, skip, mean, hi, late in self.task_rows:
+            name = name.rstrip(b"\x00").decode(errors='replace')
+            period_txt = f"{period}ms" if period else "event"
+            self.log(f"{name:<6}{period_txt:>7}{runs:>8}{over:>8}{skip:>6}"
+                     f"{mean:>9}{hi:>8}{late:>9}", "SYS")
+
+    def request_probes(self):
+        if not self.connected:
+            messagebox.showwarning("Warning", "Connect to port first!")
+            return
+        self.probe_rows = []
+        self.send_secure_packet(CMD_PROBES_REQ, bytes([0, 0]))
+
+    def handle_probes(self, payload):
+        if len(payload) < 2:
+            return
+        start, total = payload[0], payload[1]
+        rows = [PROBE_STAT.unpack_from(payload, off) for off in range(2, len(payload) - PROBE_STAT.size + 1, PROBE_STAT.size)]
+        if start == 0:
+            self.probe_rows = []
+        self.probe_rows.extend(rows)
+        if start + len(rows) < total and rows:
+            self.send_secure_packet(CMD_PROBES_REQ, bytes([start + len(rows), 0]))
+            return
+        us = lambda c: c * 1e6 / CPU_HZ
+        self.log(f"{'PROBE':<6}{'COUNT':>8}{'MIN us':>10}{'MEAN us':>10}{'MAX us':>10}  "
+                 f"log2 bins from <{us(1 << (PROBE_BIN_SHIFT + 1)):.0f} us", "SYS")
+        for name, count, lo, mean, hi, *hist in self.probe_rows:
+            name = name.rstrip(b"\x00").decode(errors='replace')
+            bins = " ".join(str(h) if h else "." for h in hist)
+            self.log(f"{name:<6}{count:>8}{us(lo):>10.1f}{us(mean):>10.1f}{us(hi):>10.1f}  {bins}", "SYS")
+
+    def request_telemetry(self):
+        if not self.connected:
+            messagebox.showwarning("Warning", "Connect to port first!")
+            return
+        sel = self.telem_var.get()
+        self.telem_period = 0 if sel == "OFF" else int(sel)
+        self.send_secure_packet(CMD_TELEM_SUB, struct.pack('<H', self.telem_period))
+
+    def handle_telemetry(self, payload):
+        if len(payload) < 3:
+            return
+        flags, count, mask = payload[0], payload[1], payload[2]
+        if not flags & TELEM_F_KEY and count != self.telem_next:
+            # Lost a delta: fields are stale until the next keyframe
+            if self.telem_next is not None and self.telem_period:
+                self.log(f"TELEM gap (#{count}, expected #{self.telem_next}), resyncing", "SYS")
+                self.send_secure_packet(CMD_TELEM_SUB, struct.pack('<H', self.telem_period))
+            self.telem_next = None
+            return
+        self.telem_next = (count + 1) & 0xFF
+
+        off = 3
+        for bit, (name, fmt) in enumerate(TELEM_FIELDS):
+            if mask & (1 << bit):
+                if off + fmt.size > len(payload):
+                    return
+                self.telem[name] = fmt.unpack_from(payload, off)
+                off += fmt.size
+        self.show_telemetry()
+
+    def show_telemetry(self):
+        t = self.telem
+        parts = []
+        if "env" in t:
+            temp, pres, prop = t["env"]
+            parts.append(f"T {temp / 10:.1f}C P {pres / 10:.1f} PROP {prop / 10:.1f}C")
+        if "ui" in t:
+            parts.append(UI_STATES.get(t["ui"][0], t["ui"][0]))
+        if "loop" in t:
+            parts.append(f"LOOP {t['loop'][0]}/{t['loop'][1]}us")
+        if "serial" in t:
+            frames, crc, ovf = t["serial"]
+            parts.append(f"RX {frames} CRC {crc} OVF {ovf}")
+        line = " | ".join(parts)
+        if "fire" in t:
+            az, el, chg, err, tof = t["fire"]
+            line += f"\nFIRE AZ:{az / 10:.1f} EL:{el / 10:.1f} CH:{chg} " + \
+                    (f"TOF:{tof / 10:.1f}s" if err == 0 else FIRE_ERRORS.get(err, str(err)))
+        self.telem_lbl.config(text=line)
+
+    def encode_target(self, zone, band, easting, northing, altitude):
+        return TARGET_RECORD.pack(int(zone), ord(band),
+                                  int(round(float(easting) * 100)),
+                                  int(round(float(northing) * 100)),
+                                  int(round(float(altitude) * 10)))
+
+    def prepare_and_send_batch(self):
+        if not self.connected:
+            messagebox.showwarning("Warning", "Connect to port first!")
+            return
+
+        records = []
+        try:
+            for line in self.batch_text.get("1.0", tk.END).splitlines():
+                if not line.strip():
+                    continue
+                z, b, e, n, a = [f.strip() for f in line.split(",")]
+                records.append(self.encode_target(z, b.upper()[:1], e, n, a))
+        except (ValueError, struct.error) as e:
+            messagebox.showerror("Error", f"Invalid batch line: {e}")
+            return
+        if not records:
+            return
+        if len(records) > 255:
+            messagebox.showerror("Error", "Batch list is limited to 255 targets")
+            return
+
+        self.batch = records
+        self.last_target = None  # Firmware keeps the last one of the batch
+        self.batch_results = {}
+        self.batch_start = time.perf_counter()
+        self.batch_retx = self.retransmits
+        self.res_val_lbl.config(text=f"BATCH 0/{len(records)}...", foreground="orange")
+
+        # One frame per batch_chunk() targets, all queued; the window paces them
+        chunk_len = self.batch_chunk()
+        for first in range(0, len(records), chunk_len):
+            chunk = records[first:first + chunk_len]
+            payload = bytes([first, len(chunk)]) + b"".join(chunk)
+            self.send_secure_packet(CMD_TARGET_BATCH, payload)
+
+    def abort_batch(self):
+        self.batch = []
+        self.txq = deque(q for q in self.txq if q[0] != CMD_TARGET_BATCH)
+
+    def handle_batch_result(self, payload):
+        if not self.batch or len(payload) < BATCH_HDR:
+            return
+        first, count = payload[0], payload[1]
+        for i in range(count):
+            off = BATCH_HDR + i * BATCH_RESULT.size
+            self.batch_results[first + i] = BATCH_RESULT.unpack_from(payload, off)
+
+        for idx in range(first, first + count):
+            az, el, chg, err = self.batch_results[idx]
+            if err == 0:
+                self.log(f"#{idx + 1}: AZ:{az / 10:.1f} EL:{el / 10:.1f} CH:{chg}", "RX")
+            else:
+                self.log(f"#{idx + 1}: ERR {FIRE_ERRORS.get(err, err)}", "RX")
+
+        if len(self.batch_results) < len(self.batch):
+            self.res_val_lbl.config(text=f"BATCH {len(self.batch_results)}/{len(self.batch)}...", foreground="orange")
+        else:
+            elapsed = time.perf_counter() - self.batch_start
+            n = len(self.batch)
+            ok = sum(1 for r in self.batch_results.values() if r[3] == 0)
+            self.log(f"BATCH: {n} targets in {elapsed * 1000:.0f} ms ({n / elapsed:.1f} missions/s, "
+                     f"{self.retransmits - self.batch_retx} retransmits)", "SYS")
+            self.update_result(f"BATCH DONE {ok}/{n} OK", ok == n)
+            self.batch = []
+
+    def frame_overhead(self):
+        return FRAME_OVERHEAD + (AEAD_OVERHEAD if self.aead else 0)
+
+    def batch_chunk(self):
+        # Chunk so two batch frames fit the window: one in flight while the other is solved
+        max_payload = PROTO_MAX_PAYLOAD - (AEAD_OVERHEAD if self.aead else 0)
+        return min((max_payload - BATCH_HDR) // TARGET_RECORD.size,
+                   (WINDOW_BYTES // 2 - self.frame_overhead() - BATCH_HDR) // TARGET_RECORD.size)
+
+    def frame_airtime_ms(self, payload_len):
+        # 8N1 -> 10 bits per byte on the wire
+        return (payload_len + self.frame_overhead()) * 10 * 1000.0 / self.baud
+
     def send_secure_packet(self, cmd_id, raw_payload):
-        # 2. Generate Salt
-        salt = random.randint(0, 255)
-        
-        # 3. Encrypt (Rolling XOR)
-        # Key = Master ^ Salt
-        session_key = MASTER_KEY ^ salt
-        encrypted_payload = bytearray()
-        
-        for i, byte in enumerate(raw_payload):
-            enc_byte = byte ^ ((session_key + i) & 0xFF)
-            encrypted_payload.append(enc_byte)
-            
-        # 4. Build Packet
-        # [STX] [CMD] [SALT] [LEN] [PAYLOAD...] [CRC] [ETX]
-        packet = bytearray()
-        packet.append(STX)
-        packet.append(cmd_id)
-        packet.append(salt)
-        length = len(encrypted_payload)
-        packet.append(length)
-        packet.extend(encrypted_payload)
-        
-        # CRC Calc (CMD ~ PAYLOAD)
-        crc_data = bytearray([cmd_id, salt, length])
-        crc_data.extend(encrypted_payload)
-        crc = self.calc_crc8(crc_data)
-        packet.append(crc)
-        
-        packet.append(ETX)
-        
-        # Send
-        self.ser.write(packet)
-        self.log(f"SENT: {packet.hex().upper()}", "TX")
-        self.log(f"RAW: {raw_payload.decode()}", "SYS")
-        
-        # Save for retry (omitted in this basic snippet, but structure ready)
+        # Queue the request; pump() sends it once the window has room
+        self.txq.append((cmd_id, bytes(raw_payload)))
+        self.pump()
+
+    def codec_flags(self):
+        return (CODEC_F_COBS if self.cobs else 0) | (CODEC_F_AEAD if self.aead else 0)
+
+    def open_body(self, body):
+        # Firmware frame body (CRC checked): plaintext, or None if it is not authentic or is replayed
+        if self.aead:
+            if body[2] != AEAD_VERSION or len(body) < 4 + AEAD_OVERHEAD:
+                return None
+            sess, ctr = struct.unpack_from('<II', body, 4)
+            if sess == self.rx_sess and ctr + AEAD_REPLAY_WINDOW <= self.rx_ctr:
+                return None
+        payload = frame_open(body, self.codec_flags())
+        if payload is None or not self.aead:
+            return payload
+        if sess != self.rx_sess:
+            self.rx_sess, self.rx_ctr = sess, ctr  # Firmware rebooted: new prefix
+        else:
+            self.rx_ctr = max(self.rx_ctr, ctr)
+        return payload
+
+    def build_packet(self, cmd_id, seq, raw_payload):
+        # [STX] [CMD] [SEQ] [SALT] [LEN] [PAYLOAD...] [CRC] [ETX], or its COBS form
+        ctr = 0
+        if self.aead:
+            # Frame version 1: SALT is the version byte, every frame takes a new counter
+            ctr, self.tx_ctr = self.tx_ctr, self.tx_ctr + 1
+        return frame_build(cmd_id, seq, random.randint(0, 255), raw_payload, self.codec_flags(), self.tx_sess, ctr)
+
+    def window_bytes(self):
+        return sum(len(entry[1]) for entry in self.inflight.values())
+
+    def pump(self):
+        # Fill the window. BAUD_SET is a barrier: it goes out alone and nothing
+        # follows it until its ACK has moved both ends to the new rate.
+        if time.perf_counter() < self.quiet_until:
+            return
+        while self.connected and self.txq and len(self.inflight) < WINDOW_FRAMES:
+            if any(e[0] == CMD_BAUD_SET for e in self.inflight.values()):
+                break
+            cmd_id, raw_payload = self.txq[0]
+            if cmd_id == CMD_BAUD_SET and self.inflight:
+                break
+            size = len(raw_payload) + self.frame_overhead()
+            if self.inflight and self.window_bytes() + size > WINDOW_BYTES:
+                break
+            self.txq.popleft()
+
+            while self.seq in self.inflight:
+                self.seq = (self.seq + 1) & 0xFF
+            seq = self.seq
+            self.seq = (self.seq + 1) & 0xFF
+
+            packet = self.build_packet(cmd_id, seq, raw_payload)
+            self.ser.write(packet)
+            self.inflight[seq] = [cmd_id, packet, time.perf_counter(), 0]
+            self.log(f"SENT #{seq}: {packet.hex().upper()}", "TX")
+            self.log(f"RAW: {raw_payload.hex().upper()}", "SYS")
+
+    def rto_ms(self):
+        if self.srtt_ms is None:
+            return RTO_MIN_MS * 2
+        return max(RTO_MIN_MS, 2 * self.srtt_ms)
+
+    def retransmit(self, seq, why):
+        # Selective: only the frame that was lost goes out again (same SEQ)
+        entry = self.inflight[seq]
+        if entry[3] >= self.max_retries:
+            del self.inflight[seq]
+            self.log(f"#{seq} 0x{entry[0]:02X} lost after {self.max_retries} retries", "SYS")
+            self.update_result("LINK TIMEOUT", False)
+            if entry[0] in TARGET_CMDS:
+                self.last_target = None  # May or may not have run
+            if entry[0] == CMD_TARGET_BATCH:
+                self.abort_batch()
+            self.pump()
+            return
+        if time.perf_counter() < self.quiet_until:
+            return  # Picked up when the quiet gap ends
+        entry[2] = time.perf_counter()
+        entry[3] += 1
+        self.retransmits += 1
+        self.ser.write(entry[1])
+        self.log(f"RETX #{seq} ({why}, try {entry[3]})", "TX")
+
+    def check_timeouts(self):
+        if not self.connected:
+            return
+        now = time.perf_counter()
+        if now >= self.quiet_until:
+            if self.resync_pending:
+                # Anything still unanswered after the quiet gap went into the desynced parser
+                due = [s for s, e in self.inflight.items() if e[2] < self.quiet_until - RESYNC_GAP_MS / 1000.0]
+                self.resync_pending = False
+                for seq in due:
+                    self.retransmit(seq, "timeout")
+                self.pump()
+            else:
+                rto = self.rto_ms()
+                if self.cobs:
+                    # Every frame ends in 0x00, so the parser is never left mid-frame
+                    for seq in [s for s, e in self.inflight.items() if (now - e[2]) * 1000.0 > rto]:
+                        self.retransmit(seq, "timeout")
+                elif any((now - e[2]) * 1000.0 > rto for e in self.inflight.values()):
+                    # A lost byte leaves the firmware parser mid-frame, eating whatever
+                    # follows. Hold the line quiet until it times out, then resend.
+                    self.resync_pending = True
+                    self.quiet_until = now + RESYNC_GAP_MS / 1000.0
+        self.root.after(RTO_POLL_MS, self.check_timeouts)
+
+    def reset_window(self):
+        self.inflight.clear()
+        self.txq.clear()
+        self.resync_pending = False
+        self.quiet_until = 0.0
+        self.srtt_ms = None
+        self.batch = []
+        self.telem_next = None
+        self.last_target = None
+        self.known_points.clear()
+        self.kp_pending.clear()
+
+    def unescape(self, data):
+        # XON/XOFF were taken out by the driver; undo the firmware's escaping
+        out = bytearray()
+        for b in data:
+            if self.rx_esc:
+                out.append(b ^ 0x20)
+                self.rx_esc = False
+            elif b == FLOW_ESC:
+                self.rx_esc = True
+            else:
+                out.append(b)
+        return out
+
+    def extract_frames(self):
+        if self.cobs:
+            return self.extract_cobs_frames()
+        # Pull complete [STX][CMD][SEQ][SALT][LEN][PAYLOAD][CRC][ETX] frames out of rx_buf.
+        # Bytes outside frames are logged as plain text. A partial frame stays buffered.
+        frames, text = [], bytearray()
+        buf = self.rx_buf
+        while True:
+            start, total = frame_scan(buf)
+            text.extend(b for b in buf[:start] if b != STX)
+            if not total:
+                break
+            body = buf[start + 1:start + total - 2]
+            payload = self.open_body(body)
+            if payload is not None:
+                frames.append((body[0], body[1], payload))
+            buf = buf[start + total:]
+        self.rx_buf = buf
+        return frames, text.decode(errors='ignore')
+
+    def extract_cobs_frames(self):
+        # Each 0x00 ends a frame; a span that fails to decode or check is dropped
+        frames = []
+        *spans, self.rx_buf = self.rx_buf.split(b"\x00")
+        for span in spans:
+            body = frame_unframe(span)
+            if body is None:
+                continue
+            payload = self.open_body(body)
+            if payload is not None:
+                frames.append((body[0], body[1], payload))
+        return frames, ""
+
+    def handle_frame(self, cmd, seq, payload):
+        if cmd == CMD_TELEMETRY and payload and payload[0] & TELEM_F_STREAM:
+            # Unsolicited stream frame: SEQ is its count, not one of our requests
+            self.handle_telemetry(payload)
+            return
+        entry = self.inflight.get(seq)
+        if entry is None:
+            # Late reply to a frame that was already retransmitted and answered
+            self.log(f"DUP #{seq} 0x{cmd:02X} ignored", "RX")
+            return
+        if cmd == CMD_NAK and len(payload) >= 2 and payload[1] == 1:
+            # Request was corrupted on the way in: resend it now
+            self.retransmit(seq, "NAK CRC")
+            return
+        if cmd == CMD_NAK and len(payload) >= 2 and payload[1] == 6:
+            # Job queue full: leave the frame in flight, the RTO resends it
+            entry[2] = time.perf_counter()
+            self.log(f"BUSY #{seq} 0x{entry[0]:02X}: backing off", "SYS")
+            return
+        del self.inflight[seq]
+        self.log(f"FRAME #{seq} 0x{cmd:02X}: {payload.hex().upper()}", "RX")
+        if entry[3] == 0:
+            # Karn: only frames sent once give an unambiguous round trip
+            rtt_ms = (time.perf_counter() - entry[2]) * 1000.0
+            self.srtt_ms = rtt_ms if self.srtt_ms is None else 0.875 * self.srtt_ms + 0.125 * rtt_ms
+            self.log(f"RTT: {rtt_ms:.1f} ms", "SYS")
+
+        self.dispatch_frame(cmd, payload)
+        # After the handler: a BAUD_ACK must switch rates before the next send
+        self.pump()
+
+    def dispatch_frame(self, cmd, payload):
+        if cmd == CMD_FIRE_RESULT and len(payload) >= FIRE_RESULT.size:
+            az, el, chg, err, tof = FIRE_RESULT.unpack_from(payload)
+            if err == 0:
+                self.update_result(f"AZ:{az / 10:.1f} EL:{el / 10:.1f} CH:{chg} TOF:{tof / 10:.1f}s", True)
+            else:
+                self.update_result(f"FIRE ERROR: {FIRE_ERRORS.get(err, err)}", False)
+        elif cmd == CMD_BATCH_RESULT:
+            self.handle_batch_result(payload)
+        elif cmd == CMD_BAUD_ACK and len(payload) >= 4:
+            rate = struct.unpack_from('<I', payload)[0]
+            self.log(f"BAUD ACK: switching to {rate}", "SYS")
+            self.switch_baud(rate)
+        elif cmd == CMD_STATUS_ACK and len(payload) >= STATUS_REPLY.size:
+            if self.baud_pending is not None:
+                self.log(f"Baud {self.baud_pending} confirmed", "SYS")
+                self.baud_pending = None
+                self.show_link_status()
+                if self.keepalive_id is not None:
+                    self.root.after_cancel(self.keepalive_id)
+                self.keepalive_id = self.root.after(BAUD_KEEPALIVE_MS, self.baud_keepalive)
+            (state, zone, band, err, overflow,
+             dly_max, dly_mean, busy, pool_hwm, pool_blocks,
+             aead_cyc, aead_over, auth_fail, sleep_pm, wake_dhz,
+             pass_over, pass_max, pass_task, pass_streak, reset_wdg,
+             boot_link, boot_done, first_fire, boot_fail,
+             clk_fast, clk_slow, clk_switches,
+             stack_hwm, stack_budget) = STATUS_REPLY.unpack_from(payload)
+            self.log(f"STATUS: {UI_STATES.get(state, state)} Z{zone}{chr(band)} "
+                     f"FIRE:{FIRE_ERRORS.get(err, err)} OVF:{overflow} "
+                     f"JOB:{dly_mean}/{dly_max}us BUSY:{busy} POOL:{pool_hwm}/{pool_blocks} "
+                     f"SLEEP:{sleep_pm / 10:.1f}% WAKE:{wake_dhz / 10:.1f}/s", "SYS")
+            pass_task = pass_task.rstrip(b"\x00").decode(errors='replace') or "-"
+            self.log(f"LOOP: {pass_over} passes over 20 ms, worst {pass_max / 1000:.1f} ms ({pass_task}), "
+                     f"{pass_streak} in a row" + (" | LAST RESET: WATCHDOG" if reset_wdg else ""),
+                     "SYS")
+            failed = [d for i, d in enumerate(BOOT_DEVICES) if boot_fail & (1 << i)]
+            self.log(f"BOOT: link {boot_link} ms, devices {boot_done or '-'} ms, "
+                     f"first fire {first_fire or '-'} ms" + (f" | FAILED: {' '.join(failed)}" if failed else ""),
+                     "SYS")
+            clk_total = max(clk_fast + clk_slow, 1)
+            self.log(f"CLOCK: 84 MHz {clk_fast / 1000:.1f} s ({clk_fast * 100 / clk_total:.0f}%), "
+                     f"16 MHz {clk_slow / 1000:.1f} s, {clk_switches} switches", "SYS")
+            if stack_budget:
+                self.log(f"STACK: {stack_hwm}/{stack_budget} B ({stack_hwm * 100 // stack_budget}%)"
+                         + (" | OVER BUDGET" if stack_hwm > stack_budget else ""), "SYS")
+            if self.aead:
+                self.log(f"AEAD: max {aead_cyc} cyc ({aead_cyc * 1e6 / CPU_HZ:.0f} us) "
+                         f"OVER:{aead_over} AUTH FAIL:{auth_fail}", "SYS")
+        elif cmd == CMD_KNOWN_ACK and len(payload) >= 1:
+            kp = payload[0]
+            if kp in self.kp_pending:
+                self.known_points[kp] = self.kp_pending.pop(kp)
+                self.log(f"KNOWN POINT {kp} stored", "SYS")
+        elif cmd == CMD_STATS_ACK:
+            self.handle_stats(payload)
+        elif cmd == CMD_TASKS_ACK:
+            self.handle_tasks(payload)
+        elif cmd == CMD_PROBES_ACK:
+            self.handle_probes(payload)
+        elif cmd == CMD_TELEMETRY:
+            self.handle_telemetry(payload)
+            if self.telem_period == 0:
+                self.telem_lbl.config(text="TELEMETRY OFF")
+        elif cmd == CMD_NAK and len(payload) >= 2:
+            reason = NAK_REASONS.get(payload[1], payload[1])
+            self.update_result(f"REJECTED 0x{payload[0]:02X}: {reason}", False)
+            if payload[0] == CMD_TARGET_BATCH and self.batch:
+                self.abort_batch()
+            if payload[0] in TARGET_CMDS:
+                self.last_target = None
+            if payload[0] == CMD_TARGET_DELTA and payload[1] == 5:
+                # Base not set on the firmware (e.g. after a reset): stop using ours
+                self.known_points.clear()
 
     def serial_listener(self):
-        buffer = b""
         while self.running:
             if self.connected and self.ser and self.ser.in_waiting:
                 try:
                     data = self.ser.read(self.ser.in_waiting)
+                    if self.flow == "XON/XOFF":
+                        data = self.unescape(data)
                     if data:
-                        # Simple Parser for ACK (Assuming Text Response for now as per Roadmap)
-                        # Or mixed. Let's just dump to log and check for ACK keywords
-                        msg = data.decode(errors='ignore')
-                        
-                        # Check for ACK
-                        if "[ACK]" in msg:
-                            # Parse Result "AZ:3200..."
-                            clean_msg = msg.split("[ACK]")[1].strip()
-                            self.root.after(0, lambda m=clean_msg: self.update_result(m, True))
-                            self.root.after(0, lambda m=msg: self.log(m.strip(), "RX"))
-                        elif "[ERR]" in msg:
-                            self.root.after(0, lambda: self.update_result("TRANSMISSION FAILED", False))
+                        self.rx_buf.extend(data)
+                        frames, msg = self.extract_frames()
+                        for cmd, seq, payload in frames:
+                            self.root.after(0, lambda c=cmd, q=seq, p=payload: self.handle_frame(c, q, p))
+                        if msg.strip():
                             self.root.after(0, lambda m=msg: self.log(m.strip(), "RX"))
-                        else:
-                             # Just Log
-                             self.root.after(0, lambda m=msg: self.log(m.strip(), "RX"))
                 except Exception as e:
                     print(e)
             time.sleep(0.05)
@@ -226,7 +1189,47 @@ class FCS_ClientApp:
     def update_result(self, text, success):
         self.res_val_lbl.config(text=text, foreground="blue" if success else "red")
 
+def aead_selftest(path=AEAD_VECTORS):
+    # Checks this codec against the vectors the firmware's host benchmark uses
+    # (Tools/aead_bench.c). frame lines: client frames built by build_packet(),
+    # once per backend (native codec if loaded, then Python).
+    global CODEC
+    hx = lambda x: b"" if x == "-" else bytes.fromhex(x)
+    native = CODEC
+    fails = count = 0
+    app = FCS_ClientApp.__new__(FCS_ClientApp)
+    with open(path) as f:
+        lines = [v for v in (line.split() for line in f) if v and not v[0].startswith("#")]
+    for v in lines:
+        if v[0] == "chacha20":
+            ok = chacha20_xor(hx(v[1]), hx(v[2]), int(v[3]), hx(v[4])) == hx(v[5])
+        elif v[0] == "poly1305":
+            ok = poly1305(hx(v[1]), hx(v[2])) == hx(v[3])
+        elif v[0] == "aead":
+            key, nonce, aad, pt = hx(v[1]), hx(v[2]), hx(v[3]), hx(v[4])
+            ct, tag = aead_seal(key, nonce, aad, pt)
+            ok = (ct == hx(v[5]) and tag == hx(v[6]) and
+                  aead_open(key, nonce, aad, ct, tag[:AEAD_TAG_LEN]) == pt)
+        elif v[0] == "frame":
+            ok = True
+            for CODEC in ([native, None] if native else [None]):
+                app.aead, app.cobs = True, False
+                app.tx_sess, app.tx_ctr = struct.unpack('<I', hx(v[1]))[0], int(v[2])
+                wire = app.build_packet(int(v[3], 16), int(v[4]), hx(v[5]))
+                ok = ok and wire == hx(v[6]) and frame_scan(wire) == (0, len(wire))
+            CODEC = native
+        else:
+            continue
+        count += 1
+        if not ok:
+            fails += 1
+            print(f"FAIL: {v[0]} vector {count}")
+    print(f"AEAD vectors: {count - fails}/{count} passed ({'native codec' if native else 'Python codec only'})")
+    return fails == 0
+
 if __name__ == "__main__":
+    if "--selftest" in sys.argv:
+        sys.exit(0 if aead_selftest() else 1)
     root = tk.Tk()
     app = FCS_ClientApp(root)
     root.mainloop()
@@ -20,6 +20,14 @@
 #define BMP280_REG_ID          0xD0
 #define BMP280_REG_CALIB       0x88
 
+#define BMP280_STATUS_IM_UPDATE 0x01  // NVM data being copied to the image registers
+#define BMP280_STARTUP_MS       10    // Reset -> ready, with margin (datasheet t_startup 2 ms)
+#define BMP280_ADC_RESET        0x80000 // Data registers before the first conversion
+
+/* Sampling: normal mode, osrs_t = osrs_p = x1, filter off */
+#define BMP280_CONFIG_TSB_125MS 0x40  // Standby 125 ms between measurements
+#define BMP280_ODR_MS           132   // t_sb + t_meas (6.4 ms max at x1/x1)
+
 /* Structure to hold sensor data */
 typedef struct {
   float temperature;
@@ -30,7 +38,10 @@ typedef struct {
 } BMP280_Data_t;
 
 /* Functions */
-uint8_t BMP280_Init(void);
+uint8_t BMP280_Init(void);      // Blocking: reset + BMP280_Configure. Returns: 0 ok
+void BMP280_Reset(void);        // Soft reset; the part then copies its NVM
+uint8_t BMP280_Busy(void);      // 1 while it does not answer or is still copying
+uint8_t BMP280_Configure(void); // ID check, calibration, normal mode. Returns: 0 ok
 void BMP280_Read_All(BMP280_Data_t *data);
 void BMP280_SetQNH(float qnh_hpa);
 
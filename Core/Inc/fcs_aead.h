@@ -0,0 +1,30 @@
+#ifndef FCS_AEAD_H
+#define FCS_AEAD_H
+
+#include <stdint.h>
+
+// ChaCha20-Poly1305 (RFC 8439). Plain C with no HAL dependency, so the same
+// file builds into the host benchmark (Tools/aead_bench.c).
+#define FCS_AEAD_KEY_SIZE    32
+#define FCS_AEAD_NONCE_SIZE  12
+#define FCS_AEAD_TAG_SIZE    16
+
+// XOR 'len' bytes in place with the keystream starting at block 'counter'
+void FCS_ChaCha20_Xor(const uint8_t key[FCS_AEAD_KEY_SIZE], const uint8_t nonce[FCS_AEAD_NONCE_SIZE],
+                      uint32_t counter, uint8_t *data, uint32_t len);
+
+// One-shot MAC over 'msg' with a one-time 32-byte key
+void FCS_Poly1305(const uint8_t key[32], const uint8_t *msg, uint32_t len, uint8_t tag[FCS_AEAD_TAG_SIZE]);
+
+// Encrypts 'data' in place and writes the full 16-byte tag
+void FCS_AEAD_Seal(const uint8_t key[FCS_AEAD_KEY_SIZE], const uint8_t nonce[FCS_AEAD_NONCE_SIZE],
+                   const uint8_t *aad, uint32_t aad_len, uint8_t *data, uint32_t len,
+                   uint8_t tag[FCS_AEAD_TAG_SIZE]);
+
+// Checks the first 'tag_len' bytes of the tag (constant time), then decrypts
+// 'data' in place. Returns: 1 if authentic, 0 if not (data left untouched)
+int FCS_AEAD_Open(const uint8_t key[FCS_AEAD_KEY_SIZE], const uint8_t nonce[FCS_AEAD_NONCE_SIZE],
+                  const uint8_t *aad, uint32_t aad_len, uint8_t *data, uint32_t len,
+                  const uint8_t *tag, uint8_t tag_len);
+
+#endif
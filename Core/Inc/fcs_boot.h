@@ -0,0 +1,54 @@
+#ifndef FCS_BOOT_H
+#define FCS_BOOT_H
+
+#include <stdint.h>
+
+// [Boot Sequencer]
+// Peripheral bring-up without blind delays. Each device is a line of steps
+// run in order; a step that finds its device not ready yet says so and is
+// retried on the next poll, so a line waits only as long as the part does
+// (BMP280 NVM copy ~2 ms, not a fixed 100 ms). FCS_Boot_Poll runs one step of
+// every pending line, so the lines on the shared I2C bus interleave and no
+// poll blocks for more than one short transfer: the link is served meanwhile.
+// A line whose step fails, or still waits when its timeout is up, is dropped.
+//
+// Plain C without the HAL, like fcs_sched.c: time comes from the 'now_us'
+// callback (FCS_Power_Now_Us on target, a virtual clock in Tools/boot_sim.c).
+#define FCS_BOOT_POLL_MS     1     // Step rate while a line is pending
+#define FCS_BOOT_MAX_LINES   8     // Lines in FCS_Boot_Failed's mask
+
+// Step results
+#define FCS_STEP_WAIT   0    // Device not ready: retry on the next poll
+#define FCS_STEP_DONE   1    // Go on with the next step
+#define FCS_STEP_FAIL   (-1) // Device missing or wrong: drop the line
+
+typedef int8_t (*FCS_BootStep_t)(void);
+
+typedef enum {
+  FCS_LINE_PENDING,
+  FCS_LINE_UP,
+  FCS_LINE_FAILED
+} FCS_LineState_t;
+
+typedef struct {
+  const char *name;             // Shown in the boot log
+  const FCS_BootStep_t *steps;
+  uint8_t count;
+  uint16_t timeout_ms;          // Whole line, from FCS_Boot_Init
+
+  // State
+  uint8_t at;                   // Next step
+  uint8_t state;                // FCS_LineState_t
+  uint32_t end_us;              // Up or failed, from FCS_Boot_Init
+} FCS_BootLine_t;
+
+#define FCS_BOOT_LINE(n, s, t) \
+  { .name = (n), .steps = (s), .count = (uint8_t)(sizeof(s) / sizeof((s)[0])), .timeout_ms = (t) }
+
+void FCS_Boot_Init(FCS_BootLine_t *lines, uint8_t count, uint32_t (*now_us)(void));
+uint8_t FCS_Boot_Poll(void);          // One step per pending line. Returns: 1 once no line is pending
+uint8_t FCS_Boot_Up(uint8_t idx);     // Line idx has run all its steps
+uint8_t FCS_Boot_Failed(void);        // Bit i: line i failed
+uint32_t FCS_Boot_Done_Us(void);      // FCS_Boot_Init -> last line settled (0 while pending)
+
+#endif
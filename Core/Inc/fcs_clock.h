@@ -0,0 +1,59 @@
+#ifndef FCS_CLOCK_H
+#define FCS_CLOCK_H
+
+#include <stdint.h>
+
+// [Clock Governor] (build option FCS_CLOCK_GOV, default 1; cooperative build)
+// Two operating points:
+//   FAST  84 MHz: PLL from HSI, voltage scale 2, 2 flash wait states (CubeMX)
+//   SLOW  16 MHz: HSI direct, PLL off, voltage scale 3, 0 wait states
+// FCS_Clock_Boost switches to FAST at once, before work that needs the core
+// (a frame to parse, a job to solve). Before it sleeps, the loop calls
+// FCS_Clock_Idle, which drops to SLOW once nothing has boosted for
+// FCS_CLOCK_HOLD_MS and the caller allows it, and goes back to FAST when the
+// caller no longer does (UI_WAITING, key scan idle, link
+// at the default baud: the raised rates need the 84 MHz PCLK2). Panel pushes
+// on the idle screen stay SLOW: they are bound by the 100 kHz I2C bus, not
+// the core.
+//
+// A switch keeps the time bases: the SysTick is rescaled so HAL_GetTick and
+// FCS_Power_Now_Us stay in ms, and both UART BRRs are rewritten in the same
+// IRQ-masked window as the SYSCLK change, so a byte on the wire sees a few
+// cycles of error at most. I2C1 is re-timed from the new PCLK1 afterwards
+// (always idle here: transfers are blocking). DWT cycle counts (probes, job
+// delays) are in the clock that was running.
+//
+// The decisions are plain C. With FCS_CLOCK_HOST a switch is only recorded
+// (Tools/clock_sim.c).
+#ifndef FCS_CLOCK_GOV
+#define FCS_CLOCK_GOV 1
+#endif
+
+#define FCS_CLOCK_HOLD_MS   200         // FAST kept after the last boost (a mission burst)
+#define FCS_CLOCK_FAST_HZ   84000000U
+#define FCS_CLOCK_SLOW_HZ   16000000U   // HSI
+
+typedef enum {
+  FCS_CLK_FAST,
+  FCS_CLK_SLOW,
+  FCS_CLK_COUNT
+} FCS_ClkState_t;
+
+typedef struct {
+  uint32_t ms[FCS_CLK_COUNT];  // Residency since FCS_Clock_Init
+  uint16_t switches;           // Saturating
+} FCS_ClkStats_t;
+
+void FCS_Clock_Init(uint32_t (*now_us)(void));  // At FAST (SystemClock_Config)
+FCS_ClkState_t FCS_Clock_State(void);
+void FCS_Clock_Stats(FCS_ClkStats_t *out);
+
+#if FCS_CLOCK_GOV
+void FCS_Clock_Boost(void);             // Work about to run: FAST now, restarts the hold
+void FCS_Clock_Idle(uint8_t may_slow);  // Before sleeping: SLOW once allowed for the whole hold, else FAST
+#else
+#define FCS_Clock_Boost()    ((void)0)
+#define FCS_Clock_Idle(m)    ((void)(m))
+#endif
+
+#endif
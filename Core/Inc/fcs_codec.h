@@ -0,0 +1,74 @@
+#ifndef FCS_CODEC_H
+#define FCS_CODEC_H
+
+#include <stdint.h>
+
+// [Frame Codec]
+// Wire format shared by the firmware (fcs_core.c) and the client, which loads
+// this file and fcs_aead.c as a host shared library through ctypes:
+//   gcc -O2 -shared -fPIC -ICore/Inc Core/Src/fcs_codec.c Core/Src/fcs_aead.c -o ClientApp/fcs_codec.so
+// Plain C without the HAL; entry points take only pointers and integers.
+//
+// Body: [CMD][SEQ][SALT][LEN][PAYLOAD][CRC] (CRC8 over CMD..PAYLOAD)
+// Framing: [STX][body][ETX], or COBS(body) + 0x00 (FCS_CODEC_F_COBS)
+
+// [Protocol Definitions]
+#define FCS_PROTO_STX  0x02
+#define FCS_PROTO_ETX  0x03
+#define FCS_PROTO_KEY  0xA5
+#define PROTO_MAX_PAYLOAD   120
+#define FCS_PROTO_OVERHEAD  7   // STX + CMD + SEQ + SALT + LEN + CRC + ETX (COBS: code + 5 + 0x00)
+#define FCS_PROTO_BODY_MAX  (4 + PROTO_MAX_PAYLOAD + 1) // CMD SEQ SALT LEN + PAYLOAD + CRC
+
+// Frame version 1 payload: [SESS][CTR][ciphertext][tag] (see fcs_core.h)
+#define FCS_AEAD_VERSION        0x02
+#define FCS_AEAD_HDR_SIZE       8   // SESS + CTR
+#define FCS_AEAD_TAG_LEN        8   // Truncated Poly1305 tag (airtime at 9600 baud)
+#define FCS_AEAD_OVERHEAD       (FCS_AEAD_HDR_SIZE + FCS_AEAD_TAG_LEN)
+
+// Mode flags. Firmware: fixed by FCS_PROTO_COBS/FCS_PROTO_AEAD. Client: per connection.
+#define FCS_CODEC_F_COBS        0x01  // COBS framing, else STX/ETX
+#define FCS_CODEC_F_AEAD        0x02  // ChaCha20-Poly1305, else rolling XOR keyed by SALT
+
+#define FCS_CODEC_DIR_TO_FCS    0     // Nonce direction word
+#define FCS_CODEC_DIR_FROM_FCS  1
+
+#define FCS_CODEC_ERR_FRAME     (-1)  // Malformed (length, delimiter, COBS code)
+#define FCS_CODEC_ERR_CRC       (-2)  // Well formed, CRC mismatch
+
+uint8_t FCS_Codec_Crc8(const uint8_t *data, uint8_t len);
+// Rolling XOR (symmetric: same call encrypts and decrypts)
+void FCS_Codec_Xor(uint8_t *data, uint8_t len, uint8_t salt);
+// dst may be src - 1 (in place). Returns: encoded length
+uint8_t FCS_Codec_Cobs_Encode(const uint8_t *src, uint8_t n, uint8_t *dst);
+// In place. Returns: decoded length, 0 if malformed
+uint8_t FCS_Codec_Cobs_Decode(uint8_t *buf, uint8_t n);
+
+// Offset of the plaintext inside PAYLOAD
+uint8_t FCS_Codec_Text_Ofs(uint8_t flags);
+
+// Protects the PAYLOAD of 'body' in place. On entry LEN is the plaintext
+// length and the plaintext sits at PAYLOAD + FCS_Codec_Text_Ofs(). With AEAD,
+// SALT becomes FCS_AEAD_VERSION, [SESS][CTR] are filled in and the tag is
+// appended; 'key' is the 32-byte key (unused for XOR). Returns: wire LEN
+uint8_t FCS_Codec_Seal(uint8_t *body, uint8_t flags, const uint8_t *key, uint32_t sess, uint32_t ctr, uint8_t dir);
+
+// Reverses FCS_Codec_Seal on a checked body. Returns: plaintext length
+// (plaintext at PAYLOAD + FCS_Codec_Text_Ofs()), or -1 if not authentic
+int FCS_Codec_Open(uint8_t *body, uint8_t flags, const uint8_t *key, uint8_t dir);
+
+// Sealed body at buf[1]: appends the CRC and frames it in place (STX/ETX, or
+// COBS from buf[0] plus the 0x00). Returns: wire length
+uint8_t FCS_Codec_Frame(uint8_t *buf, uint8_t flags);
+
+// One received frame, delimiters included (COBS: the span before 0x00).
+// Leaves the body at buf[0]. Returns: body length, or FCS_CODEC_ERR_*
+// (on ERR_CRC the body is still in place for the NAK)
+int FCS_Codec_Unframe(uint8_t *buf, uint8_t n, uint8_t flags);
+
+// Host stream helper (STX framing): first valid frame in buf[0..n). Returns
+// its wire length with *start at its STX, or 0 with *start at the first byte
+// that may still begin one (everything before it can be dropped).
+uint32_t FCS_Codec_Scan(const uint8_t *buf, uint32_t n, uint32_t *start);
+
+#endif
@@ -2,10 +2,29 @@
 #define __FCS_COMMON_H
 
 #include <stdint.h>
+#include "fcs_log.h"
+
+// [Heap-free Profile] (build option FCS_NO_HEAP_STDIO, default 0)
+// Links without malloc and without newlib's stdio. Text goes through
+// fcs_fmt.h in every build; this profile also drops <stdio.h> here, leaves
+// debug output to the deferred log, and makes sysmem.c turn any _sbrk
+// reference into a link error (the linker script then reserves no heap).
+// Pass -DFCS_NO_HEAP_STDIO=1 to every C file: sysmem.c does not include this.
+#ifndef FCS_NO_HEAP_STDIO
+#define FCS_NO_HEAP_STDIO 0
+#endif
+
+#if !FCS_NO_HEAP_STDIO
 #include <stdio.h>
+#endif
 
 // Debug Print (stripped in Release builds)
-#ifdef DEBUG
+// Deferred: integer args only, see fcs_log.h; decode with Tools/fcs_logdec.py
+#if defined(DEBUG) && FCS_LOG_DEFERRED
+  #define DBG_PRINT(...) FCS_LOG(__VA_ARGS__)
+#elif defined(DEBUG) && FCS_NO_HEAP_STDIO
+  #error "FCS_NO_HEAP_STDIO: debug output needs FCS_LOG_DEFERRED=1 (or a Release build)"
+#elif defined(DEBUG)
   #define DBG_PRINT(...) printf(__VA_ARGS__)
 #else
   #define DBG_PRINT(...) ((void)0)
@@ -78,10 +97,13 @@ typedef struct {
   uint32_t knob_values[3]; // Processed knob values (if needed, or use adc_raw)
 } InputData_t;
 
+#define FCS_KNOWN_POINTS 8
+
 typedef struct {
   // Core Data
   UTM_Coord_t user_pos;
   UTM_Coord_t tgt_pos;
+  UTM_Coord_t known[FCS_KNOWN_POINTS]; // Reference points set over the link (zone 0 = unset)
   
   FireData_t fire;
   EnvData_t env;
@@ -98,6 +120,19 @@ typedef struct {
     int16_t az_mil;   // Azimuth Deviation (+R/-L mil)
   } adj;
   
+  // Loop Timing (busy time of one superloop pass, WFI excluded)
+  struct {
+    uint16_t loop_us;     // Last pass (us)
+    uint16_t loop_max_us; // Worst pass since last telemetry frame (us)
+    uint16_t sleep_pm;    // Time asleep over the last window (0.1 %)
+    uint16_t wake_dhz;    // Wake-ups per second (x10)
+    uint8_t  reset_wdg;   // Last reset came from the deadline watchdog
+    uint8_t  boot_fail;   // Devices that did not come up (bit 0 BMP280, bit 1 OLED)
+    uint16_t boot_link_ms;  // Reset -> link receiving
+    uint16_t boot_done_ms;  // Reset -> every device up or failed (0: pending)
+    uint16_t first_fire_ms; // Reset -> first fire mission answered (0: none yet)
+  } diag;
+  
 } FCS_System_t;
 
 #endif // __FCS_COMMON_H
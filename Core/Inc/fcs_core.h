@@ -2,6 +2,8 @@
 #define __FCS_CORE_H
 
 #include "fcs_common.h"
+#include "fcs_codec.h" // Wire constants, shared with the client
+#include "fcs_probe.h"
 
 #include "main.h" // For Handles
 
@@ -13,29 +15,328 @@ void FCS_Set_Target(FCS_System_t *sys, int zone, char band, double e, double n,
 // [New] Encapsulated Business Logic Tasks
 void FCS_Update_Input(FCS_System_t *sys, ADC_HandleTypeDef *hadc);
 void FCS_Update_Sensors(FCS_System_t *sys);
+void FCS_Update_LoopTime(FCS_System_t *sys, uint32_t busy_us);
+void FCS_Update_Sleep(FCS_System_t *sys, uint16_t sleep_pm, uint16_t wake_dhz);
 void FCS_Task_Serial(FCS_System_t *sys, UART_HandleTypeDef *huart);
 
+// RTOS build (fcs_rtos.h): FCS_Task_Serial split over two tasks. The LINK task
+// parses, queues jobs and does the timed work; MISSION runs one job per call.
+uint32_t FCS_Link_Poll(FCS_System_t *sys, UART_HandleTypeDef *huart); // Returns: ms until the next poll, 0 = on RX only
+void FCS_Link_Job(FCS_System_t *sys, UART_HandleTypeDef *huart, void *job);
+
 // [New] ISR Interface
 void FCS_UART_RxCallback(UART_HandleTypeDef *huart);
 void FCS_Serial_Start(UART_HandleTypeDef *huart);
 uint32_t FCS_Serial_GetOverflowCount(void);
+uint16_t FCS_Serial_GetFrameErrorCount(void); // Malformed or oversized candidates dropped (wraps)
+uint32_t FCS_Serial_GetBaud(void);
+int FCS_Serial_Busy(void); // Frames or jobs left over after FCS_Task_Serial
+int FCS_Serial_Timed(void); // Timeouts, telemetry or flow bytes need periodic runs
 
-// [Buffer Size Constants]
-#define FCS_RESP_BUF_SIZE  64
-#define FCS_TX_BUF_SIZE    128
+// [Framing Mode]
+// 0: [STX][CMD][SEQ][SALT][LEN][PAYLOAD][CRC][ETX] (length-driven)
+// 1: COBS([CMD][SEQ][SALT][LEN][PAYLOAD][CRC]) + 0x00 delimiter. The body never
+//    contains 0x00, so a zero always ends a frame (resync is immediate) and a
+//    frame is decoded in place where it lies in the RX ring.
+#ifndef FCS_PROTO_COBS
+#define FCS_PROTO_COBS      0
+#endif
 
-// [Protocol Definitions]
-#define FCS_PROTO_STX  0x02
-#define FCS_PROTO_ETX  0x03
-#define FCS_PROTO_KEY  0xA5
+// [Frame Version] (payload protection)
+// 0: Rolling XOR keyed by SALT; integrity is the CRC8 only.
+// 1: ChaCha20-Poly1305 (fcs_aead.c). SALT carries FCS_AEAD_VERSION and the
+//    payload is [SESS][CTR][ciphertext][tag]. Nonce = SESS|CTR|DIR (u32 LE each,
+//    DIR 0 = to the FCS, 1 = from it). Each sender picks its own SESS (client:
+//    random per connection, FCS: DWT timing at first use after boot) and counts
+//    CTR up per frame, so a nonce is never reused under the key. The header
+//    [CMD][SEQ][SALT][LEN] is the associated data; the CRC8 stays in front as a
+//    cheap line-noise filter. A request whose CTR is FCS_AEAD_REPLAY_WINDOW or
+//    more behind the newest of its SESS is refused; retransmits of frames still
+//    in the client's window run again (handlers are idempotent).
+#ifndef FCS_PROTO_AEAD
+#define FCS_PROTO_AEAD      0
+#endif
+#define FCS_AEAD_REPLAY_WINDOW  32
+// Crypto budget per frame (seal or open, DWT cycles): BASE + CPB x plaintext byte.
+// A full frame may take 8k cycles (~95 us at 84 MHz), against 1.4 ms of airtime
+// even at 921600 baud. Frames over budget are counted in the status reply.
+#define FCS_AEAD_BUDGET_BASE    3000
+#define FCS_AEAD_BUDGET_CPB     48
+// Development key (RFC 8439 test key). Provision units with -DFCS_AEAD_KEY_BYTES=...
+#ifndef FCS_AEAD_KEY_BYTES
+#define FCS_AEAD_KEY_BYTES \
+  0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f, \
+  0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f
+#endif
+#if FCS_PROTO_AEAD
+#define FCS_APP_MAX_PAYLOAD (PROTO_MAX_PAYLOAD - FCS_AEAD_OVERHEAD) // Plaintext per frame
+#else
+#define FCS_APP_MAX_PAYLOAD PROTO_MAX_PAYLOAD
+#endif
+#define FCS_PROTO_FLAGS ((FCS_PROTO_COBS ? FCS_CODEC_F_COBS : 0) | (FCS_PROTO_AEAD ? FCS_CODEC_F_AEAD : 0))
 
-#define FCS_CMD_TARGET_INPUT 0xA1 // Payload: "52,S,E,N,Alt"
-#define FCS_CMD_FIRE_RESULT  0xB1 // Payload: "AZ..,EL.."
+// [Flow Control] (link UART, receive side)
+// The sender is asked to pause when the RX ring reaches FCS_FLOW_HIGH_WATER
+// bytes and to resume once the serial task has drained it to FCS_FLOW_LOW_WATER.
+// The space above the high mark absorbs bytes already on the way. While the
+// sender is throttled, the parser also leaves frames in the ring when the
+// frame pool is out of RX blocks, instead of rejecting them with FCS_NAK_BUSY.
+// FCS_FLOW_RTSCTS : RTS (PA12, GPIO, active low) follows the ring fill level;
+//                   CTS (PA11) gates our TX in hardware (pulled low if unwired).
+// FCS_FLOW_XONXOFF: XOFF/XON in band for modules without flow pins (HC-06).
+//                   Outgoing bytes 0x11, 0x13 and 0x7D are then sent as
+//                   [0x7D][b ^ 0x20] so a flow byte is never part of a frame.
+#define FCS_FLOW_NONE     0
+#define FCS_FLOW_RTSCTS   1
+#define FCS_FLOW_XONXOFF  2
+#ifndef FCS_FLOW_CTRL
+#define FCS_FLOW_CTRL     FCS_FLOW_NONE
+#endif
+#define FCS_FLOW_HIGH_WATER 192  // Of the 256-byte RX ring
+#define FCS_FLOW_LOW_WATER  64
+#define FCS_FLOW_XON        0x11
+#define FCS_FLOW_XOFF       0x13
+#define FCS_FLOW_ESC        0x7D
+#define FCS_FLOW_RTS_PORT   GPIOA
+#define FCS_FLOW_RTS_PIN    GPIO_PIN_12
+#define FCS_FLOW_CTS_PIN    GPIO_PIN_11  // GPIOA, AF7
+
+#define FCS_CMD_TARGET_INPUT 0xA1 // Payload: "52,S,E,N,Alt" (text, legacy)
+#define FCS_CMD_TARGET_BIN   0xA2 // Payload: FCS_TargetRecord_t (binary)
+#define FCS_CMD_TARGET_BATCH 0xA3 // Payload: [first_idx][count][count x FCS_TargetRecord_t]
+#define FCS_CMD_TARGET_DELTA 0xA4 // Payload: [base][dE][dN][dAlt] (zigzag varints, m)
+#define FCS_CMD_KNOWN_SET    0xA5 // Payload: [id][FCS_TargetRecord_t]
+#define FCS_CMD_FIRE_RESULT  0xB1 // Payload: FCS_FireResult_t
+#define FCS_CMD_BATCH_RESULT 0xB2 // Payload: [first_idx][count][count x FCS_BatchResult_t]
+#define FCS_CMD_KNOWN_ACK    0xB3 // Payload: [id]
 #define FCS_CMD_STATUS_REQ   0xC1 // Payload: None
-#define FCS_CMD_STATUS_ACK   0xC2 // Payload: "READY"
+#define FCS_CMD_STATUS_ACK   0xC2 // Payload: FCS_StatusReply_t
+#define FCS_CMD_TELEM_SUB    0xC3 // Payload: uint16_t period_ms (LE), 0 = stop
+#define FCS_CMD_TELEMETRY    0xC4 // Payload: [flags][count][mask][changed fields...]
+#define FCS_CMD_STATS_REQ    0xC5 // Payload: [start_idx][flags] (both optional)
+#define FCS_CMD_STATS_ACK    0xC6 // Payload: [start_idx][total][n x FCS_CmdStat_t]
+#define FCS_CMD_TASKS_REQ    0xC7 // Payload: [start_idx][flags] (both optional)
+#define FCS_CMD_TASKS_ACK    0xC8 // Payload: [start_idx][total][n x FCS_TaskStat_t]
+#define FCS_CMD_PROBES_REQ   0xC9 // Payload: [start_idx][flags] (both optional)
+#define FCS_CMD_PROBES_ACK   0xCA // Payload: [start_idx][total][n x FCS_ProbeStat_t]
+#define FCS_CMD_BAUD_SET     0xD1 // Payload: uint32_t baud (LE)
+#define FCS_CMD_BAUD_ACK     0xD2 // Payload: uint32_t baud (LE), sent at the old rate
+#define FCS_CMD_NAK          0xE1 // Payload: [req_cmd][FCS_NakCode_t]
+
+// [Baud Negotiation]
+// Link starts at FCS_BAUD_DEFAULT. After BAUD_ACK both ends switch; if no valid
+// frame arrives within the probation window (or the link idles too long at a
+// raised rate) the firmware drops back to FCS_BAUD_DEFAULT on its own.
+#define FCS_BAUD_DEFAULT         9600
+#define FCS_BAUD_PROBATION_MS    3000
+#define FCS_BAUD_IDLE_TIMEOUT_MS 60000
+
+// NAK Reasons
+typedef enum {
+  FCS_NAK_CRC = 1,      // CRC mismatch
+  FCS_NAK_LEN,          // Payload length invalid for command
+  FCS_NAK_PARSE,        // Text payload not parseable
+  FCS_NAK_UNKNOWN_CMD,  // No handler for command ID
+  FCS_NAK_PARAM,        // Parameter out of range (e.g. unsupported baud)
+  FCS_NAK_BUSY,         // Job queue full, retry later
+  FCS_NAK_AUTH          // Wrong frame version, bad tag or replayed counter
+} FCS_NakCode_t;
+
+// [Binary Target Record] (FCS_CMD_TARGET_BIN payload)
+// Packed little-endian, same byte order as Cortex-M4 -> decoded by a plain copy.
+typedef struct __attribute__((packed)) {
+  uint8_t  zone;        // UTM zone (e.g. 52)
+  uint8_t  band;        // UTM latitude band (ASCII, e.g. 'S')
+  uint32_t easting_cm;  // Easting  (cm)
+  uint32_t northing_cm; // Northing (cm)
+  int16_t  alt_dm;      // Altitude (dm), +/-3276.7 m
+} FCS_TargetRecord_t;
+
+#define FCS_TARGET_RECORD_SIZE 12
+_Static_assert(sizeof(FCS_TargetRecord_t) == FCS_TARGET_RECORD_SIZE, "Target record must be 12 bytes");
+
+// [Batch Result] One compact entry per target in FCS_CMD_BATCH_RESULT
+typedef struct __attribute__((packed)) {
+  uint16_t az_dmil;    // Azimuth   (0.1 mil)
+  int16_t  el_dmil;    // Elevation (0.1 mil)
+  uint8_t  charge;     // Charge used (1-7)
+  uint8_t  error;      // FCS_FireError_t
+} FCS_BatchResult_t;
+
+#define FCS_BATCH_RESULT_SIZE 6
+_Static_assert(sizeof(FCS_BatchResult_t) == FCS_BATCH_RESULT_SIZE, "Batch result must be 6 bytes");
+
+// [Fire Result] Reply to a single target (FCS_CMD_FIRE_RESULT)
+typedef struct __attribute__((packed)) {
+  FCS_BatchResult_t sol; // az/el/charge/error
+  uint16_t tof_ds;       // Time of flight (0.1 s)
+} FCS_FireResult_t;
+
+_Static_assert(sizeof(FCS_FireResult_t) == 8, "Fire result must be 8 bytes");
+
+// [Status Reply] (FCS_CMD_STATUS_ACK)
+typedef struct __attribute__((packed)) {
+  uint8_t  ui_state;    // UI_State_t
+  uint8_t  zone;        // Battery UTM zone
+  uint8_t  band;        // Battery UTM band
+  uint8_t  fire_error;  // Last FCS_FireError_t
+  uint32_t rx_overflow; // Ring buffer overflow count
+  uint16_t job_delay_max_us;  // Worst queueing delay (arrival -> handler start)
+  uint16_t job_delay_mean_us; // Mean queueing delay
+  uint16_t job_busy;          // Frames rejected with FCS_NAK_BUSY
+  uint8_t  pool_hwm;          // Most frame pool blocks in use at once
+  uint8_t  pool_blocks;       // FCS_POOL_BLOCKS
+  uint16_t aead_max_cyc;      // Slowest seal/open (DWT cycles), 0 without FCS_PROTO_AEAD
+  uint16_t aead_over;         // Seals/opens over FCS_AEAD_BUDGET_*
+  uint16_t auth_fail;         // Requests refused with FCS_NAK_AUTH
+  uint16_t sleep_pm;          // Time asleep over the last second (0.1 %)
+  uint16_t wake_dhz;          // Wake-ups per second (x10)
+  uint16_t pass_over;         // Scheduler passes over FCS_SCHED_PASS_BUDGET_US
+  uint32_t pass_max_us;       // Longest pass
+  char     pass_task[4];      // Longest-running task of that pass, NUL padded
+  uint8_t  pass_streak;       // Most overrun passes in a row (saturates)
+  uint8_t  reset_wdg;         // 1: last reset by the deadline watchdog (IWDG)
+  uint16_t boot_link_ms;      // Reset -> link receiving
+  uint16_t boot_done_ms;      // Reset -> every device up or failed, 0 while pending
+  uint16_t first_fire_ms;     // Reset -> first fire mission answered, 0 if none yet
+  uint8_t  boot_fail;         // Devices that did not come up (bit 0 BMP280, bit 1 OLED)
+  uint32_t clk_fast_ms;       // Time at 84 MHz since boot (fcs_clock.h)
+  uint32_t clk_slow_ms;       // Time at 16 MHz since boot, 0 without FCS_CLOCK_GOV
+  uint16_t clk_switches;      // Clock switches (saturates)
+  uint16_t stack_hwm;         // Deepest MSP use since reset (bytes, fcs_stack.h)
+  uint16_t stack_budget;      // _Min_Stack_Size (bytes)
+} FCS_StatusReply_t;
+
+_Static_assert(sizeof(FCS_StatusReply_t) == 59, "Status reply must be 59 bytes");
+
+// [Job Queue]
+// The parser only validates frames and queues them with their arrival time;
+// handlers run from the serial task within a cycle budget per pass, with the
+// ring re-polled between jobs so a long solve never stalls reception.
+// At least one job runs per pass. A full queue answers FCS_NAK_BUSY.
+#define FCS_JOB_QUEUE_LEN   4     // Matches the client's request window
+#define FCS_JOB_BUDGET_US   5000  // Per serial task run
+
+// [Frame Pool]
+// Every frame lives in one fixed block from acceptance to transmission:
+// RX copies the checked body out of the ring into a block, the job queue and
+// dispatcher pass it on by pointer, and replies are built and framed in place
+// in a second block that the TX stage frees after sending. One block is
+// reserved for replies, so RX runs dry first (FCS_NAK_BUSY) and a reply or
+// NAK can always be sent.
+#define FCS_POOL_BLOCKS     (FCS_JOB_QUEUE_LEN + 1)  // Queued requests + one reply
+#define FCS_POOL_BLOCK_SIZE 128   // One wire frame in either framing mode
+_Static_assert(FCS_POOL_BLOCK_SIZE >= FCS_PROTO_OVERHEAD + PROTO_MAX_PAYLOAD, "Pool block too small");
+_Static_assert(FCS_POOL_BLOCKS <= 8, "Pool usage is tracked in a uint8_t mask");
+
+// [Telemetry Stream]
+// Reply to FCS_CMD_TELEM_SUB is a keyframe (all fields). While subscribed, each
+// period sends a frame with FCS_TELEM_F_STREAM set carrying only the fields that
+// changed since the previous frame (none changed -> no frame). Every
+// FCS_TELEM_KEY_EVERY periods a keyframe goes out so a receiver that lost a
+// delta catches up. 'count' increments per frame so gaps are visible.
+// Fields follow in mask bit order.
+#define FCS_TELEM_MIN_PERIOD_MS 250  // Keeps a 9600 baud link free for commands
+#define FCS_TELEM_KEY_EVERY     10   // Periods between keyframes
+
+#define FCS_TELEM_F_KEY     0x01  // All fields present
+#define FCS_TELEM_F_STREAM  0x02  // Unsolicited (SEQ is the frame count, not a request)
+
+#define FCS_TELEM_ENV     0x01  // FCS_TelemEnv_t
+#define FCS_TELEM_FIRE    0x02  // FCS_FireResult_t (current fire data)
+#define FCS_TELEM_UI      0x04  // FCS_TelemUi_t
+#define FCS_TELEM_LOOP    0x08  // FCS_TelemLoop_t
+#define FCS_TELEM_SERIAL  0x10  // FCS_TelemSerial_t
+#define FCS_TELEM_ALL     0x1F
+
+#define FCS_TELEM_HDR_SIZE 3
+
+typedef struct __attribute__((packed)) {
+  int16_t  air_temp_dc;   // Air temperature (0.1 C)
+  uint16_t pressure_dhpa; // Air pressure (0.1 hPa)
+  int16_t  prop_temp_dc;  // Propellant temperature (0.1 C)
+} FCS_TelemEnv_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t ui_state;  // UI_State_t
+  uint8_t cursor;    // UI cursor position
+} FCS_TelemUi_t;
+
+typedef struct __attribute__((packed)) {
+  uint16_t loop_us;     // Last superloop pass (us)
+  uint16_t loop_max_us; // Worst pass since previous frame (us)
+} FCS_TelemLoop_t;
+
+typedef struct __attribute__((packed)) {
+  uint16_t rx_frames;   // Valid frames received (wraps)
+  uint16_t crc_errors;  // Frames rejected by CRC (wraps)
+  uint16_t rx_overflow; // Ring buffer overflows (wraps)
+} FCS_TelemSerial_t;
+
+_Static_assert(sizeof(FCS_TelemEnv_t) == 6, "Telemetry env must be 6 bytes");
+_Static_assert(sizeof(FCS_TelemSerial_t) == 6, "Telemetry serial must be 6 bytes");
+
+// [Command Stats] Handler cost per command ID, DWT cycles of the handler only
+// (reply transmission excluded). Paged: request again from start_idx + n.
+typedef struct __attribute__((packed)) {
+  uint8_t  cmd;        // Command ID
+  uint32_t count;      // Calls since boot/reset
+  uint32_t min_cyc;
+  uint32_t mean_cyc;
+  uint32_t max_cyc;
+} FCS_CmdStat_t;
+
+_Static_assert(sizeof(FCS_CmdStat_t) == 17, "Command stat must be 17 bytes");
+#define FCS_STATS_PER_FRAME ((FCS_APP_MAX_PAYLOAD - 2) / sizeof(FCS_CmdStat_t))
+#define FCS_STATS_F_RESET   0x01  // Clear all stats after this reply
+
+// [Task Stats] Scheduler tasks in priority order (fcs_sched.h), times in us
+// (saturated at 0xFFFF). FCS_STATS_F_RESET clears them after the reply.
+// Paged: request again from start_idx + n.
+typedef struct __attribute__((packed)) {
+  char     name[4];     // Task tag, NUL padded
+  uint16_t period_ms;   // 0 = runs only when signalled
+  uint32_t runs;
+  uint16_t overruns;    // Completed past the deadline (wraps)
+  uint16_t skipped;     // Periodic releases dropped (wraps)
+  uint16_t mean_us;
+  uint16_t max_us;
+  uint16_t max_late_us; // Worst release -> start
+} FCS_TaskStat_t;
+
+_Static_assert(sizeof(FCS_TaskStat_t) == 20, "Task stat must be 20 bytes");
+#define FCS_TASKS_PER_FRAME ((FCS_APP_MAX_PAYLOAD - 2) / sizeof(FCS_TaskStat_t))
+
+// [Probe Stats] Named cycle probes (fcs_probe.h), FCS_ProbeStat_t records in
+// PROBE_COUNT order. FCS_STATS_F_RESET clears them after the reply.
+#define FCS_PROBES_PER_FRAME ((FCS_APP_MAX_PAYLOAD - 2) / sizeof(FCS_ProbeStat_t))
+_Static_assert(FCS_PROBES_PER_FRAME >= 1, "A probe record must fit one frame");
+
+// [Delta Target] (FCS_CMD_TARGET_DELTA)
+// Target = base + (dE, dN, dAlt) in whole metres; zone and band come from the
+// base. Each delta is zigzag-mapped (0, -1, 1, -2 -> 0, 1, 2, 3) and sent as a
+// little-endian base-128 varint: |d| < 64 m takes 1 byte, < 8192 m takes 2.
+// A retransmitted frame (same SEQ, SALT and payload) is solved against the
+// base it first used, so a shift from the last target is never applied twice.
+#define FCS_DELTA_BASE_LAST     0  // Previous target
+#define FCS_DELTA_BASE_BATTERY  1
+#define FCS_DELTA_BASE_POINT    2  // + known point ID (FCS_CMD_KNOWN_SET)
+#define FCS_DELTA_MIN_SIZE      4
+#define FCS_DELTA_MAX_SIZE      (1 + 3 * 5)
+
+// Targets per batch frame (longer lists continue in further frames via first_idx)
+#define FCS_BATCH_HDR_SIZE 2
+#define FCS_BATCH_MAX      ((FCS_APP_MAX_PAYLOAD - FCS_BATCH_HDR_SIZE) / FCS_TARGET_RECORD_SIZE)
 
 // Command Parser for Serial/Bluetooth
 // Returns: 1 if handled, 0 if ignored, -1 if parsing error
-int FCS_Process_Command(FCS_System_t *sys, char *cmd_buffer, char *response_buffer);
+int FCS_Process_Command(FCS_System_t *sys, char *cmd_buffer, FCS_FireResult_t *res);
+int FCS_Process_TargetRecord(FCS_System_t *sys, const uint8_t *payload, uint8_t len, FCS_FireResult_t *res);
+// Returns: reply payload length, or -1 if malformed
+int FCS_Process_TargetBatch(FCS_System_t *sys, const uint8_t *payload, uint8_t len, uint8_t *out);
+// 'last' is the base for FCS_DELTA_BASE_LAST. Returns: 1, or -FCS_NakCode_t
+int FCS_Process_TargetDelta(FCS_System_t *sys, const UTM_Coord_t *last, const uint8_t *payload, uint8_t len, FCS_FireResult_t *res);
+// [id][FCS_TargetRecord_t]. Returns: id, or -FCS_NakCode_t
+int FCS_Process_KnownPoint(FCS_System_t *sys, const uint8_t *payload, uint8_t len);
 
 #endif
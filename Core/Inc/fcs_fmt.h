@@ -0,0 +1,29 @@
+#ifndef FCS_FMT_H
+#define FCS_FMT_H
+
+#include <stdint.h>
+
+// [Integer Formatting / Parsing]
+// Stand-ins for the few snprintf/sscanf conversions the firmware uses (%d,
+// %u with a width and '0' or ' ' padding, %c, literal text), without newlib's
+// stdio: no heap, no locale, no varargs. Each call is bounded by the buffer
+// size and 10 digits, so its worst case is fixed. Output is truncated at the
+// buffer end and always NUL terminated, as snprintf.
+// Used in every build; the FCS_NO_HEAP_STDIO profile (fcs_common.h) relies
+// on them being the only formatters.
+typedef struct {
+  char *p;     // Next character
+  char *last;  // Reserved for the NUL
+} FCS_Fmt_t;
+
+void FCS_Fmt_Init(FCS_Fmt_t *f, char *buf, uint16_t size); // size >= 1
+void FCS_Fmt_Str(FCS_Fmt_t *f, const char *s);
+void FCS_Fmt_Char(FCS_Fmt_t *f, char c);
+void FCS_Fmt_Uint(FCS_Fmt_t *f, uint32_t v, uint8_t width, char pad);  // "%u", "%6u", "%06u"
+void FCS_Fmt_Int(FCS_Fmt_t *f, int32_t v, uint8_t width, char pad);    // "%d", "%3d", "%04d"
+
+// "%d"/"%ld" as sscanf: optional blanks and sign, then 1..10 digits.
+// Returns: the first character after the number, NULL if there is none or it overflows
+const char *FCS_Parse_Int(const char *s, int32_t *out);
+
+#endif
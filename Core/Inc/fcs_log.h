@@ -0,0 +1,42 @@
+#ifndef FCS_LOG_H
+#define FCS_LOG_H
+
+#include <stdint.h>
+
+// [Deferred Log]
+// FCS_LOG(fmt, ...) stores a record in a RAM ring and returns; USART2 DMA
+// drains the ring in the background (FCS_Log_Kick from the idle path, then
+// chained from the transfer-complete IRQ). The format string is not sent and
+// not even in flash: it goes to the non-allocated .fcs_logstr section (both
+// linker scripts) and its offset there is the record ID. Tools/fcs_logdec.py
+// reads the section from the ELF and prints the text.
+//
+// Record: [0xA5][id lo][id hi][n][n x u32 LE]. Arguments are integers only
+// (no %s, no %f), at most FCS_LOG_MAX_ARGS, each cast to 32 bits.
+// A full ring drops the record; the next record that fits is preceded by
+// FCS_LOG_ID_DROPPED with the count lost.
+// FCS_LOG_DEFERRED=0 keeps DBG_PRINT on printf (blocking _write in main.c).
+#ifndef FCS_LOG_DEFERRED
+#define FCS_LOG_DEFERRED 1
+#endif
+
+#define FCS_LOG_RING_SIZE   512     // Bytes, power of two
+#define FCS_LOG_MAX_ARGS    6
+#define FCS_LOG_SYNC        0xA5
+#define FCS_LOG_ID_DROPPED  0xFFFF  // One arg: records lost to a full ring
+
+_Static_assert((FCS_LOG_RING_SIZE & (FCS_LOG_RING_SIZE - 1)) == 0, "Log ring must be a power of two");
+
+#define FCS_LOG(fmt, ...) do { \
+    static const char fcs_log_fmt[] __attribute__((section(".fcs_logstr"), used)) = fmt; \
+    const uint32_t fcs_log_args[] = { 0, ##__VA_ARGS__ }; \
+    _Static_assert(sizeof(fcs_log_args) <= (FCS_LOG_MAX_ARGS + 1) * sizeof(uint32_t), "Too many log args"); \
+    FCS_Log_Put((uint16_t)(uintptr_t)fcs_log_fmt, &fcs_log_args[1], \
+                (uint8_t)(sizeof(fcs_log_args) / sizeof(uint32_t) - 1)); \
+  } while (0)
+
+void FCS_Log_Put(uint16_t id, const uint32_t *args, uint8_t n);  // Any context, IRQs masked briefly
+void FCS_Log_Kick(void);       // Start a DMA drain if idle and the ring is not empty
+void FCS_Log_Tx_Done(void);    // USART2 transfer complete (HAL_UART_TxCpltCallback)
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef FCS_POWER_H
+#define FCS_POWER_H
+
+#include "main.h"
+
+// [Tickless Idle]
+// With nothing due, the main loop sleeps in WFI until the next scheduled
+// release instead of waking on every 1 ms SysTick. The SysTick is stopped and
+// reloaded to fire at that release, then HAL's tick is advanced by the
+// time actually slept. Any interrupt ends the sleep early: a UART byte, the
+// key ADC analog watchdog (Input_Wake_Arm) or the timer itself.
+//
+// FCS_TICKLESS=0 keeps the 1 ms tick running during sleep (easier to debug:
+// some probes lose the core while SysTick is suppressed).
+#ifndef FCS_TICKLESS
+#define FCS_TICKLESS 1
+#endif
+
+#define FCS_TICKLESS_MIN_MS   2     // Shorter sleeps (in ticks) keep the tick running
+#define FCS_POWER_WINDOW_MS   1000  // Sleep ratio / wake rate averaging window
+
+// Microseconds since boot from HAL's tick and the SysTick counter. Unlike
+// DWT->CYCCNT it keeps counting while the core sleeps. Wraps after 71 min.
+uint32_t FCS_Power_Now_Us(void);
+
+// Sleeps up to idle_us. Call with IRQs masked: a pending interrupt still
+// ends the WFI, and its handler runs once the caller unmasks.
+void FCS_Power_Sleep(uint32_t idle_us);
+
+// 1 when a window completed since the last call: time asleep (0.1 %) and
+// wake-ups per second (x10) over that window
+int FCS_Power_Window(uint16_t *sleep_pm, uint16_t *wake_dhz);
+
+#endif
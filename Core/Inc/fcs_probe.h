@@ -0,0 +1,65 @@
+#ifndef FCS_PROBE_H
+#define FCS_PROBE_H
+
+#include <stdint.h>
+
+// [Cycle Probes]
+// PROBE_BEGIN(id) ... PROBE_END(id) times a section in core cycles. The start
+// is a local read of the free-running counter (DWT->CYCCNT is never reset;
+// the scheduler and job stats use it too), so probes may nest or overlap.
+// Each probe keeps count, min/mean/max and a log2 histogram; FCS_CMD_PROBES_REQ
+// dumps them. A probe is recorded from one task only (RTOS build), so no locking.
+//
+// Time source: DWT->CYCCNT on target. With FCS_PROBE_HOST, CLOCK_MONOTONIC
+// scaled to FCS_PROBE_HOST_HZ, so host runs fill the same bins and records.
+// FCS_PROBES=0 compiles every probe out.
+#ifndef FCS_PROBES
+#define FCS_PROBES 1
+#endif
+
+typedef enum {
+  PROBE_SOLVE,   // FCS_Calculate_FireData, one target
+  PROBE_PARSE,   // Received bytes -> queued frames (CRC NAKs included)
+  PROBE_UI,      // Render of a changed view into the frame buffer
+  PROBE_LCD,     // SSD1306 push over I2C
+  PROBE_SENSOR,  // BMP280 read
+  PROBE_COUNT
+} FCS_ProbeId_t;
+
+// Histogram: bin 0 < 2^8 cycles (3 us at 84 MHz), bin k = [2^(k+7), 2^(k+8)),
+// the last bin is open (>= 2^22 cycles, 50 ms)
+#define FCS_PROBE_BINS       16
+#define FCS_PROBE_BIN_SHIFT  7
+#define FCS_PROBE_HOST_HZ    84000000U  // Host ticks per second (target core clock)
+
+// Dump record (FCS_CMD_PROBES_ACK)
+typedef struct __attribute__((packed)) {
+  char     name[4];                // Probe tag, NUL padded
+  uint32_t count;
+  uint32_t min_cyc;
+  uint32_t mean_cyc;
+  uint32_t max_cyc;
+  uint16_t hist[FCS_PROBE_BINS];   // Saturating counts
+} FCS_ProbeStat_t;
+
+_Static_assert(sizeof(FCS_ProbeStat_t) == 52, "Probe stat must be 52 bytes");
+
+#if FCS_PROBES
+#ifdef FCS_PROBE_HOST
+uint32_t FCS_Probe_Now(void);
+#else
+#include "main.h"
+#define FCS_Probe_Now()  (DWT->CYCCNT)
+#endif
+#define PROBE_BEGIN(id)  const uint32_t probe_t0_##id = FCS_Probe_Now()
+#define PROBE_END(id)    FCS_Probe_Record((id), FCS_Probe_Now() - probe_t0_##id)
+#else
+#define PROBE_BEGIN(id)  ((void)0)
+#define PROBE_END(id)    ((void)0)
+#endif
+
+void FCS_Probe_Record(FCS_ProbeId_t id, uint32_t cyc);
+void FCS_Probe_Stat(uint8_t idx, FCS_ProbeStat_t *out);  // idx < PROBE_COUNT
+void FCS_Probe_Reset(void);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef FCS_RTOS_H
+#define FCS_RTOS_H
+
+#include <stdint.h>
+
+// [RTOS Build] (FCS_USE_RTOS=1)
+// Preemptive alternative to the cooperative scheduler (fcs_sched.h) on
+// CMSIS-RTOS2: FreeRTOS from CubeMX on target, Tools/rtos_posix on the host.
+// Tasks, highest priority first:
+//   LINK     RX bytes -> frames -> mission queue; BUSY NAKs, timeouts, telemetry
+//   MISSION  one queued request at a time: decrypt, solve, reply
+//   KEYS     key/knob scan (FCS_TASK_KEYS_MS)
+//   SENSOR   boot sequencer (fcs_boot.h), then BMP280 at its output rate
+//            (FCS_TASK_SENSOR_MS) and the heartbeat LED
+//   DISPLAY  redraw on request; the I2C push is preempted by everything above
+// FCS_System_t is shared under the state lock (held only for short reads and
+// writes, never across a solve's reply or a panel push). Pool, TX and the
+// AEAD counter are shared by LINK and MISSION under the link lock; I2C1
+// (BMP280 and SSD1306) by SENSOR and DISPLAY under the bus lock. All are
+// recursive mutexes with priority inheritance. Order: link or bus, then state.
+//
+// Plain C against cmsis_os2.h only; the task bodies are the FCS_App_* hooks.
+#ifndef FCS_USE_RTOS
+#define FCS_USE_RTOS 0
+#endif
+
+#define FCS_RTOS_JOB_DEPTH      4      // Mission queue; >= FCS_JOB_QUEUE_LEN
+
+// Stack sizes (bytes)
+#define FCS_RTOS_STACK_LINK     768
+#define FCS_RTOS_STACK_MISSION  1536   // Solver (double math) + reply build
+#define FCS_RTOS_STACK_KEYS     512
+#define FCS_RTOS_STACK_SENSOR   512
+#define FCS_RTOS_STACK_DISPLAY  1024   // Text formatting into the frame buffer
+
+// Application hooks (main.c on target, the model in Tools/rtos_sim.c)
+uint32_t FCS_App_Link(void);      // Once per wake. Returns: ms until it must run again, 0 = only on RX
+void FCS_App_Mission(void *job);  // One request taken from the queue
+void FCS_App_Keys(void);
+uint8_t FCS_App_Boot(void);       // One boot sequencer poll, sensor task. Returns: 1 once the devices are settled
+void FCS_App_Sensor(void);
+void FCS_App_Display(void);
+
+// Creates the locks, queue and tasks and starts the kernel. Does not return.
+void FCS_Rtos_Start(void);
+
+void FCS_Rtos_Link_Wake(void);     // ISR safe: bytes received
+int FCS_Rtos_Post_Job(void *job);  // LINK -> MISSION. Returns: 0 if the queue is full
+void FCS_Rtos_Redraw(void);        // Display check requested
+
+void FCS_Rtos_State_Lock(void);
+void FCS_Rtos_State_Unlock(void);
+void FCS_Rtos_Link_Lock(void);
+void FCS_Rtos_Link_Unlock(void);
+void FCS_Rtos_Bus_Lock(void);
+void FCS_Rtos_Bus_Unlock(void);
+
+#endif
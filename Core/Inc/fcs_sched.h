@@ -0,0 +1,101 @@
+#ifndef FCS_SCHED_H
+#define FCS_SCHED_H
+
+#include <stdint.h>
+
+// [Cooperative Scheduler]
+// Run-to-completion tasks with their own periods, in priority order (table
+// index 0 first). Each pass runs the highest-priority ready task and rescans,
+// so a task waits for at most one lower-priority task. A task is ready when
+// its period has elapsed or when it was signalled (ISR safe), e.g. serial on
+// a received byte. Releases advance by whole periods, so periodic tasks do
+// not drift; releases that were missed entirely are dropped, not run in a burst.
+// A run that completes later than release + deadline counts as an overrun.
+//
+// Plain C without the HAL. Time comes from the 'now_us' callback given to
+// FCS_Sched_Init (FCS_Power_Now_Us on target, a virtual clock in Tools/sched_sim.c).
+// Times are uint32_t microseconds and may wrap.
+
+// [Task Rates] (shared with the host simulation)
+#define FCS_TASK_KEYS_MS      10    // 100 Hz key/knob scan
+#define FCS_TASK_SENSOR_MS    132   // BMP280 output data rate (BMP280_ODR_MS)
+#define FCS_TASK_DISPLAY_MS   0     // Event-only: keys, sensor and link signal a redraw check
+#define FCS_TASK_SERIAL_MS    50    // Housekeeping (timeouts, telemetry); RX signals it
+#define FCS_TASK_LED_MS       (4 * FCS_TASK_SENSOR_MS)  // Heartbeat; shares every 4th sensor wake
+
+#define FCS_SCHED_MAX_TASKS   8
+
+// [Deadline Monitor]
+// A pass is one FCS_Sched_Run call: every task that was ready on a wake-up.
+// Passes over the budget (the old 50 Hz superloop period) count as overruns,
+// and the longest is kept with the task that ran longest in it. A panel push
+// alone exceeds the budget, so single overruns are expected. A window is
+// missed when overrun passes fill FCS_SCHED_MISS_PM of it; after
+// FCS_SCHED_TRIP_WINDOWS missed windows in a row the monitor trips and stays
+// tripped until reset. A pass that never returns is left to the watchdog
+// itself (fcs_wdg.h).
+#define FCS_SCHED_PASS_BUDGET_US  20000
+#define FCS_SCHED_WINDOW_US       1000000
+#define FCS_SCHED_MISS_PM         800   // Overrun share of a window (0.1 %)
+#define FCS_SCHED_TRIP_WINDOWS    3
+
+typedef struct {
+  // Configuration
+  const char *name;
+  void (*run)(void);
+  uint32_t period_us;     // 0: runs only when signalled
+  uint32_t deadline_us;   // Release -> completion; 0 = period (event-only: unchecked)
+
+  // Schedule state
+  uint32_t next_us;            // Next periodic release
+  volatile uint8_t signalled;  // Set by FCS_Sched_Signal
+
+  // Statistics (FCS_Sched_Reset_Stats)
+  uint32_t runs;
+  uint32_t overruns;     // Completed after release + deadline
+  uint32_t skipped;      // Periodic releases dropped while the task was late
+  uint32_t last_us;      // Run time of the last run
+  uint32_t max_us;
+  uint64_t total_us;
+  uint32_t max_late_us;  // Worst release -> start
+} FCS_Task_t;
+
+typedef struct {
+  uint32_t passes;
+  uint32_t overruns;     // Passes longer than FCS_SCHED_PASS_BUDGET_US
+  uint32_t max_us;       // Longest pass
+  int8_t   max_task;     // Longest-running task of that pass, -1 = none yet
+  uint16_t streak;       // Consecutive overruns, now
+  uint16_t max_streak;
+  uint8_t  missed;       // Consecutive missed windows
+  uint8_t  tripped;      // Latched at FCS_SCHED_TRIP_WINDOWS
+} FCS_SchedPass_t;
+
+#define FCS_TASK(tag, fn, period_ms, deadline_ms) \
+  { .name = (tag), .run = (fn), .period_us = (uint32_t)(period_ms) * 1000U, .deadline_us = (uint32_t)(deadline_ms) * 1000U }
+
+void FCS_Sched_Init(FCS_Task_t *tasks, uint8_t count, uint32_t (*now_us)(void));
+
+// Runs every ready task (highest priority first). Returns: busy time (us)
+uint32_t FCS_Sched_Run(void);
+
+// Marks a task ready. Callable from an ISR.
+void FCS_Sched_Signal(FCS_Task_t *task);
+
+// Time until the next periodic release, 0 if a task is ready now,
+// UINT32_MAX if only a signal can wake a task
+uint32_t FCS_Sched_Idle_Us(void);
+
+// Changes a task's rate at run time (0 = signal only). A new period starts
+// one period from now; the same period keeps the current phase.
+void FCS_Sched_Set_Period(FCS_Task_t *task, uint32_t period_ms);
+
+uint8_t FCS_Sched_Count(void);
+const FCS_Task_t *FCS_Sched_Task(uint8_t idx);
+const FCS_SchedPass_t *FCS_Sched_Pass(void);
+void FCS_Sched_Reset_Stats(void);
+
+// 0 once the monitor has tripped. Gates the watchdog refresh.
+int FCS_Sched_Healthy(void);
+
+#endif
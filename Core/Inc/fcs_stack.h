@@ -0,0 +1,27 @@
+#ifndef FCS_STACK_H
+#define FCS_STACK_H
+
+#include <stdint.h>
+
+// [Stack Watermark]
+// The MSP stack has only the _Min_Stack_Size reserve (1 KB, linker script),
+// which a request handler's buffers and the stdio calls share with every ISR.
+// FCS_Stack_Paint fills the reserve and a guard band below it (the top of
+// the heap area) with a pattern, first thing in main(). FCS_Stack_Hwm scans
+// up from the bottom for the first overwritten word: the deepest the stack
+// has been since. The scan is at most (reserve + guard) / 4 words.
+// A figure over FCS_Stack_Budget() has overflowed into the heap area. A figure
+// equal to the reserve plus FCS_STACK_GUARD has run through the whole guard,
+// so it is a lower bound.
+// In the RTOS build this is the ISR stack (threads have their own).
+//
+// Build-time counterparts: Tools/fcs_memreport.py (stack: -fstack-usage
+// call-graph roll-up, ram: static RAM per module).
+#define FCS_STACK_GUARD  0x400        // Painted below the reserve (bytes)
+#define FCS_STACK_FILL   0xC5C5C5C5U  // Paint pattern
+
+void FCS_Stack_Paint(void);      // Before HAL_Init: main()'s own frame is the only one in use
+uint32_t FCS_Stack_Hwm(void);    // Deepest MSP use since the paint (bytes)
+uint32_t FCS_Stack_Budget(void); // _Min_Stack_Size (bytes)
+
+#endif
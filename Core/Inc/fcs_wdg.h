@@ -0,0 +1,31 @@
+#ifndef FCS_WDG_H
+#define FCS_WDG_H
+
+#include <stdint.h>
+
+// [Deadline Watchdog] (build option FCS_DEADLINE_WDG, default 0)
+// The independent watchdog (IWDG, LSI clock) is refreshed after every
+// scheduler pass while FCS_Sched_Healthy(), so it resets the MCU on a pass
+// that never returns or on a loop saturated for FCS_SCHED_TRIP_WINDOWS
+// seconds, not on single long passes such as a panel push.
+// The timeout covers the longest legitimate stall, a flash sector erase
+// (flash_ops.c refreshes just before it). LSI is 17..47 kHz, so the real
+// timeout is 0.7..1.9 x the nominal. Cooperative build only.
+// FCS_Wdg_Boot reads and clears the reset flags; STATUS reports an IWDG reset.
+#ifndef FCS_DEADLINE_WDG
+#define FCS_DEADLINE_WDG 0
+#endif
+
+#define FCS_WDG_TIMEOUT_MS  4000  // Nominal, at LSI 32 kHz
+
+uint8_t FCS_Wdg_Boot(void);  // 1 if the last reset came from the IWDG
+
+#if FCS_DEADLINE_WDG
+void FCS_Wdg_Start(void);
+void FCS_Wdg_Feed(void);
+#else
+#define FCS_Wdg_Start()  ((void)0)
+#define FCS_Wdg_Feed()   ((void)0)
+#endif
+
+#endif
@@ -4,8 +4,17 @@
 #include "main.h"
 #include "fcs_common.h"
 
+#define INPUT_KEY_IDLE_MIN  3800           // Button ladder reads above this with no key
+#define INPUT_KEY_CHANNEL   ADC_CHANNEL_8    // ADC_BUTTON (PB0), rank 4
+
 // 입력 처리 함수
 KeyState Input_Scan(uint32_t adc_value);
 void Input_Read_All(ADC_HandleTypeDef *hadc, uint32_t *dest);
 
+// [Key Wake] The ADC converts continuously while the analog watchdog watches
+// the button channel; a press leaves the idle window and raises the ADC IRQ
+// (HAL_ADC_LevelOutOfWindowCallback). Disarm before the next Input_Read_All.
+void Input_Wake_Arm(ADC_HandleTypeDef *hadc);
+void Input_Wake_Disarm(ADC_HandleTypeDef *hadc);
+
 #endif /* INC_INPUT_H_ */
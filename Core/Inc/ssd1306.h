@@ -158,6 +158,7 @@ typedef struct {
 
 // Procedure definitions
 void ssd1306_Init(void);
+void ssd1306_Configure(void);
 void ssd1306_Fill(SSD1306_COLOR color);
 void ssd1306_UpdateScreen(void);
 void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color);
@@ -209,6 +210,7 @@ uint8_t ssd1306_GetDisplayOn();
 
 // Low-level procedures
 void ssd1306_Reset(void);
+uint8_t ssd1306_Ready(void);
 void ssd1306_WriteCommand(uint8_t byte);
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size);
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len);
@@ -12,6 +12,8 @@
 void UI_Init(FCS_System_t *sys);
 // knobs array size explicit or pointer
 void UI_Update(FCS_System_t *sys); 
-void UI_Draw(FCS_System_t *sys);
+void UI_Draw(FCS_System_t *sys);     // Renders only if the shown data changed
+int UI_Render(FCS_System_t *sys);    // UI_Draw without the panel push. Returns: 1 if redrawn
+void UI_Push(void);                  // Frame buffer -> panel
 
 #endif /* INC_UI_H_ */
@@ -10,20 +10,37 @@ static int16_t  dig_P2, dig_P3, dig_P4, dig_P5, dig_P6, dig_P7, dig_P8, dig_P9;
 static float    BMP280_Ref_Pressure = 1013.25f; // Standard Atmosphere Default
 
 // Internal helper functions
-static void BMP280_ReadShim(uint8_t reg, uint8_t *data, uint8_t len) {
-  HAL_I2C_Mem_Read(&hi2c1, BMP280_I2C_ADDR, reg, I2C_MEMADD_SIZE_8BIT, data, len, 100);
+static HAL_StatusTypeDef BMP280_ReadShim(uint8_t reg, uint8_t *data, uint8_t len) {
+  return HAL_I2C_Mem_Read(&hi2c1, BMP280_I2C_ADDR, reg, I2C_MEMADD_SIZE_8BIT, data, len, 100);
 }
 
 static void BMP280_WriteShim(uint8_t reg, uint8_t value) {
   HAL_I2C_Mem_Write(&hi2c1, BMP280_I2C_ADDR, reg, I2C_MEMADD_SIZE_8BIT, &value, 1, 100);
 }
 
+void BMP280_Reset(void) {
+  BMP280_WriteShim(BMP280_REG_RESET, 0xB6);
+}
+
+uint8_t BMP280_Busy(void) {
+  // No ACK right after the reset, then im_update while the NVM is copied
+  uint8_t status;
+  if (BMP280_ReadShim(BMP280_REG_STATUS, &status, 1) != HAL_OK) return 1;
+  return (status & BMP280_STATUS_IM_UPDATE) != 0;
+}
+
 uint8_t BMP280_Init(void) {
-  uint8_t chipID;
+  // 1. Soft Reset, then wait for the NVM copy (t_startup 2 ms)
+  BMP280_Reset();
+  uint32_t t0 = HAL_GetTick();
+  while (BMP280_Busy()) {
+    if (HAL_GetTick() - t0 > BMP280_STARTUP_MS) return 1; // Device not found
+  }
+  return BMP280_Configure();
+}
 
-  // 1. Soft Reset
-  BMP280_WriteShim(BMP280_REG_RESET, 0xB6);
-  HAL_Delay(100);
+uint8_t BMP280_Configure(void) {
+  uint8_t chipID = 0;
 
   // 2. Check Chip ID (Expected: 0x58)
   BMP280_ReadShim(BMP280_REG_ID, &chipID, 1);
@@ -49,8 +66,8 @@ uint8_t BMP280_Init(void) {
   dig_P9 = (int16_t)((calib[23] << 8) | calib[22]);
 
   // 4. Configure Sensor
-  // Config: Filter=Off, Standby=0.5ms
-  BMP280_WriteShim(BMP280_REG_CONFIG, 0x00); 
+  // Config: Filter=Off, Standby=125ms (~7.6 Hz; the sensor task reads at this rate)
+  BMP280_WriteShim(BMP280_REG_CONFIG, BMP280_CONFIG_TSB_125MS);
     
   // Ctrl_Meas: Osrs_T=x1, Osrs_P=x1, Mode=Normal (0x27)
   BMP280_WriteShim(BMP280_REG_CTRL_MEAS, 0x27); 
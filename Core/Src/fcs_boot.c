@@ -0,0 +1,70 @@
+#include "fcs_boot.h"
+#include <stddef.h>
+
+static FCS_BootLine_t *b_lines = NULL;
+static uint8_t b_count = 0;
+static uint32_t (*b_now)(void) = NULL;
+static uint32_t b_start = 0;
+static uint32_t b_done_us = 0;
+
+void FCS_Boot_Init(FCS_BootLine_t *lines, uint8_t count, uint32_t (*now_us)(void)) {
+  if (count > FCS_BOOT_MAX_LINES) count = FCS_BOOT_MAX_LINES;
+  b_lines = lines;
+  b_count = count;
+  b_now = now_us;
+  b_start = b_now();
+  b_done_us = 0;
+  for (uint8_t i = 0; i < b_count; i++) {
+    b_lines[i].at = 0;
+    b_lines[i].state = (b_lines[i].count > 0) ? FCS_LINE_PENDING : FCS_LINE_UP;
+    b_lines[i].end_us = 0;
+  }
+}
+
+static void Boot_Settle(FCS_BootLine_t *l, uint8_t state, uint32_t now) {
+  l->state = state;
+  l->end_us = now - b_start;
+}
+
+uint8_t FCS_Boot_Poll(void) {
+  uint8_t pending = 0;
+  for (uint8_t i = 0; i < b_count; i++) {
+    FCS_BootLine_t *l = &b_lines[i];
+    if (l->state != FCS_LINE_PENDING) continue;
+
+    int8_t r = l->steps[l->at]();
+    uint32_t now = b_now();
+    if (r == FCS_STEP_FAIL) {
+      Boot_Settle(l, FCS_LINE_FAILED, now);
+    } else if (r == FCS_STEP_DONE) {
+      if (++l->at >= l->count) Boot_Settle(l, FCS_LINE_UP, now);
+      else pending++;
+    } else if (now - b_start >= (uint32_t)l->timeout_ms * 1000U) {
+      Boot_Settle(l, FCS_LINE_FAILED, now); // Still not ready: missing or stuck
+    } else {
+      pending++;
+    }
+  }
+  if (pending > 0) return 0;
+  if (b_done_us == 0) {
+    b_done_us = b_now() - b_start;
+    if (b_done_us == 0) b_done_us = 1; // 0 reads as pending
+  }
+  return 1;
+}
+
+uint8_t FCS_Boot_Up(uint8_t idx) {
+  return idx < b_count && b_lines[idx].state == FCS_LINE_UP;
+}
+
+uint8_t FCS_Boot_Failed(void) {
+  uint8_t mask = 0;
+  for (uint8_t i = 0; i < b_count; i++) {
+    if (b_lines[i].state == FCS_LINE_FAILED) mask |= (uint8_t)(1U << i);
+  }
+  return mask;
+}
+
+uint32_t FCS_Boot_Done_Us(void) {
+  return b_done_us;
+}
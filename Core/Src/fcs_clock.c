@@ -0,0 +1,129 @@
+#include "fcs_clock.h"
+#include <stddef.h>
+#ifndef FCS_CLOCK_HOST
+#include "main.h"
+#include "i2c.h"
+#include "usart.h"
+#endif
+
+static uint32_t (*c_now)(void) = NULL;
+static FCS_ClkState_t c_state = FCS_CLK_FAST;
+static uint32_t c_since = 0;        // Residency accounted up to here
+static uint32_t c_rem_us[FCS_CLK_COUNT];
+static FCS_ClkStats_t c_stats;
+#if FCS_CLOCK_GOV
+static uint32_t c_demand = 0;       // Last boost, or last idle call that did not allow SLOW
+#endif
+
+void FCS_Clock_Init(uint32_t (*now_us)(void)) {
+  c_now = now_us;
+  c_state = FCS_CLK_FAST;
+  c_since = c_now();
+#if FCS_CLOCK_GOV
+  c_demand = c_since;
+#endif
+}
+
+FCS_ClkState_t FCS_Clock_State(void) {
+  return c_state;
+}
+
+static void Clock_Account(void) {
+  uint32_t now = c_now();
+  uint32_t us = c_rem_us[c_state] + (now - c_since);
+  c_stats.ms[c_state] += us / 1000U;
+  c_rem_us[c_state] = us % 1000U;
+  c_since = now;
+}
+
+void FCS_Clock_Stats(FCS_ClkStats_t *out) {
+  if (c_now) Clock_Account();
+  *out = c_stats;
+}
+
+#if FCS_CLOCK_GOV
+// [Switching]
+#ifndef FCS_CLOCK_HOST
+static void Clock_Retime_Uart(UART_HandleTypeDef *huart, uint32_t pclk) {
+  huart->Instance->BRR = (huart->Init.OverSampling == UART_OVERSAMPLING_8)
+                             ? UART_BRR_SAMPLING8(pclk, huart->Init.BaudRate)
+                             : UART_BRR_SAMPLING16(pclk, huart->Init.BaudRate);
+}
+
+// Finish the current tick in the new clock's cycles, then 1 ms ticks (as
+// fcs_power.c after a sleep: LOAD takes effect at the next reload)
+static void Clock_Retime_Tick(uint32_t old_hz) {
+  uint32_t per_tick = SystemCoreClock / 1000U;
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  uint32_t left = (uint32_t)((uint64_t)SysTick->VAL * per_tick / (old_hz / 1000U));
+  if (left < 2) left = 2; // A one-cycle reload would stop the counter
+  SysTick->LOAD = left - 1;
+  SysTick->VAL = 0;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+  SysTick->LOAD = per_tick - 1;
+}
+
+// SYSCLK and APB1 change together; everything clocked from them is fixed up
+// before an interrupt can see the old settings
+static void Clock_Select(uint32_t sw, uint32_t sws, uint32_t ppre1, uint32_t hz) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t old_hz = SystemCoreClock;
+  MODIFY_REG(RCC->CFGR, RCC_CFGR_SW | RCC_CFGR_PPRE1, sw | ppre1);
+  while ((RCC->CFGR & RCC_CFGR_SWS) != sws) {}
+  SystemCoreClock = hz;
+  Clock_Retime_Uart(&huart1, HAL_RCC_GetPCLK2Freq());
+  Clock_Retime_Uart(&huart2, HAL_RCC_GetPCLK1Freq());
+  Clock_Retime_Tick(old_hz);
+  __set_PRIMASK(primask);
+}
+
+static void Clock_Switch(FCS_ClkState_t to) {
+  if (to == FCS_CLK_FAST) {
+    __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE2); // Writable while the PLL is off
+    RCC->CR |= RCC_CR_PLLON; // PLLCFGR kept from SystemClock_Config
+    while (!(RCC->CR & RCC_CR_PLLRDY)) {}
+    while (!(PWR->CSR & PWR_CSR_VOSRDY)) {}
+    __HAL_FLASH_SET_LATENCY(FLASH_LATENCY_2);
+    while (__HAL_FLASH_GET_LATENCY() != FLASH_LATENCY_2) {}
+    Clock_Select(RCC_CFGR_SW_PLL, RCC_CFGR_SWS_PLL, RCC_CFGR_PPRE1_DIV2, FCS_CLOCK_FAST_HZ);
+  } else {
+    Clock_Select(RCC_CFGR_SW_HSI, RCC_CFGR_SWS_HSI, RCC_CFGR_PPRE1_DIV1, FCS_CLOCK_SLOW_HZ);
+    __HAL_FLASH_SET_LATENCY(FLASH_LATENCY_0);
+    RCC->CR &= ~RCC_CR_PLLON;
+    while (RCC->CR & RCC_CR_PLLRDY) {}
+    __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE3);
+  }
+  if (HAL_I2C_Init(&hi2c1) != HAL_OK) { // CCR/TRISE from the new PCLK1
+    Error_Handler();
+  }
+}
+#else
+#define Clock_Switch(to)  ((void)(to))
+#endif
+
+static void Clock_Set(FCS_ClkState_t to) {
+  Clock_Account();
+  Clock_Switch(to);
+  c_state = to;
+  if (c_stats.switches != UINT16_MAX) c_stats.switches++;
+}
+
+// [Governor]
+void FCS_Clock_Boost(void) {
+  if (!c_now) return;
+  c_demand = c_now();
+  if (c_state != FCS_CLK_FAST) Clock_Set(FCS_CLK_FAST);
+}
+
+void FCS_Clock_Idle(uint8_t may_slow) {
+  if (!c_now) return;
+  if (!may_slow) {
+    FCS_Clock_Boost(); // The hold counts from when SLOW became allowed
+    return;
+  }
+  if (c_state == FCS_CLK_FAST && c_now() - c_demand >= FCS_CLOCK_HOLD_MS * 1000U) {
+    Clock_Set(FCS_CLK_SLOW);
+  }
+}
+#endif
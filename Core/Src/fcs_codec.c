@@ -0,0 +1,169 @@
+#include "fcs_codec.h"
+#include "fcs_aead.h"
+#include <string.h>
+
+#define BODY_PAYLOAD_OFS 4  // [CMD][SEQ][SALT][LEN]
+
+// [1] CRC8 (Polynomial 0x07)
+uint8_t FCS_Codec_Crc8(const uint8_t *data, uint8_t len) {
+  uint8_t crc = 0;
+  for (int i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int j = 0; j < 8; j++) {
+      if (crc & 0x80) crc = (crc << 1) ^ 0x07;
+      else crc <<= 1;
+    }
+  }
+  return crc;
+}
+
+// [2] Rolling XOR cipher: Key = FCS_PROTO_KEY ^ salt, byte i ^= Key + i
+void FCS_Codec_Xor(uint8_t *data, uint8_t len, uint8_t salt) {
+  uint8_t session_key = FCS_PROTO_KEY ^ salt;
+  for (int i = 0; i < len; i++) {
+    data[i] ^= (uint8_t)(session_key + i);
+  }
+}
+
+// [3] COBS: every 0x00 is replaced by the distance to the next one.
+// Below 254 bytes writes never pass the read, so dst may be src - 1.
+uint8_t FCS_Codec_Cobs_Encode(const uint8_t *src, uint8_t n, uint8_t *dst) {
+  uint8_t code_idx = 0;
+  uint8_t code = 1;
+  uint8_t w = 1;
+  for (uint8_t i = 0; i < n; i++) {
+    if (src[i] == 0) {
+      dst[code_idx] = code;
+      code_idx = w++;
+      code = 1;
+    } else {
+      dst[w++] = src[i];
+      if (++code == 0xFF) {
+        dst[code_idx] = code;
+        code_idx = w++;
+        code = 1;
+      }
+    }
+  }
+  dst[code_idx] = code;
+  return w;
+}
+
+// Output never overtakes input
+uint8_t FCS_Codec_Cobs_Decode(uint8_t *buf, uint8_t n) {
+  uint8_t r = 0;
+  uint8_t w = 0;
+  while (r < n) {
+    uint8_t code = buf[r++];
+    if (code == 0 || (uint16_t)r + code - 1 > n) return 0;
+    for (uint8_t k = 1; k < code; k++) buf[w++] = buf[r++];
+    if (code < 0xFF && r < n) buf[w++] = 0;
+  }
+  return w;
+}
+
+// [4] Payload protection
+uint8_t FCS_Codec_Text_Ofs(uint8_t flags) {
+  return (flags & FCS_CODEC_F_AEAD) ? FCS_AEAD_HDR_SIZE : 0;
+}
+
+// Nonce = SESS|CTR|DIR, u32 LE each; [SESS][CTR] are already in that order
+static void Codec_Nonce(uint8_t nonce[FCS_AEAD_NONCE_SIZE], const uint8_t *sess_ctr, uint8_t dir) {
+  memcpy(nonce, sess_ctr, FCS_AEAD_HDR_SIZE);
+  nonce[8] = dir;
+  nonce[9] = nonce[10] = nonce[11] = 0;
+}
+
+uint8_t FCS_Codec_Seal(uint8_t *body, uint8_t flags, const uint8_t *key, uint32_t sess, uint32_t ctr, uint8_t dir) {
+  uint8_t *payload = &body[BODY_PAYLOAD_OFS];
+  uint8_t len = body[3];
+  if (!(flags & FCS_CODEC_F_AEAD)) {
+    FCS_Codec_Xor(payload, len, body[2]);
+    return len;
+  }
+
+  uint8_t *text = &payload[FCS_AEAD_HDR_SIZE];
+  body[2] = FCS_AEAD_VERSION;
+  body[3] = (uint8_t)(len + FCS_AEAD_OVERHEAD);
+  memcpy(payload, &sess, 4);
+  memcpy(&payload[4], &ctr, 4);
+
+  uint8_t nonce[FCS_AEAD_NONCE_SIZE];
+  uint8_t tag[FCS_AEAD_TAG_SIZE];
+  Codec_Nonce(nonce, payload, dir);
+  FCS_AEAD_Seal(key, nonce, body, BODY_PAYLOAD_OFS, text, len, tag);
+  memcpy(&text[len], tag, FCS_AEAD_TAG_LEN);
+  return body[3];
+}
+
+int FCS_Codec_Open(uint8_t *body, uint8_t flags, const uint8_t *key, uint8_t dir) {
+  uint8_t *payload = &body[BODY_PAYLOAD_OFS];
+  uint8_t len = body[3];
+  if (!(flags & FCS_CODEC_F_AEAD)) {
+    FCS_Codec_Xor(payload, len, body[2]);
+    return len;
+  }
+
+  if (body[2] != FCS_AEAD_VERSION || len < FCS_AEAD_OVERHEAD) return -1;
+  len -= FCS_AEAD_OVERHEAD;
+  uint8_t *text = &payload[FCS_AEAD_HDR_SIZE];
+  uint8_t nonce[FCS_AEAD_NONCE_SIZE];
+  Codec_Nonce(nonce, payload, dir);
+  if (!FCS_AEAD_Open(key, nonce, body, BODY_PAYLOAD_OFS, text, len, &text[len], FCS_AEAD_TAG_LEN)) return -1;
+  return len;
+}
+
+// [5] Framing
+uint8_t FCS_Codec_Frame(uint8_t *buf, uint8_t flags) {
+  uint8_t len = buf[4];
+  buf[5 + len] = FCS_Codec_Crc8(&buf[1], 4 + len);
+  if (flags & FCS_CODEC_F_COBS) {
+    uint8_t n = FCS_Codec_Cobs_Encode(&buf[1], 5 + len, buf); // In place, one byte behind
+    buf[n++] = 0x00;
+    return n;
+  }
+  buf[0] = FCS_PROTO_STX;
+  buf[6 + len] = FCS_PROTO_ETX;
+  return FCS_PROTO_OVERHEAD + len;
+}
+
+int FCS_Codec_Unframe(uint8_t *buf, uint8_t n, uint8_t flags) {
+  uint8_t len;
+  if (flags & FCS_CODEC_F_COBS) {
+    len = FCS_Codec_Cobs_Decode(buf, n);
+    if (len < 5 || buf[3] > PROTO_MAX_PAYLOAD || buf[3] + 5 != len) return FCS_CODEC_ERR_FRAME;
+  } else {
+    if (n < FCS_PROTO_OVERHEAD || buf[0] != FCS_PROTO_STX || buf[n - 1] != FCS_PROTO_ETX ||
+        buf[4] > PROTO_MAX_PAYLOAD || buf[4] + FCS_PROTO_OVERHEAD != n) return FCS_CODEC_ERR_FRAME;
+    len = n - 2;
+    memmove(buf, &buf[1], len);
+  }
+  if (FCS_Codec_Crc8(buf, len - 1) != buf[len - 1]) return FCS_CODEC_ERR_CRC;
+  return len;
+}
+
+uint32_t FCS_Codec_Scan(const uint8_t *buf, uint32_t n, uint32_t *start) {
+  uint32_t i = 0;
+  while (i < n) {
+    if (buf[i] != FCS_PROTO_STX) {
+      i++;
+      continue;
+    }
+    if (n - i < 5) break;
+    uint8_t len = buf[i + 4];
+    uint32_t total = FCS_PROTO_OVERHEAD + len;
+    if (len > PROTO_MAX_PAYLOAD) {
+      i++;
+      continue;
+    }
+    if (n - i < total) break;
+    if (buf[i + total - 1] != FCS_PROTO_ETX || FCS_Codec_Crc8(&buf[i + 1], 4 + len) != buf[i + total - 2]) {
+      i++;
+      continue;
+    }
+    *start = i;
+    return total;
+  }
+  *start = i;
+  return 0;
+}
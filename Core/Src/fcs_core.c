@@ -1,25 +1,47 @@
 #include "fcs_core.h"
 #include "fcs_math.h"
+#include "fcs_aead.h"
+#include "fcs_sched.h"
+#include "fcs_clock.h"
+#include "fcs_stack.h"
+#include "fcs_fmt.h"
+#include "fcs_rtos.h"
 #include "bmp280.h"
 #include "input.h"
 #include "ui.h" // For UI Context if needed, but mainly for State Enums
-#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 
 // [Internal State] Serial Ring Buffer
-#define RING_SIZE 128
+#define RING_SIZE 256
+_Static_assert(RING_SIZE <= 256, "Ring indices are uint8_t");
 static uint8_t u_buf[RING_SIZE];
 static volatile uint8_t u_head = 0;
 static volatile uint8_t u_tail = 0;
 static uint8_t rx_byte_latched; // Temp holder for ISR
 static volatile uint32_t u_overflow_cnt = 0;
+static uint16_t u_rx_frames = 0;  // Valid frames (CRC ok)
+static uint16_t u_crc_errors = 0; // Frames rejected by CRC
+static uint16_t u_frame_errors = 0; // Candidates dropped as malformed or oversized
+static UART_HandleTypeDef *u_link = NULL; // USART1 (HC-06), set by FCS_Serial_Start
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+static volatile uint8_t u_flow_paused = 0;   // Sender has been asked to stop
+#endif
+#if FCS_FLOW_CTRL == FCS_FLOW_XONXOFF
+static volatile uint8_t u_flow_pending = 0;  // XON/XOFF still to send (transmitter was busy)
+#endif
+
+static void FCS_Fill_Result(const FireData_t *fire, FCS_BatchResult_t *res);
 
 // [1] 초기화 (Initialization)
 void FCS_Init_System(FCS_System_t *sys) {
   memset(sys, 0, sizeof(FCS_System_t));
   sys->state = UI_BOOT;
   sys->env.prop_temp = 21.0f;
+  // Standard atmosphere until the BMP280's first sample: missions are served before it is up
+  sys->env.air_temp = 15.0f;
+  sys->env.air_pressure = 1013.25f;
 }
 
 void FCS_Set_Battery(FCS_System_t *sys, int zone, char band, double e, double n, float alt) {
@@ -54,12 +76,71 @@ void FCS_Update_Input(FCS_System_t *sys, ADC_HandleTypeDef *hadc) {
 
 void FCS_Update_Sensors(FCS_System_t *sys) {
   BMP280_Data_t bmp_tmp;
+  PROBE_BEGIN(PROBE_SENSOR);
   BMP280_Read_All(&bmp_tmp);
+  PROBE_END(PROBE_SENSOR);
   sys->env.air_temp = bmp_tmp.temperature;
   sys->env.air_pressure = bmp_tmp.pressure;
 }
 
+void FCS_Update_LoopTime(FCS_System_t *sys, uint32_t busy_us) {
+  if (busy_us > 0xFFFF) busy_us = 0xFFFF;
+  sys->diag.loop_us = (uint16_t)busy_us;
+  if (sys->diag.loop_us > sys->diag.loop_max_us) sys->diag.loop_max_us = sys->diag.loop_us;
+}
+
+void FCS_Update_Sleep(FCS_System_t *sys, uint16_t sleep_pm, uint16_t wake_dhz) {
+  sys->diag.sleep_pm = sleep_pm;
+  sys->diag.wake_dhz = wake_dhz;
+}
+
 // [3] Serial/Comm Task Helper
+static uint8_t Serial_Ring_Fill(void) {
+    return (uint8_t)((u_head - u_tail + RING_SIZE) % RING_SIZE);
+}
+
+#if FCS_FLOW_CTRL == FCS_FLOW_XONXOFF
+// ISR, or main loop with IRQs off. Only writes DR while no HAL transmit owns
+// the UART; otherwise the byte waits in u_flow_pending (latest state wins).
+static void Serial_Flow_Put(UART_HandleTypeDef *huart, uint8_t ch) {
+    if (huart->gState == HAL_UART_STATE_READY && (huart->Instance->SR & USART_SR_TXE)) {
+        huart->Instance->DR = ch;
+        u_flow_pending = 0;
+    } else {
+        u_flow_pending = ch;
+    }
+}
+
+// Main loop: send a flow byte the ISR had to leave behind
+static void Serial_Flow_Flush(void) {
+    if (u_flow_pending == 0 || !u_link) return;
+    __disable_irq();
+    if (u_flow_pending) Serial_Flow_Put(u_link, u_flow_pending);
+    __enable_irq();
+}
+#endif
+
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+// Both UARTs feed the ring, but only the link peer is paced: the signal
+// always goes out on USART1, whichever UART's byte crossed the mark
+static void Serial_Flow_Signal(uint8_t pause) {
+#if FCS_FLOW_CTRL == FCS_FLOW_RTSCTS
+    HAL_GPIO_WritePin(FCS_FLOW_RTS_PORT, FCS_FLOW_RTS_PIN, pause ? GPIO_PIN_SET : GPIO_PIN_RESET);
+#else
+    if (u_link) Serial_Flow_Put(u_link, pause ? FCS_FLOW_XOFF : FCS_FLOW_XON);
+#endif
+}
+
+// Main loop, after draining: let the sender go again below the low mark
+static void Serial_Flow_Resume(void) {
+    if (!u_flow_paused || Serial_Ring_Fill() > FCS_FLOW_LOW_WATER) return;
+    __disable_irq();
+    u_flow_paused = 0;
+    Serial_Flow_Signal(0);
+    __enable_irq();
+}
+#endif
+
 void FCS_UART_RxCallback(UART_HandleTypeDef *huart) {
     uint8_t next_head = (u_head + 1) % RING_SIZE;
     if (next_head != u_tail) {
@@ -68,10 +149,48 @@ void FCS_UART_RxCallback(UART_HandleTypeDef *huart) {
     } else {
         u_overflow_cnt++;
     }
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+    if (!u_flow_paused && Serial_Ring_Fill() >= FCS_FLOW_HIGH_WATER) {
+        u_flow_paused = 1;
+        Serial_Flow_Signal(1);
+    }
+#endif
     HAL_UART_Receive_IT(huart, &rx_byte_latched, 1);
 }
 
+#if FCS_FLOW_CTRL == FCS_FLOW_RTSCTS
+// Not in the CubeMX config: pins and CTS are added on top of MX_USART1_UART_Init
+static void Serial_Flow_Init(UART_HandleTypeDef *huart) {
+    GPIO_InitTypeDef gpio = {0};
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    gpio.Pin = FCS_FLOW_CTS_PIN;
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Pull = GPIO_PULLDOWN; // Unwired CTS reads as "clear to send"
+    gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    gpio.Alternate = GPIO_AF7_USART1;
+    HAL_GPIO_Init(GPIOA, &gpio);
+
+    HAL_GPIO_WritePin(FCS_FLOW_RTS_PORT, FCS_FLOW_RTS_PIN, GPIO_PIN_RESET); // Ready
+    gpio.Pin = FCS_FLOW_RTS_PIN;
+    gpio.Mode = GPIO_MODE_OUTPUT_PP;
+    gpio.Pull = GPIO_NOPULL;
+    gpio.Alternate = 0;
+    HAL_GPIO_Init(FCS_FLOW_RTS_PORT, &gpio);
+
+    huart->Init.HwFlowCtl = UART_HWCONTROL_CTS; // Kept by Serial_Apply_Baud re-inits
+    if (HAL_UART_Init(huart) != HAL_OK) {
+        Error_Handler();
+    }
+}
+#endif
+
 void FCS_Serial_Start(UART_HandleTypeDef *huart) {
+    if (huart->Instance == USART1) {
+        u_link = huart;
+#if FCS_FLOW_CTRL == FCS_FLOW_RTSCTS
+        Serial_Flow_Init(huart);
+#endif
+    }
     HAL_UART_Receive_IT(huart, &rx_byte_latched, 1);
 }
 
@@ -79,188 +198,1114 @@ uint32_t FCS_Serial_GetOverflowCount(void) {
     return u_overflow_cnt;
 }
 
-// [Internal State] Parser Machine
-typedef enum {
-  P_IDLE,
-  P_CMD,
-  P_SALT,
-  P_LEN,
-  P_PAYLOAD,
-  P_CRC,
-  P_ETX
-} ParserState_t;
+uint16_t FCS_Serial_GetFrameErrorCount(void) {
+    return u_frame_errors;
+}
+
+// [Baud Negotiation State]
+static const uint32_t baud_supported[] = { 9600, 115200, 230400, 460800, 921600 };
+static uint32_t baud_current = FCS_BAUD_DEFAULT;
+static uint8_t  baud_confirmed = 1;        // 0 = on probation after a switch
+static uint32_t baud_last_valid_tick = 0;  // Last CRC-valid frame
 
-static ParserState_t p_state = P_IDLE;
+uint32_t FCS_Serial_GetBaud(void) {
+    return baud_current;
+}
+
+static int Serial_Baud_Supported(uint32_t baud) {
+    for (unsigned i = 0; i < sizeof(baud_supported) / sizeof(baud_supported[0]); i++) {
+        if (baud_supported[i] == baud) return 1;
+    }
+    return 0;
+}
+
+// Re-clock the link UART and restart the RX interrupt chain.
+// Bytes still queued were received at the old rate, so they are dropped.
+static void Serial_Apply_Baud(UART_HandleTypeDef *huart, uint32_t baud) {
+    HAL_UART_AbortReceive(huart);
+    huart->Init.BaudRate = baud;
+    if (HAL_UART_Init(huart) != HAL_OK) {
+        Error_Handler();
+    }
+    u_tail = u_head;
+    baud_current = baud;
+    baud_confirmed = (baud == FCS_BAUD_DEFAULT);
+    baud_last_valid_tick = HAL_GetTick();
+    HAL_UART_Receive_IT(huart, &rx_byte_latched, 1);
+    DBG_PRINT("[UART] Link baud -> %lu\r\n", (unsigned long)baud);
+}
+
+// [Internal State] Parser
+// Bytes of the candidate frame are kept raw until it is accepted, so a
+// candidate that fails (bad LEN/ETX/CRC, stall) can be rescanned from its next
+// STX instead of losing the good frame that may be hiding inside it.
+#define RAW_LEN_OFS      4  // [STX][CMD][SEQ][SALT][LEN]
+#define RAW_PAYLOAD_OFS  5
+static uint8_t p_raw[FCS_PROTO_OVERHEAD + PROTO_MAX_PAYLOAD];
+static uint8_t p_raw_len = 0;
+static uint32_t p_last_rx_tick = 0;
+
+// Accepted frame (valid for Proto_Dispatch)
+// p_payload points into the request's pool block; the CRC byte behind the
+// payload is free after the check and holds the text terminator.
 static uint8_t p_cmd = 0;
+static uint8_t p_seq = 0;
 static uint8_t p_salt = 0;
 static uint8_t p_len = 0;
-static uint8_t p_idx = 0;
-static uint8_t p_payload[128]; // Max Payload
-static uint8_t p_crc_recv = 0;
-static uint32_t p_last_rx_tick = 0;
+static uint8_t *p_payload;
+
+// [Locks] RTOS build only (fcs_rtos.h); the cooperative build runs everything in one loop.
+// Link: ring, parser, pool, TX and the AEAD state. State: FCS_System_t and the
+// handlers' statics. Taken in that order; MISSION never holds state while taking link.
+#if FCS_USE_RTOS
+#define LINK_LOCK()     FCS_Rtos_Link_Lock()
+#define LINK_UNLOCK()   FCS_Rtos_Link_Unlock()
+#define STATE_LOCK()    FCS_Rtos_State_Lock()
+#define STATE_UNLOCK()  FCS_Rtos_State_Unlock()
+#else
+#define LINK_LOCK()     ((void)0)
+#define LINK_UNLOCK()   ((void)0)
+#define STATE_LOCK()    ((void)0)
+#define STATE_UNLOCK()  ((void)0)
+#endif
+
+// [Internal State] Frame Pool (main loop only, the ISR stays on u_buf)
+// Block layout is the wire frame: [STX|code][CMD][SEQ][SALT][LEN][PAYLOAD][CRC][ETX|0x00]
+#define BLK_BODY_OFS     1  // [CMD]; byte 0 is left for the STX or COBS code
+#define BLK_PAYLOAD_OFS  5
+#if FCS_PROTO_AEAD
+#define BLK_APP_OFS      (BLK_PAYLOAD_OFS + FCS_AEAD_HDR_SIZE) // Plaintext, behind [SESS][CTR]
+#else
+#define BLK_APP_OFS      BLK_PAYLOAD_OFS
+#endif
+typedef struct {
+  uint8_t data[FCS_POOL_BLOCK_SIZE];
+  uint32_t stamp; // DWT cycles when a request was accepted
+} Pool_Block_t;
+
+static Pool_Block_t pool_blk[FCS_POOL_BLOCKS];
+static uint8_t pool_used = 0;   // Bit i set: pool_blk[i] is owned by a stage
+static uint8_t pool_in_use = 0;
+static uint8_t pool_hwm = 0;
+
+// [Internal State] Job Queue (owned request blocks, oldest at j_tail)
+static Pool_Block_t *j_queue[FCS_JOB_QUEUE_LEN];
+static uint8_t j_head = 0;
+static uint8_t j_tail = 0;
+static uint8_t j_count = 0;
+static uint32_t j_done = 0;
+static uint32_t j_delay_max_cyc = 0;
+static uint64_t j_delay_sum_cyc = 0;
+static uint16_t j_busy = 0;
+static uint32_t j_pass_cyc = 0; // Handler cycles used by this pass's jobs
+#if FCS_USE_RTOS
+_Static_assert(FCS_RTOS_JOB_DEPTH >= FCS_JOB_QUEUE_LEN, "Mission queue must take every job the pool allows");
+#endif
 #define PARSER_TIMEOUT_MS   500
-#define PROTO_MAX_PAYLOAD   120
 #define UART_TX_TIMEOUT_MS  100
 
-// Simple CRC8 (Polynomial 0x07)
-static uint8_t Calc_CRC8(uint8_t *data, int len, uint8_t initial) {
-  uint8_t crc = initial;
-  for (int i = 0; i < len; i++) {
-    crc ^= data[i];
-    for (int j = 0; j < 8; j++) {
-      if (crc & 0x80) crc = (crc << 1) ^ 0x07;
-      else crc <<= 1;
+// [Payload Protection] Seal on TX, unseal before dispatch (see [Frame Version]).
+// Cipher, CRC and framing live in fcs_codec.c, shared with the client.
+static uint16_t a_auth_fail = 0;  // Requests refused with FCS_NAK_AUTH
+
+#if FCS_PROTO_AEAD
+static const uint8_t a_key[FCS_AEAD_KEY_SIZE] = { FCS_AEAD_KEY_BYTES };
+static uint32_t a_tx_sess;        // Our nonce prefix, picked at the first frame after boot
+static uint32_t a_tx_ctr = 0;
+static uint8_t  a_tx_ready = 0;
+static uint32_t a_rx_sess;        // Client session and its newest authentic CTR
+static uint32_t a_rx_ctr;
+static uint8_t  a_rx_valid = 0;
+static uint32_t a_max_cyc = 0;
+static uint16_t a_over = 0;
+
+static void Proto_Aead_Cost(uint32_t cyc, uint8_t len) {
+  if (cyc > a_max_cyc) a_max_cyc = cyc;
+  if (cyc > FCS_AEAD_BUDGET_BASE + (uint32_t)FCS_AEAD_BUDGET_CPB * len) a_over++;
+}
+
+// Header [CMD][SEQ][SALT][LEN] at d[1] holds the plaintext length. Encrypts the
+// plaintext at BLK_APP_OFS and frames it as [SESS][CTR][ciphertext][tag].
+// Returns: wire LEN
+static uint8_t Proto_Seal(uint8_t *d) {
+  if (!a_tx_ready) {
+    // No RNG on the F401: the cycle count when the first frame goes out
+    // depends on the radio link's timing, which is enough for a nonce prefix
+    a_tx_sess = DWT->CYCCNT ^ (HAL_GetTick() << 16) ^ u_rx_frames;
+    a_tx_ready = 1;
+  }
+  uint8_t len = d[4];
+  uint32_t t0 = DWT->CYCCNT;
+  uint8_t wire = FCS_Codec_Seal(&d[BLK_BODY_OFS], FCS_PROTO_FLAGS, a_key, a_tx_sess, a_tx_ctr, FCS_CODEC_DIR_FROM_FCS);
+  Proto_Aead_Cost(DWT->CYCCNT - t0, len);
+  if (++a_tx_ctr == 0) a_tx_ready = 0; // Counter wrapped: new prefix
+  return wire;
+}
+
+// Accepted request (p_*): checks version, counter window and tag, decrypts in
+// place and narrows p_payload/p_len to the plaintext. p_salt becomes the low
+// CTR byte, which tells a new request from a retransmit like a salt did.
+// Returns: 1 if authentic, 0 if not
+static int Proto_Unseal(void) {
+  if (p_salt != FCS_AEAD_VERSION || p_len < FCS_AEAD_OVERHEAD) return 0;
+  uint32_t sess, ctr;
+  memcpy(&sess, p_payload, 4);
+  memcpy(&ctr, p_payload + 4, 4);
+  if (a_rx_valid && sess == a_rx_sess && (int32_t)(a_rx_ctr - ctr) >= FCS_AEAD_REPLAY_WINDOW) return 0;
+
+  uint32_t t0 = DWT->CYCCNT;
+  int len = FCS_Codec_Open(p_payload - 4, FCS_PROTO_FLAGS, a_key, FCS_CODEC_DIR_TO_FCS);
+  Proto_Aead_Cost(DWT->CYCCNT - t0, (uint8_t)(p_len - FCS_AEAD_OVERHEAD));
+  if (len < 0) return 0;
+
+  if (!a_rx_valid || sess != a_rx_sess) {
+    a_rx_sess = sess; // New client session (reconnect)
+    a_rx_ctr = ctr;
+    a_rx_valid = 1;
+  } else if ((int32_t)(ctr - a_rx_ctr) > 0) {
+    a_rx_ctr = ctr;
+  }
+  p_payload += FCS_AEAD_HDR_SIZE;
+  p_len = (uint8_t)len;
+  p_salt = (uint8_t)ctr;
+  return 1;
+}
+#else
+static uint8_t Proto_Seal(uint8_t *d) {
+  return FCS_Codec_Seal(&d[BLK_BODY_OFS], FCS_PROTO_FLAGS, NULL, 0, 0, FCS_CODEC_DIR_FROM_FCS);
+}
+
+static int Proto_Unseal(void) {
+  FCS_Codec_Open(p_payload - 4, FCS_PROTO_FLAGS, NULL, FCS_CODEC_DIR_TO_FCS);
+  return 1;
+}
+#endif
+
+// Link TX. With XON/XOFF, flow bytes are escaped out of the data and a pending
+// XOFF from the ISR goes out between two data bytes rather than after the frame.
+static void Serial_Write(UART_HandleTypeDef *huart, const uint8_t *data, uint8_t n) {
+#if FCS_FLOW_CTRL == FCS_FLOW_XONXOFF
+  for (uint8_t i = 0; i < n; i++) {
+    Serial_Flow_Flush();
+    uint8_t b = data[i];
+    if (b == FCS_FLOW_XON || b == FCS_FLOW_XOFF || b == FCS_FLOW_ESC) {
+      uint8_t esc[2] = { FCS_FLOW_ESC, (uint8_t)(b ^ 0x20) };
+      HAL_UART_Transmit(huart, esc, sizeof(esc), UART_TX_TIMEOUT_MS);
+    } else {
+      HAL_UART_Transmit(huart, &b, 1, UART_TX_TIMEOUT_MS);
     }
   }
-  return crc;
+  Serial_Flow_Flush();
+#else
+  HAL_UART_Transmit(huart, data, n, UART_TX_TIMEOUT_MS);
+#endif
 }
 
-// [3] Serial/Comm Task (State Machine Parser)
-void FCS_Task_Serial(FCS_System_t *sys, UART_HandleTypeDef *huart) {
-  // Reset parser if incomplete frame stalls > 500ms
-  if (p_state != P_IDLE && (HAL_GetTick() - p_last_rx_tick > PARSER_TIMEOUT_MS)) {
-    p_state = P_IDLE;
+// Takes a free block, leaving 'reserve' blocks behind. NULL if there are none.
+static Pool_Block_t *Pool_Alloc(uint8_t reserve) {
+  LINK_LOCK();
+  if (FCS_POOL_BLOCKS - pool_in_use <= reserve) {
+    LINK_UNLOCK();
+    return NULL;
   }
+  uint8_t i = 0;
+  while (pool_used & (1u << i)) i++;
+  pool_used |= (uint8_t)(1u << i);
+  if (++pool_in_use > pool_hwm) pool_hwm = pool_in_use;
+  LINK_UNLOCK();
+  return &pool_blk[i];
+}
+
+static void Pool_Free(Pool_Block_t *blk) {
+  LINK_LOCK();
+  pool_used &= (uint8_t)~(1u << (blk - pool_blk));
+  pool_in_use--;
+  LINK_UNLOCK();
+}
+
+// With flow control, received frames wait in the ring until a block is free
+static int Proto_Rx_Held(void) {
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+  return pool_in_use >= FCS_POOL_BLOCKS - 1;
+#else
+  return 0;
+#endif
+}
+
+// Framed Reply: [STX][CMD][SEQ][SALT][LEN][PAYLOAD][CRC][ETX] (payload sealed in place)
+// SEQ echoes the request so the client can ack its window out of order.
+// The plaintext is already at BLK_APP_OFS; the frame is built around it and
+// the block is freed once it is on the wire.
+static void Proto_Send_Block(UART_HandleTypeDef *huart, Pool_Block_t *blk, uint8_t cmd, uint8_t seq, uint8_t salt, uint8_t len) {
+  uint8_t *d = blk->data;
+  d[1] = cmd;
+  d[2] = seq;
+  d[3] = salt;
+  d[4] = len;
+  LINK_LOCK(); // Seal and write in CTR order
+  Proto_Seal(d); // LEN becomes the wire length
+  Serial_Write(huart, d, FCS_Codec_Frame(d, FCS_PROTO_FLAGS));
+  Pool_Free(blk);
+  LINK_UNLOCK();
+}
+
+// Small replies built elsewhere (NAKs): copied into a block and sent
+static void Proto_Send_Frame(UART_HandleTypeDef *huart, uint8_t cmd, uint8_t seq, uint8_t salt, const uint8_t *payload, uint8_t len) {
+  if (len > FCS_APP_MAX_PAYLOAD) return;
+  Pool_Block_t *blk = Pool_Alloc(0); // Reply reserve: never NULL from the main loop
+  if (blk == NULL) return;
+  memcpy(&blk->data[BLK_APP_OFS], payload, len);
+  Proto_Send_Block(huart, blk, cmd, seq, salt, len);
+}
+
+// Negative Reply: [req_cmd][FCS_NakCode_t]
+static void Proto_Send_Nak(UART_HandleTypeDef *huart, uint8_t req_cmd, uint8_t seq, uint8_t salt, FCS_NakCode_t code) {
+  uint8_t nak[2] = {req_cmd, (uint8_t)code};
+  Proto_Send_Frame(huart, FCS_CMD_NAK, seq, salt, nak, sizeof(nak));
+}
+
+// [Internal State] Telemetry Stream
+typedef struct __attribute__((packed)) {
+  FCS_TelemEnv_t env;
+  FCS_FireResult_t fire;
+  FCS_TelemUi_t ui;
+  FCS_TelemLoop_t loop;
+  FCS_TelemSerial_t serial;
+} TelemSnapshot_t;
+
+// Field layout in mask bit order (bit i -> t_fields[i])
+static const struct { uint8_t off, size; } t_fields[] = {
+  { offsetof(TelemSnapshot_t, env),    sizeof(FCS_TelemEnv_t) },
+  { offsetof(TelemSnapshot_t, fire),   sizeof(FCS_FireResult_t) },
+  { offsetof(TelemSnapshot_t, ui),     sizeof(FCS_TelemUi_t) },
+  { offsetof(TelemSnapshot_t, loop),   sizeof(FCS_TelemLoop_t) },
+  { offsetof(TelemSnapshot_t, serial), sizeof(FCS_TelemSerial_t) },
+};
+
+static uint16_t t_period_ms = 0;   // 0 = not subscribed
+static uint32_t t_last_tick = 0;
+static uint8_t t_count = 0;
+static uint8_t t_since_key = 0;
+static TelemSnapshot_t t_sent;     // Receiver's view after the last frame
+
+static int16_t Telem_Scale(float v) {
+  return (int16_t)(v * 10.0f + (v < 0 ? -0.5f : 0.5f));
+}
+
+static void Telem_Snapshot(FCS_System_t *sys, TelemSnapshot_t *t) {
+  t->env.air_temp_dc = Telem_Scale(sys->env.air_temp);
+  t->env.pressure_dhpa = (uint16_t)(sys->env.air_pressure * 10.0f + 0.5f);
+  t->env.prop_temp_dc = Telem_Scale(sys->env.prop_temp);
+
+  FCS_Fill_Result(&sys->fire, &t->fire.sol);
+  t->fire.tof_ds = (uint16_t)(sys->fire.time_of_flight * 10.0f + 0.5f);
+
+  t->ui.ui_state = (uint8_t)sys->state;
+  t->ui.cursor = sys->cursor_pos;
+
+  t->loop.loop_us = sys->diag.loop_us;
+  t->loop.loop_max_us = sys->diag.loop_max_us;
+
+  t->serial.rx_frames = u_rx_frames;
+  t->serial.crc_errors = u_crc_errors;
+  t->serial.rx_overflow = (uint16_t)u_overflow_cnt;
+}
+
+// Builds [flags][count][mask][fields]; returns payload length, 0 if nothing changed
+static uint8_t Telem_Build(FCS_System_t *sys, uint8_t flags, uint8_t *out) {
+  TelemSnapshot_t now;
+  Telem_Snapshot(sys, &now);
+
+  uint8_t mask = 0;
+  uint8_t len = FCS_TELEM_HDR_SIZE;
+  for (uint8_t i = 0; i < sizeof(t_fields) / sizeof(t_fields[0]); i++) {
+    const uint8_t *cur = (const uint8_t*)&now + t_fields[i].off;
+    uint8_t *prev = (uint8_t*)&t_sent + t_fields[i].off;
+    if ((flags & FCS_TELEM_F_KEY) || memcmp(cur, prev, t_fields[i].size) != 0) {
+      memcpy(&out[len], cur, t_fields[i].size);
+      memcpy(prev, cur, t_fields[i].size);
+      len += t_fields[i].size;
+      mask |= (uint8_t)(1u << i);
+    }
+  }
+  if (mask == 0) return 0;
+
+  sys->diag.loop_max_us = 0; // Worst case restarts with each reported window
+  out[0] = flags;
+  out[1] = t_count++;
+  out[2] = mask;
+  return len;
+}
+
+// Periodic stream frame (called from the serial task, outside any reply)
+static void Telem_Service(FCS_System_t *sys, UART_HandleTypeDef *huart) {
+  if (t_period_ms == 0 || HAL_GetTick() - t_last_tick < t_period_ms) return;
+  t_last_tick = HAL_GetTick();
+
+  // Keyframe spacing counts periods, so an idle system still sends one
+  uint8_t flags = FCS_TELEM_F_STREAM;
+  if (++t_since_key >= FCS_TELEM_KEY_EVERY) {
+    flags |= FCS_TELEM_F_KEY;
+    t_since_key = 0;
+  }
+
+  Pool_Block_t *blk = Pool_Alloc(0);
+  if (blk == NULL) return;
+  uint8_t seq = t_count;
+  STATE_LOCK();
+  uint8_t len = Telem_Build(sys, flags, &blk->data[BLK_APP_OFS]);
+  STATE_UNLOCK();
+  if (len > 0) Proto_Send_Block(huart, blk, FCS_CMD_TELEMETRY, seq, (uint8_t)DWT->CYCCNT, len);
+  else Pool_Free(blk);
+}
+
+// [Command Handlers]
+// Read the accepted frame (p_payload/p_len), write the reply payload to 'out'.
+// Return the reply length, or -FCS_NakCode_t to reject. Payload length bounds
+// are checked by the dispatcher from the table before the handler runs.
+static uint32_t p_baud_pending = 0; // BAUD_SET: applied after its ACK is out
+
+static int Cmd_Target_Input(FCS_System_t *sys, uint8_t *out) {
+  if (FCS_Process_Command(sys, (char*)p_payload, (FCS_FireResult_t*)out) <= 0) return -FCS_NAK_PARSE;
+  return sizeof(FCS_FireResult_t);
+}
+
+static int Cmd_Target_Bin(FCS_System_t *sys, uint8_t *out) {
+  if (FCS_Process_TargetRecord(sys, p_payload, p_len, (FCS_FireResult_t*)out) <= 0) return -FCS_NAK_LEN;
+  return sizeof(FCS_FireResult_t);
+}
+
+static int Cmd_Target_Batch(FCS_System_t *sys, uint8_t *out) {
+  int rc = FCS_Process_TargetBatch(sys, p_payload, p_len, out);
+  return (rc > 0) ? rc : -FCS_NAK_LEN;
+}
+
+// Last delta frame and the previous target it was solved against
+static struct {
+  uint8_t valid, seq, salt, len;
+  uint8_t payload[FCS_DELTA_MAX_SIZE];
+  UTM_Coord_t last;
+} d_prev;
+
+static int Cmd_Target_Delta(FCS_System_t *sys, uint8_t *out) {
+  int again = d_prev.valid && d_prev.seq == p_seq && d_prev.salt == p_salt &&
+              d_prev.len == p_len && memcmp(d_prev.payload, p_payload, p_len) == 0;
+  if (!again) {
+    d_prev.valid = 1;
+    d_prev.seq = p_seq;
+    d_prev.salt = p_salt;
+    d_prev.len = p_len;
+    memcpy(d_prev.payload, p_payload, p_len);
+    d_prev.last = sys->tgt_pos;
+  }
+  int rc = FCS_Process_TargetDelta(sys, &d_prev.last, p_payload, p_len, (FCS_FireResult_t*)out);
+  return (rc > 0) ? (int)sizeof(FCS_FireResult_t) : rc;
+}
+
+static int Cmd_Known_Set(FCS_System_t *sys, uint8_t *out) {
+  int rc = FCS_Process_KnownPoint(sys, p_payload, p_len);
+  if (rc < 0) return rc;
+  out[0] = (uint8_t)rc;
+  return 1;
+}
+
+static int Cmd_Baud_Set(FCS_System_t *sys, uint8_t *out) {
+  uint32_t baud;
+  memcpy(&baud, p_payload, sizeof(baud));
+  if (!Serial_Baud_Supported(baud)) return -FCS_NAK_PARAM;
+  // ACK leaves at the old rate (Transmit returns after TC), then switch
+  memcpy(out, &baud, sizeof(baud)); // Send_Block encrypts the reply in place
+  p_baud_pending = baud;
+  return sizeof(baud);
+}
+
+static int Cmd_Telem_Sub(FCS_System_t *sys, uint8_t *out) {
+  uint16_t period;
+  memcpy(&period, p_payload, sizeof(period));
+  if (period != 0 && period < FCS_TELEM_MIN_PERIOD_MS) return -FCS_NAK_PARAM;
+  t_period_ms = period;
+  t_last_tick = HAL_GetTick();
+  t_since_key = 0;
+  return Telem_Build(sys, FCS_TELEM_F_KEY, out); // Reply is always a full snapshot
+}
+
+static uint16_t Sat16(uint64_t v) {
+  return (v > 0xFFFF) ? 0xFFFF : (uint16_t)v;
+}
+
+// Copy a name into a zeroed fixed field, cut to fit with no terminator needed
+static void Copy_Name(char *dst, const char *src, size_t size) {
+  memcpy(dst, src, strnlen(src, size));
+}
+
+static int Cmd_Status_Req(FCS_System_t *sys, uint8_t *out) {
+  FCS_StatusReply_t st;
+  st.ui_state = (uint8_t)sys->state;
+  st.zone = (uint8_t)sys->user_pos.zone;
+  st.band = (uint8_t)sys->user_pos.band;
+  st.fire_error = (uint8_t)sys->fire.error;
+  st.rx_overflow = u_overflow_cnt;
+  uint32_t cyc_per_us = SystemCoreClock / 1000000U;
+  uint32_t max_us = j_delay_max_cyc / cyc_per_us;
+  uint32_t mean_us = j_done ? (uint32_t)(j_delay_sum_cyc / j_done) / cyc_per_us : 0;
+  st.job_delay_max_us = (max_us > 0xFFFF) ? 0xFFFF : (uint16_t)max_us;
+  st.job_delay_mean_us = (mean_us > 0xFFFF) ? 0xFFFF : (uint16_t)mean_us;
+  st.job_busy = j_busy;
+  st.pool_hwm = pool_hwm;
+  st.pool_blocks = FCS_POOL_BLOCKS;
+#if FCS_PROTO_AEAD
+  st.aead_max_cyc = (a_max_cyc > 0xFFFF) ? 0xFFFF : (uint16_t)a_max_cyc;
+  st.aead_over = a_over;
+#else
+  st.aead_max_cyc = 0;
+  st.aead_over = 0;
+#endif
+  st.auth_fail = a_auth_fail;
+  st.sleep_pm = sys->diag.sleep_pm;
+  st.wake_dhz = sys->diag.wake_dhz;
+  const FCS_SchedPass_t *pass = FCS_Sched_Pass();
+  st.pass_over = Sat16(pass->overruns);
+  st.pass_max_us = pass->max_us;
+  const FCS_Task_t *top = (pass->max_task >= 0) ? FCS_Sched_Task((uint8_t)pass->max_task) : NULL;
+  memset(st.pass_task, 0, sizeof(st.pass_task));
+  if (top) Copy_Name(st.pass_task, top->name, sizeof(st.pass_task)); // None in the RTOS build
+  st.pass_streak = (pass->max_streak > 0xFF) ? 0xFF : (uint8_t)pass->max_streak;
+  st.reset_wdg = sys->diag.reset_wdg;
+  st.boot_link_ms = sys->diag.boot_link_ms;
+  st.boot_done_ms = sys->diag.boot_done_ms;
+  st.first_fire_ms = sys->diag.first_fire_ms;
+  st.boot_fail = sys->diag.boot_fail;
+  FCS_ClkStats_t clk;
+  FCS_Clock_Stats(&clk);
+  st.clk_fast_ms = clk.ms[FCS_CLK_FAST];
+  st.clk_slow_ms = clk.ms[FCS_CLK_SLOW];
+  st.clk_switches = clk.switches;
+  st.stack_hwm = Sat16(FCS_Stack_Hwm());
+  st.stack_budget = Sat16(FCS_Stack_Budget());
+  memcpy(out, &st, sizeof(st));
+  return sizeof(st);
+}
+
+static int Cmd_Stats_Req(FCS_System_t *sys, uint8_t *out);
+
+// [start_idx][flags] -> [start_idx][total][n x FCS_TaskStat_t]
+static int Cmd_Tasks_Req(FCS_System_t *sys, uint8_t *out) {
+  uint8_t start = (p_len > 0) ? p_payload[0] : 0;
+  uint8_t flags = (p_len > 1) ? p_payload[1] : 0;
+  uint8_t total = FCS_Sched_Count();
+  uint8_t len = 2;
+
+  out[0] = start;
+  out[1] = total;
+  for (uint8_t i = start; i < total && i < start + FCS_TASKS_PER_FRAME; i++) {
+    const FCS_Task_t *t = FCS_Sched_Task(i);
+    FCS_TaskStat_t rec;
+    memset(&rec, 0, sizeof(rec));
+    Copy_Name(rec.name, t->name, sizeof(rec.name));
+    rec.period_ms = (uint16_t)(t->period_us / 1000U);
+    rec.runs = t->runs;
+    rec.overruns = (uint16_t)t->overruns;
+    rec.skipped = (uint16_t)t->skipped;
+    rec.mean_us = Sat16(t->runs ? t->total_us / t->runs : 0);
+    rec.max_us = Sat16(t->max_us);
+    rec.max_late_us = Sat16(t->max_late_us);
+    memcpy(&out[len], &rec, sizeof(rec));
+    len += sizeof(rec);
+  }
+
+  if (flags & FCS_STATS_F_RESET) FCS_Sched_Reset_Stats();
+  return len;
+}
+
+static int Cmd_Probes_Req(FCS_System_t *sys, uint8_t *out) {
+  uint8_t start = (p_len > 0) ? p_payload[0] : 0;
+  uint8_t flags = (p_len > 1) ? p_payload[1] : 0;
+  uint8_t len = 2;
+
+  out[0] = start;
+  out[1] = (uint8_t)PROBE_COUNT;
+  for (uint8_t i = start; i < PROBE_COUNT && i < start + FCS_PROBES_PER_FRAME; i++) {
+    FCS_ProbeStat_t rec;
+    FCS_Probe_Stat(i, &rec);
+    memcpy(&out[len], &rec, sizeof(rec));
+    len += sizeof(rec);
+  }
+
+  if (flags & FCS_STATS_F_RESET) FCS_Probe_Reset();
+  return len;
+}
+
+// [Command Table] ID, payload bounds, reply ID, handler
+typedef struct {
+  uint8_t cmd;
+  uint8_t min_len;
+  uint8_t max_len;
+  uint8_t reply;
+  int (*handler)(FCS_System_t *sys, uint8_t *out);
+} Proto_Cmd_t;
+
+static const Proto_Cmd_t p_cmds[] = {
+  { FCS_CMD_TARGET_INPUT, 1, FCS_APP_MAX_PAYLOAD, FCS_CMD_FIRE_RESULT, Cmd_Target_Input },
+  { FCS_CMD_TARGET_BIN, FCS_TARGET_RECORD_SIZE, FCS_TARGET_RECORD_SIZE, FCS_CMD_FIRE_RESULT, Cmd_Target_Bin },
+  { FCS_CMD_TARGET_BATCH, FCS_BATCH_HDR_SIZE, FCS_APP_MAX_PAYLOAD, FCS_CMD_BATCH_RESULT, Cmd_Target_Batch },
+  { FCS_CMD_TARGET_DELTA, FCS_DELTA_MIN_SIZE, FCS_DELTA_MAX_SIZE, FCS_CMD_FIRE_RESULT, Cmd_Target_Delta },
+  { FCS_CMD_KNOWN_SET, 1 + FCS_TARGET_RECORD_SIZE, 1 + FCS_TARGET_RECORD_SIZE, FCS_CMD_KNOWN_ACK, Cmd_Known_Set },
+  { FCS_CMD_STATUS_REQ, 0, 0, FCS_CMD_STATUS_ACK, Cmd_Status_Req },
+  { FCS_CMD_TELEM_SUB, 2, 2, FCS_CMD_TELEMETRY, Cmd_Telem_Sub },
+  { FCS_CMD_STATS_REQ, 0, 2, FCS_CMD_STATS_ACK, Cmd_Stats_Req },
+  { FCS_CMD_TASKS_REQ, 0, 2, FCS_CMD_TASKS_ACK, Cmd_Tasks_Req },
+  { FCS_CMD_PROBES_REQ, 0, 2, FCS_CMD_PROBES_ACK, Cmd_Probes_Req },
+  { FCS_CMD_BAUD_SET, 4, 4, FCS_CMD_BAUD_ACK, Cmd_Baud_Set },
+};
+#define P_CMD_COUNT (sizeof(p_cmds) / sizeof(p_cmds[0]))
+
+// [Internal State] Per-command handler cost (DWT cycles)
+typedef struct {
+  uint32_t count;
+  uint32_t min_cyc;
+  uint32_t max_cyc;
+  uint64_t sum_cyc;
+} Proto_CmdStats_t;
+
+static Proto_CmdStats_t p_stats[P_CMD_COUNT];
+
+static void Proto_Stats_Record(uint8_t idx, uint32_t cyc) {
+  Proto_CmdStats_t *st = &p_stats[idx];
+  if (st->count == 0 || cyc < st->min_cyc) st->min_cyc = cyc;
+  if (cyc > st->max_cyc) st->max_cyc = cyc;
+  st->sum_cyc += cyc;
+  st->count++;
+}
+
+// [start_idx][flags] -> [start_idx][total][n x FCS_CmdStat_t]
+static int Cmd_Stats_Req(FCS_System_t *sys, uint8_t *out) {
+  uint8_t start = (p_len > 0) ? p_payload[0] : 0;
+  uint8_t flags = (p_len > 1) ? p_payload[1] : 0;
+  uint8_t len = 2;
 
-  while (u_head != u_tail) {
+  out[0] = start;
+  out[1] = (uint8_t)P_CMD_COUNT;
+  for (uint8_t i = start; i < P_CMD_COUNT && i < start + FCS_STATS_PER_FRAME; i++) {
+    FCS_CmdStat_t rec;
+    rec.cmd = p_cmds[i].cmd;
+    rec.count = p_stats[i].count;
+    rec.min_cyc = p_stats[i].min_cyc;
+    rec.max_cyc = p_stats[i].max_cyc;
+    rec.mean_cyc = p_stats[i].count ? (uint32_t)(p_stats[i].sum_cyc / p_stats[i].count) : 0;
+    memcpy(&out[len], &rec, sizeof(rec));
+    len += sizeof(rec);
+  }
+
+  if (flags & FCS_STATS_F_RESET) memset(p_stats, 0, sizeof(p_stats));
+  return len;
+}
+
+// Command Dispatch: every valid frame is answered by exactly one frame (result or NAK)
+// Handlers are idempotent, so a retransmitted SEQ is simply executed again.
+static void Proto_Dispatch(FCS_System_t *sys, UART_HandleTypeDef *huart) {
+  uint8_t idx = 0;
+  while (idx < P_CMD_COUNT && p_cmds[idx].cmd != p_cmd) idx++;
+
+  if (idx == P_CMD_COUNT) {
+    Proto_Send_Nak(huart, p_cmd, p_seq, p_salt, FCS_NAK_UNKNOWN_CMD);
+    return;
+  }
+  const Proto_Cmd_t *c = &p_cmds[idx];
+  if (p_len < c->min_len || p_len > c->max_len) {
+    Proto_Send_Nak(huart, p_cmd, p_seq, p_salt, FCS_NAK_LEN);
+    return;
+  }
+
+  // Reply is written straight into its block; the reserve makes this succeed
+  Pool_Block_t *tx = Pool_Alloc(0);
+  if (tx == NULL) return;
+  uint32_t t0 = DWT->CYCCNT;
+  STATE_LOCK();
+  int rc = c->handler(sys, &tx->data[BLK_APP_OFS]);
+  STATE_UNLOCK();
+  uint32_t cyc = DWT->CYCCNT - t0;
+  Proto_Stats_Record(idx, cyc);
+  j_pass_cyc += cyc;
+
+  if (rc < 0) {
+    Pool_Free(tx);
+    Proto_Send_Nak(huart, p_cmd, p_seq, p_salt, (FCS_NakCode_t)(-rc));
+    return;
+  }
+  Proto_Send_Block(huart, tx, c->reply, p_seq, p_salt, (uint8_t)rc);
+
+  if (p_baud_pending) {
+    LINK_LOCK();
+    Serial_Apply_Baud(huart, p_baud_pending);
+    p_baud_pending = 0;
+    p_raw_len = 0; // Anything behind it was sent at the old rate
+    LINK_UNLOCK();
+  }
+}
+
+// Body [CMD][SEQ][SALT][LEN][PAYLOAD][CRC] passed its CRC: move it out of the
+// receive buffer into a pool block, which the job queue then owns.
+static void Proto_Accept(UART_HandleTypeDef *huart, const uint8_t *body) {
+  // Valid frame at the current rate keeps (or confirms) it
+  baud_confirmed = 1;
+  baud_last_valid_tick = HAL_GetTick();
+  u_rx_frames++;
+
+  // The queue holds every RX block, so pool and queue fill up together
+  Pool_Block_t *blk = Pool_Alloc(1);
+  if (blk == NULL) {
+    j_busy++;
+    Proto_Send_Nak(huart, body[0], body[1], body[2], FCS_NAK_BUSY);
+    return;
+  }
+  memcpy(&blk->data[BLK_BODY_OFS], body, 5 + body[3]);
+  blk->stamp = DWT->CYCCNT;
+  j_count++;
+#if FCS_USE_RTOS
+  FCS_Rtos_Post_Job(blk); // Never full: the pool runs out first
+#else
+  j_queue[j_head] = blk;
+  j_head = (j_head + 1) % FCS_JOB_QUEUE_LEN;
+#endif
+}
+
+// One job: decrypt in place and run it; its block is freed after the reply.
+// p_cmd..p_payload belong to whoever runs jobs (the MISSION task in the RTOS build).
+static void Proto_Run_Job(FCS_System_t *sys, UART_HandleTypeDef *huart, Pool_Block_t *blk) {
+  LINK_LOCK();
+  uint32_t delay = DWT->CYCCNT - blk->stamp;
+  if (delay > j_delay_max_cyc) j_delay_max_cyc = delay;
+  j_delay_sum_cyc += delay;
+  j_done++;
+
+  p_cmd = blk->data[1];
+  p_seq = blk->data[2];
+  p_salt = blk->data[3];
+  p_len = blk->data[4];
+  p_payload = &blk->data[BLK_PAYLOAD_OFS];
+
+  // Decrypt Payload (AEAD: authenticate first, forged or replayed frames never run)
+  int authentic = Proto_Unseal();
+  if (!authentic) a_auth_fail++;
+  LINK_UNLOCK();
+
+  if (authentic) {
+    p_payload[p_len] = 0; // Null Terminate (text target, over the checked CRC or tag)
+
+    // Process Command & Reply (Via the connected UART)
+    Proto_Dispatch(sys, huart);
+  } else {
+    Proto_Send_Nak(huart, p_cmd, p_seq, p_salt, FCS_NAK_AUTH);
+  }
+
+  LINK_LOCK();
+  Pool_Free(blk);
+  j_count--;
+  LINK_UNLOCK();
+}
+
+#if FCS_PROTO_COBS
+// One delimited span: decode, check, accept. Bad spans are simply dropped.
+static void Proto_Cobs_Frame(UART_HandleTypeDef *huart, uint8_t *span, uint8_t n) {
+  int len = FCS_Codec_Unframe(span, n, FCS_PROTO_FLAGS);
+  if (len == FCS_CODEC_ERR_FRAME) {
+    u_frame_errors++;
+    return;
+  }
+
+  if (len == FCS_CODEC_ERR_CRC) {
+    u_crc_errors++;
+    Proto_Send_Nak(huart, span[0], span[1], span[2], FCS_NAK_CRC);
+    return;
+  }
+  Proto_Accept(huart, span);
+}
+
+// Frames are taken straight out of the ring: a span that does not wrap is
+// decoded where it lies, only a wrapped one is first joined in p_raw.
+// Ring bytes are released once the body is queued, so the ISR never touches the span.
+static void Proto_Poll(UART_HandleTypeDef *huart) {
+  static uint8_t last_head = 0;
+  uint8_t head = u_head;
+  if (head != last_head) {
+    last_head = head;
+    p_last_rx_tick = HAL_GetTick();
+  }
+
+  while (u_tail != head && !Proto_Rx_Held()) {
+    uint8_t i = u_tail;
+    uint8_t n = 0;
+    while (i != head && u_buf[i] != 0x00) {
+      i = (i + 1) % RING_SIZE;
+      n++;
+    }
+
+    // Longer than any frame: never copied or decoded. The ring can hold such a
+    // span whole (it fills while RX is held or during a long LCD push).
+    uint8_t oversized = (n > FCS_PROTO_OVERHEAD - 1 + PROTO_MAX_PAYLOAD);
+    if (i == head) {
+      // No delimiter yet: wait, unless it is already too long or stalled
+      if (oversized || HAL_GetTick() - p_last_rx_tick > PARSER_TIMEOUT_MS) {
+        if (oversized) u_frame_errors++;
+        u_tail = head;
+      }
+      return;
+    }
+
+    if (oversized) {
+      u_frame_errors++;
+    } else if (n > 0) {
+      uint8_t *span;
+      if (u_tail + n <= RING_SIZE) {
+        span = &u_buf[u_tail];
+      } else {
+        uint8_t first = RING_SIZE - u_tail;
+        memcpy(p_raw, &u_buf[u_tail], first);
+        memcpy(&p_raw[first], u_buf, n - first);
+        span = p_raw;
+      }
+      Proto_Cobs_Frame(huart, span, n);
+    }
+    u_tail = (i + 1) % RING_SIZE;
+  }
+}
+#else
+// Drop 'n' bytes from the front of the candidate buffer
+static void Proto_Consume(uint8_t n) {
+  p_raw_len -= n;
+  memmove(p_raw, &p_raw[n], p_raw_len);
+}
+
+// Candidate rejected: restart at the next STX inside it (or empty the buffer)
+static void Proto_Resync(void) {
+  uint8_t i = 1;
+  while (i < p_raw_len && p_raw[i] != FCS_PROTO_STX) i++;
+  Proto_Consume(i);
+}
+
+// Run every complete candidate in p_raw; stops when the front one needs more bytes
+static void Proto_Process(UART_HandleTypeDef *huart) {
+  while (p_raw_len > RAW_LEN_OFS) {
+    uint8_t len = p_raw[RAW_LEN_OFS];
+    if (len > PROTO_MAX_PAYLOAD) { // Safety Limit
+      u_frame_errors++;
+      Proto_Resync();
+      continue;
+    }
+
+    uint8_t total = FCS_PROTO_OVERHEAD + len;
+    if (p_raw_len < total) return;
+
+    if (p_raw[total - 1] != FCS_PROTO_ETX) {
+      u_frame_errors++;
+      Proto_Resync();
+      continue;
+    }
+
+    // CRC covers: CMD + SEQ + SALT + LEN + PAYLOAD
+    if (FCS_Codec_Crc8(&p_raw[1], RAW_PAYLOAD_OFS - 1 + len) != p_raw[total - 2]) {
+      // CRC Error Response
+      u_crc_errors++;
+      Proto_Send_Nak(huart, p_raw[1], p_raw[2], p_raw[3], FCS_NAK_CRC);
+      Proto_Resync();
+      continue;
+    }
+
+    Proto_Accept(huart, &p_raw[1]);
+    Proto_Consume(total);
+  }
+}
+
+// Everything in the ring goes through the candidate buffer
+static void Proto_Poll(UART_HandleTypeDef *huart) {
+  while (u_head != u_tail && !Proto_Rx_Held()) {
     // Dequeue byte
     uint8_t rx = u_buf[u_tail];
     u_tail = (u_tail + 1) % RING_SIZE;
     p_last_rx_tick = HAL_GetTick();
-        
-    // Protocol State Machine
-    switch (p_state) {
-      case P_IDLE:
-        if (rx == FCS_PROTO_STX) {
-          p_state = P_CMD;
-        }
-        break;
-                
-      case P_CMD:
-        p_cmd = rx;
-        p_state = P_SALT;
-        break;
-                
-      case P_SALT:
-        p_salt = rx;
-        p_state = P_LEN;
-        break;
-                
-      case P_LEN:
-        p_len = rx;
-        p_idx = 0;
-        if (p_len > PROTO_MAX_PAYLOAD) p_state = P_IDLE; // Safety Limit
-        else if (p_len == 0) p_state = P_CRC; // Empty Payload
-        else p_state = P_PAYLOAD;
-        break;
-                
-      case P_PAYLOAD:
-        p_payload[p_idx++] = rx;
-        if (p_idx >= p_len) p_state = P_CRC;
-        break;
-                
-      case P_CRC:
-        p_crc_recv = rx;
-        p_state = P_ETX;
-        break;
-                
-      case P_ETX:
-        if (rx == FCS_PROTO_ETX) {
-          // 1. Verify CRC
-          // CRC covers: CMD + SALT + LEN + PAYLOAD
-          uint8_t header[3] = {p_cmd, p_salt, p_len};
-          uint8_t cal_crc = Calc_CRC8(header, 3, 0);
-          cal_crc = Calc_CRC8(p_payload, p_len, cal_crc);
-                    
-          char tx_buf[FCS_TX_BUF_SIZE];
-                    
-          if (cal_crc == p_crc_recv) {
-            // 2. Decrypt Payload
-            uint8_t session_key = FCS_PROTO_KEY ^ p_salt;
-            for(int i=0; i<p_len; i++) {
-              p_payload[i] ^= (uint8_t)(session_key + i);
-            }
-            p_payload[p_len] = 0; // Null Terminate
-                        
-            // 3. Process Command
-            char resp[FCS_RESP_BUF_SIZE];
-            if (p_cmd == FCS_CMD_TARGET_INPUT) {
-              FCS_Process_Command(sys, (char*)p_payload, resp);
-            } 
-            else if (p_cmd == FCS_CMD_STATUS_REQ) {
-              snprintf(resp, FCS_RESP_BUF_SIZE, "STATUS:READY,Z%d", sys->user_pos.zone);
-            }
-                        
-            // 4. Send Response (Via the connected UART)
-            snprintf(tx_buf, sizeof(tx_buf), "\r\n[ACK] %s\r\n", resp);
-            HAL_UART_Transmit(huart, (uint8_t*)tx_buf, strlen(tx_buf), UART_TX_TIMEOUT_MS);
-                        
-          } else {
-            // CRC Error Response
-            snprintf(tx_buf, sizeof(tx_buf), "\r\n[ERR] CRC Fail\r\n");
-            HAL_UART_Transmit(huart, (uint8_t*)tx_buf, strlen(tx_buf), UART_TX_TIMEOUT_MS);
-          }
-        }
-        p_state = P_IDLE;
-        break;
-      }
+
+    // Bytes outside a candidate are noise until the next STX
+    if (p_raw_len == 0 && rx != FCS_PROTO_STX) continue;
+
+    p_raw[p_raw_len++] = rx; // Never full: Proto_Process leaves at most total - 1
+    Proto_Process(huart);
+  }
+}
+#endif
+
+// Parser probe: only runs that have bytes to take
+static void Proto_Poll_Timed(UART_HandleTypeDef *huart) {
+  if (u_tail == u_head) return;
+  PROBE_BEGIN(PROBE_PARSE);
+  Proto_Poll(huart);
+  PROBE_END(PROBE_PARSE);
+}
+
+// Timed link work: flow bytes, parser stall, baud fallback
+static void Serial_Housekeeping(UART_HandleTypeDef *huart) {
+#if FCS_FLOW_CTRL == FCS_FLOW_XONXOFF
+  Serial_Flow_Flush();
+#endif
+#if !FCS_PROTO_COBS
+  // Candidate stalled > 500ms: it will never complete, rescan what it holds
+  if (p_raw_len > 0 && (HAL_GetTick() - p_last_rx_tick > PARSER_TIMEOUT_MS)) {
+    Proto_Resync();
+    Proto_Process(huart);
+    p_last_rx_tick = HAL_GetTick();
+  }
+#endif
+
+  // Raised baud without a valid frame in time -> fall back to default
+  if (baud_current != FCS_BAUD_DEFAULT) {
+    uint32_t limit = baud_confirmed ? FCS_BAUD_IDLE_TIMEOUT_MS : FCS_BAUD_PROBATION_MS;
+    if (HAL_GetTick() - baud_last_valid_tick > limit) {
+      Serial_Apply_Baud(huart, FCS_BAUD_DEFAULT);
+      p_raw_len = 0;
     }
+  }
+}
+
+// [3] Serial/Comm Task (Frame Parser)
+void FCS_Task_Serial(FCS_System_t *sys, UART_HandleTypeDef *huart) {
+  Serial_Housekeeping(huart);
+
+  // Parse everything received, then run queued jobs until their handlers
+  // use up the budget. The blocking reply is left out (at 9600 baud it alone
+  // would use it up after one job), so a pass runs one queue's worth at most.
+  Proto_Poll_Timed(huart);
+#if !FCS_USE_RTOS
+  uint32_t budget = FCS_JOB_BUDGET_US * (SystemCoreClock / 1000000U);
+  j_pass_cyc = 0;
+  for (uint8_t run = 0; run < FCS_JOB_QUEUE_LEN && j_count > 0; run++) {
+    Proto_Run_Job(sys, huart, j_queue[j_tail]);
+    j_tail = (j_tail + 1) % FCS_JOB_QUEUE_LEN;
+    Proto_Poll_Timed(huart); // Frames that arrived during the job
+    if (j_pass_cyc >= budget) break;
+  }
+#endif
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+  Serial_Flow_Resume();
+#endif
+
+  // Telemetry goes out after replies so it never delays one
+  Telem_Service(sys, huart);
+}
+
+#if FCS_USE_RTOS
+// LINK task: the serial task without the jobs, which MISSION runs preemptibly
+uint32_t FCS_Link_Poll(FCS_System_t *sys, UART_HandleTypeDef *huart) {
+  LINK_LOCK();
+  FCS_Task_Serial(sys, huart);
+  uint32_t ms = FCS_Serial_Timed() ? FCS_TASK_SERIAL_MS : 0;
+  LINK_UNLOCK();
+  return ms;
+}
+
+// MISSION task. The freed block may release a ring held by flow control.
+void FCS_Link_Job(FCS_System_t *sys, UART_HandleTypeDef *huart, void *job) {
+  Proto_Run_Job(sys, huart, job);
+  FCS_Rtos_Link_Wake();
+}
+#endif
+
+// Work the last FCS_Task_Serial left for the next run: queued jobs past the
+// budget, or received bytes not yet parsed (ring held by flow control)
+int FCS_Serial_Busy(void) {
+  return j_count > 0 || (u_tail != u_head && !Proto_Rx_Held());
+}
+
+// Work FCS_Task_Serial does on the clock rather than on a received byte.
+// Without any, the task only needs to run when RX signals it.
+int FCS_Serial_Timed(void) {
+#if !FCS_PROTO_COBS
+  if (p_raw_len > 0) return 1; // Parser timeout
+#endif
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+  if (u_flow_paused) return 1;
+#endif
+#if FCS_FLOW_CTRL == FCS_FLOW_XONXOFF
+  if (u_flow_pending) return 1;
+#endif
+  return baud_current != FCS_BAUD_DEFAULT || t_period_ms != 0;
 }
 
 
 // [4] 명령어 처리기 (Logic Core)
-// Now accepts raw payload string: "52,S,333712,4132894,100" (from 0xA1)
+
+// Fire data -> compact wire result (0.1 mil fixed point)
+static void FCS_Fill_Result(const FireData_t *fire, FCS_BatchResult_t *res) {
+  res->error = (uint8_t)fire->error;
+  res->charge = (uint8_t)fire->charge;
+  if (fire->error == FCS_FIRE_OK) {
+    res->az_dmil = (uint16_t)(fire->azimuth * 10.0f + 0.5f);
+    res->el_dmil = (int16_t)(fire->elevation * 10.0f + (fire->elevation < 0 ? -0.5f : 0.5f));
+  } else {
+    res->az_dmil = 0;
+    res->el_dmil = 0;
+  }
+}
+
+// Boot-to-first-mission time (STATUS)
+static void FCS_Mark_First_Fire(FCS_System_t *sys) {
+  if (sys->diag.first_fire_ms != 0) return;
+  uint32_t now = HAL_GetTick(); // ms since HAL_Init, i.e. since reset
+  sys->diag.first_fire_ms = Sat16(now > 0 ? now : 1);
+}
+
+// Common Fire Mission Path: set target, solve, fill binary result
+static int FCS_Fire_Mission(FCS_System_t *sys, int z, char b, double e, double n, float a, FCS_FireResult_t *res) {
+  // Update System
+  FCS_Set_Target(sys, z, b, e, n, a);
+
+  // Calculate Ballistics Immediately (cost in the SLV probe)
+  PROBE_BEGIN(PROBE_SOLVE);
+  FCS_Calculate_FireData(sys);
+  PROBE_END(PROBE_SOLVE);
+
+  // Generate Response (Validation Output)
+  FCS_Fill_Result(&sys->fire, &res->sol);
+  res->tof_ds = (uint16_t)(sys->fire.time_of_flight * 10.0f + 0.5f);
+  FCS_Mark_First_Fire(sys);
+
+  // Update UI State Context
+  sys->state = UI_FIRE_DATA;
+
+  return 1; // Success
+}
+
+// "%d,%c,%ld,%ld,%d" as sscanf read it. Returns: fields read before the first mismatch
+static int FCS_Parse_Target(const char *s, int32_t *z, char *b, int32_t *e, int32_t *n, int32_t *a) {
+  if (!(s = FCS_Parse_Int(s, z))) return 0;
+  if (*s++ != ',' || *s == '\0') return 1;
+  *b = *s++;
+  if (*s++ != ',' || !(s = FCS_Parse_Int(s, e))) return 2;
+  if (*s++ != ',' || !(s = FCS_Parse_Int(s, n))) return 3;
+  if (*s++ != ',' || !FCS_Parse_Int(s, a)) return 4;
+  return 5;
+}
+
+// Text Target (0xA1): "52,S,333712,4132894,100"
 // Or "TGT:..." (legacy, removed in theory but kept logic structure)
-int FCS_Process_Command(FCS_System_t *sys, char *cmd, char *resp) {
-  
-  // 1. Target Input Command Logics
-  // Check if it's legacy "TGT:" or raw params?
-  // Since this is internal call now, we assume it gets the parameter string directly.
-  
-  int z;
+int FCS_Process_Command(FCS_System_t *sys, char *cmd, FCS_FireResult_t *res) {
+  int32_t z, e_int, n_int, a_int;
   char b;
-  long e_int, n_int;
-  int a_int;
     
   // Try Parsing: "52,S,333712,4132894,105"
-  int count = sscanf(cmd, "%d,%c,%ld,%ld,%d", &z, &b, &e_int, &n_int, &a_int);
+  int count = FCS_Parse_Target(cmd, &z, &b, &e_int, &n_int, &a_int);
     
   // If failed, maybe it still has "TGT:" prefix (Testing)?
   if (count != 5) {
-    count = sscanf(cmd, "TGT:%d,%c,%ld,%ld,%d", &z, &b, &e_int, &n_int, &a_int);
+    count = (strncmp(cmd, "TGT:", 4) == 0) ? FCS_Parse_Target(cmd + 4, &z, &b, &e_int, &n_int, &a_int) : 0;
   }
     
   if (count == 5) {
-    double e = (double)e_int;
-    double n = (double)n_int;
-    float a = (float)a_int;
-      
-    // Update System
-    FCS_Set_Target(sys, z, b, e, n, a);
-      
-    // Calculate Ballistics Immediately (with DWT profiling)
-    DWT->CYCCNT = 0;
-    FCS_Calculate_FireData(sys);
-    uint32_t calc_cycles = DWT->CYCCNT;
-    uint32_t calc_us = calc_cycles / 84; // 84MHz -> 1us per 84 cycles
-    DBG_PRINT("[PERF] Ballistic calc: %lu cycles (%lu us)\r\n",
-              (unsigned long)calc_cycles, (unsigned long)calc_us);
-      
-    // Generate Response (Validation Output)
-    int az_i = (int)sys->fire.azimuth;
-    int az_d = (int)((sys->fire.azimuth - az_i) * 10); if(az_d<0) az_d = -az_d;
-      
-    int el_i = (int)sys->fire.elevation;
-    int el_d = (int)((sys->fire.elevation - el_i) * 10); if(el_d<0) el_d = -el_d;
-      
-    snprintf(resp, FCS_RESP_BUF_SIZE, "AZ:%d.%d EL:%d.%d", az_i, az_d, el_i, el_d);
-      
-    // Update UI State Context
-    sys->state = UI_FIRE_DATA; 
-      
-    return 1; // Success
+    return FCS_Fire_Mission(sys, (int)z, b, (double)e_int, (double)n_int, (float)a_int, res);
   } else {
-    snprintf(resp, FCS_RESP_BUF_SIZE, "ERR:Parse(%d)", count);
+    DBG_PRINT("[CMD] Parse error (%d fields)\r\n", count);
     return -1;
   }
 }
+
+// Binary Target (0xA2): fixed 12-byte FCS_TargetRecord_t, no text parsing
+int FCS_Process_TargetRecord(FCS_System_t *sys, const uint8_t *payload, uint8_t len, FCS_FireResult_t *res) {
+  if (len != FCS_TARGET_RECORD_SIZE) return -1;
+
+  FCS_TargetRecord_t rec;
+  memcpy(&rec, payload, sizeof(rec)); // Unaligned-safe copy (LE on wire == LE in core)
+
+  return FCS_Fire_Mission(sys, rec.zone, (char)rec.band,
+                          rec.easting_cm * 0.01, rec.northing_cm * 0.01,
+                          rec.alt_dm * 0.1f, res);
+}
+
+// Varint -> zigzag-decoded delta. Advances *pos; 0 if truncated or over 5 bytes.
+static int FCS_Get_Delta(const uint8_t *p, uint8_t len, uint8_t *pos, int32_t *out) {
+  uint32_t v = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (*pos >= len) return 0;
+    uint8_t b = p[(*pos)++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) {
+      *out = (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Delta Target (0xA4): [base][dE][dN][dAlt] relative to a reference position
+int FCS_Process_TargetDelta(FCS_System_t *sys, const UTM_Coord_t *last, const uint8_t *payload, uint8_t len, FCS_FireResult_t *res) {
+  const UTM_Coord_t *base;
+  uint8_t ref = payload[0];
+  if (ref == FCS_DELTA_BASE_LAST) base = last;
+  else if (ref == FCS_DELTA_BASE_BATTERY) base = &sys->user_pos;
+  else if (ref - FCS_DELTA_BASE_POINT < FCS_KNOWN_POINTS) base = &sys->known[ref - FCS_DELTA_BASE_POINT];
+  else return -FCS_NAK_PARAM;
+  if (base->zone == 0) return -FCS_NAK_PARAM; // Nothing stored there yet
+
+  int32_t de, dn, da;
+  uint8_t pos = 1;
+  if (!FCS_Get_Delta(payload, len, &pos, &de) || !FCS_Get_Delta(payload, len, &pos, &dn) ||
+      !FCS_Get_Delta(payload, len, &pos, &da) || pos != len) {
+    return -FCS_NAK_LEN;
+  }
+
+  return FCS_Fire_Mission(sys, base->zone, base->band, base->easting + de, base->northing + dn,
+                          base->altitude + (float)da, res);
+}
+
+// Known Point (0xA5): [id][FCS_TargetRecord_t], kept until reset
+int FCS_Process_KnownPoint(FCS_System_t *sys, const uint8_t *payload, uint8_t len) {
+  if (len != 1 + FCS_TARGET_RECORD_SIZE) return -FCS_NAK_LEN;
+  uint8_t id = payload[0];
+  if (id >= FCS_KNOWN_POINTS) return -FCS_NAK_PARAM;
+
+  FCS_TargetRecord_t rec;
+  memcpy(&rec, &payload[1], sizeof(rec));
+  if (rec.zone == 0) return -FCS_NAK_PARAM;
+
+  UTM_Coord_t *kp = &sys->known[id];
+  kp->zone = rec.zone;
+  kp->band = (char)rec.band;
+  kp->easting = rec.easting_cm * 0.01;
+  kp->northing = rec.northing_cm * 0.01;
+  kp->altitude = rec.alt_dm * 0.1f;
+  return id;
+}
+
+// Batch Target (0xA3): [first_idx][count][count x record] -> [first_idx][count][count x result]
+// Returns reply payload length, or -1 on a malformed frame.
+int FCS_Process_TargetBatch(FCS_System_t *sys, const uint8_t *payload, uint8_t len, uint8_t *out) {
+  if (len < FCS_BATCH_HDR_SIZE) return -1;
+
+  uint8_t first_idx = payload[0];
+  uint8_t count = payload[1];
+  if (count == 0 || count > FCS_BATCH_MAX ||
+      len != FCS_BATCH_HDR_SIZE + count * FCS_TARGET_RECORD_SIZE) {
+    return -1;
+  }
+
+  out[0] = first_idx;
+  out[1] = count;
+
+  for (int i = 0; i < count; i++) {
+    FCS_TargetRecord_t rec;
+    FCS_BatchResult_t res;
+    memcpy(&rec, &payload[FCS_BATCH_HDR_SIZE + i * FCS_TARGET_RECORD_SIZE], sizeof(rec));
+
+    FCS_Set_Target(sys, rec.zone, (char)rec.band,
+                   rec.easting_cm * 0.01, rec.northing_cm * 0.01, rec.alt_dm * 0.1f);
+    PROBE_BEGIN(PROBE_SOLVE);
+    FCS_Calculate_FireData(sys);
+    PROBE_END(PROBE_SOLVE);
+
+    FCS_Fill_Result(&sys->fire, &res);
+    memcpy(&out[FCS_BATCH_HDR_SIZE + i * FCS_BATCH_RESULT_SIZE], &res, sizeof(res));
+  }
+
+  // Last target of the list stays on screen
+  sys->state = UI_FIRE_DATA;
+  if (count > 0) FCS_Mark_First_Fire(sys);
+
+  return FCS_BATCH_HDR_SIZE + count * FCS_BATCH_RESULT_SIZE;
+}
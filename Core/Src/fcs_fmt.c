@@ -0,0 +1,75 @@
+#include "fcs_fmt.h"
+#include <stddef.h>
+
+#define FMT_DIGITS_MAX  10  // UINT32_MAX
+
+void FCS_Fmt_Init(FCS_Fmt_t *f, char *buf, uint16_t size) {
+  f->p = buf;
+  f->last = buf + size - 1;
+  *f->p = '\0';
+}
+
+void FCS_Fmt_Char(FCS_Fmt_t *f, char c) {
+  if (f->p >= f->last) return;
+  *f->p++ = c;
+  *f->p = '\0';
+}
+
+void FCS_Fmt_Str(FCS_Fmt_t *f, const char *s) {
+  while (*s && f->p < f->last) *f->p++ = *s++;
+  *f->p = '\0';
+}
+
+// Digits of v, least significant first. Returns: count (1..10)
+static uint8_t Fmt_Digits(uint32_t v, char *d) {
+  uint8_t n = 0;
+  do {
+    d[n++] = (char)('0' + v % 10U);
+    v /= 10U;
+  } while (v != 0);
+  return n;
+}
+
+static void Fmt_Number(FCS_Fmt_t *f, uint32_t mag, uint8_t neg, uint8_t width, char pad) {
+  char d[FMT_DIGITS_MAX];
+  uint8_t n = Fmt_Digits(mag, d);
+  uint8_t len = (uint8_t)(n + neg);
+  uint8_t fill = (width > len) ? (uint8_t)(width - len) : 0;
+
+  if (pad != '0') {
+    while (fill--) FCS_Fmt_Char(f, ' ');
+  }
+  if (neg) FCS_Fmt_Char(f, '-');
+  if (pad == '0') {
+    while (fill--) FCS_Fmt_Char(f, '0'); // After the sign, as printf
+  }
+  while (n > 0) FCS_Fmt_Char(f, d[--n]);
+}
+
+void FCS_Fmt_Uint(FCS_Fmt_t *f, uint32_t v, uint8_t width, char pad) {
+  Fmt_Number(f, v, 0, width, pad);
+}
+
+void FCS_Fmt_Int(FCS_Fmt_t *f, int32_t v, uint8_t width, char pad) {
+  uint32_t mag = (v < 0) ? 0U - (uint32_t)v : (uint32_t)v; // INT32_MIN safe
+  Fmt_Number(f, mag, v < 0, width, pad);
+}
+
+const char *FCS_Parse_Int(const char *s, int32_t *out) {
+  while (*s == ' ' || (*s >= '\t' && *s <= '\r')) s++;
+  uint8_t neg = 0;
+  if (*s == '-' || *s == '+') neg = (*s++ == '-');
+
+  uint32_t v = 0;
+  uint8_t n = 0;
+  while (*s >= '0' && *s <= '9') {
+    if (++n > FMT_DIGITS_MAX) return NULL;
+    uint32_t digit = (uint32_t)(*s++ - '0');
+    if (v > (UINT32_MAX - digit) / 10U) return NULL;
+    v = v * 10U + digit;
+  }
+  if (n == 0) return NULL;
+  if (v > (neg ? 0x80000000U : 0x7FFFFFFFU)) return NULL;
+  *out = neg ? (int32_t)(0U - v) : (int32_t)v;
+  return s;
+}
@@ -0,0 +1,74 @@
+#include "fcs_log.h"
+#include "main.h"
+
+extern UART_HandleTypeDef huart2;
+
+// Free-running indices; the ring slot is (index & mask)
+#define LOG_MASK (FCS_LOG_RING_SIZE - 1)
+
+static uint8_t log_ring[FCS_LOG_RING_SIZE];
+static volatile uint16_t log_head = 0;    // Written by FCS_Log_Put
+static volatile uint16_t log_tail = 0;    // Advanced on DMA completion
+static volatile uint16_t log_sending = 0; // Bytes in the DMA transfer, 0 = idle
+static uint32_t log_dropped = 0;
+
+static uint16_t Log_Write(uint16_t head, uint16_t id, const uint32_t *args, uint8_t n) {
+  log_ring[head++ & LOG_MASK] = FCS_LOG_SYNC;
+  log_ring[head++ & LOG_MASK] = (uint8_t)id;
+  log_ring[head++ & LOG_MASK] = (uint8_t)(id >> 8);
+  log_ring[head++ & LOG_MASK] = n;
+  for (uint8_t i = 0; i < n; i++) {
+    uint32_t v = args[i];
+    log_ring[head++ & LOG_MASK] = (uint8_t)v;
+    log_ring[head++ & LOG_MASK] = (uint8_t)(v >> 8);
+    log_ring[head++ & LOG_MASK] = (uint8_t)(v >> 16);
+    log_ring[head++ & LOG_MASK] = (uint8_t)(v >> 24);
+  }
+  return head;
+}
+
+void FCS_Log_Put(uint16_t id, const uint32_t *args, uint8_t n) {
+  uint16_t len = (uint16_t)(4U + 4U * n);
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint16_t head = log_head;
+  uint16_t room = (uint16_t)(FCS_LOG_RING_SIZE - (uint16_t)(head - log_tail));
+  if (log_dropped > 0) {
+    if (room < len + 8U) {
+      log_dropped++;
+      __set_PRIMASK(primask);
+      return;
+    }
+    head = Log_Write(head, FCS_LOG_ID_DROPPED, &log_dropped, 1);
+    log_dropped = 0;
+  } else if (room < len) {
+    log_dropped = 1;
+    __set_PRIMASK(primask);
+    return;
+  }
+  log_head = Log_Write(head, id, args, n);
+  __set_PRIMASK(primask);
+}
+
+void FCS_Log_Kick(void) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint16_t tail = log_tail;
+  uint16_t pending = (uint16_t)(log_head - tail);
+  if (log_sending || pending == 0) {
+    __set_PRIMASK(primask);
+    return;
+  }
+  // One contiguous run; the rest follows from the completion IRQ
+  uint16_t run = (uint16_t)(FCS_LOG_RING_SIZE - (tail & LOG_MASK));
+  if (run > pending) run = pending;
+  log_sending = run;
+  __set_PRIMASK(primask);
+  if (HAL_UART_Transmit_DMA(&huart2, &log_ring[tail & LOG_MASK], run) != HAL_OK) log_sending = 0;
+}
+
+void FCS_Log_Tx_Done(void) {
+  log_tail = (uint16_t)(log_tail + log_sending);
+  log_sending = 0;
+  FCS_Log_Kick();
+}
@@ -423,6 +423,7 @@ void FCS_Calculate_FireData(FCS_System_t *sys) {
     
   // --- Step 5: Final Data Assembly ---
   sys->fire.distance_km = (float)(map_dist_m / 1000.0); // Display Map Range or Corrected? Usually Map is useful reference.
+  sys->fire.time_of_flight = (float)tof;
   sys->fire.elevation = base_elev + site_corr;
     
   // [Adjustment Applied Here] 
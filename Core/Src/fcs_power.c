@@ -0,0 +1,100 @@
+#include "fcs_power.h"
+
+static uint32_t pw_win_start = 0;  // FCS_Power_Now_Us at window start
+static uint32_t pw_slept_us = 0;
+static uint32_t pw_wakes = 0;
+
+// [1] Time base (1 kHz HAL tick)
+uint32_t FCS_Power_Now_Us(void) {
+  uint32_t ms, val, pend;
+  do {
+    ms = uwTick;
+    val = SysTick->VAL;
+    pend = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+  } while (ms != uwTick);
+  uint32_t per_tick = SysTick->LOAD + 1;
+  // Wrapped, but HAL_IncTick has not run yet (IRQs masked): count that tick
+  if (pend && val > per_tick / 2) ms++;
+  return ms * 1000U + (per_tick - 1 - val) * 1000U / per_tick;
+}
+
+// [2] Sleep
+#if FCS_TICKLESS
+// Stops the SysTick and reloads it to fire on the first tick boundary at or
+// after now + idle_us (a release starts up to one tick late rather than
+// costing a second wake). On wake, HAL's tick is credited with the whole
+// ticks that passed and the partial one is finished. Stop/restart loses a
+// few cycles per sleep, far below the HSI tolerance.
+// Returns 0 if the sleep is within the current tick: the tick is the wake.
+static int Power_Sleep_Tickless(uint32_t idle_us) {
+  uint32_t per_tick = SysTick->LOAD + 1;
+  uint32_t max_ms = SysTick_LOAD_RELOAD_Msk / per_tick; // 199 ms at 84 MHz
+  if (idle_us > max_ms * 1000U) idle_us = max_ms * 1000U;
+
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  uint32_t val = SysTick->VAL; // Rest of the current tick
+  uint32_t to_end = (per_tick - val) + idle_us * (per_tick / 1000U);
+  uint32_t ticks = (to_end + per_tick - 1) / per_tick;
+  if (ticks < FCS_TICKLESS_MIN_MS || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    return 0;
+  }
+  uint32_t span = val + (ticks - 1) * per_tick;
+  SysTick->LOAD = span - 1;
+  SysTick->VAL = 0;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+  HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  uint32_t now_val = SysTick->VAL;
+  int expired = (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0;
+  // Expired: the counter reloaded the span and kept counting until we stopped it
+  uint32_t elapsed = expired ? span + (span - 1 - now_val) : span - now_val;
+  uint32_t total = (per_tick - val) + elapsed; // Since the start of the tick we slept in
+  uint32_t done = total / per_tick;
+  uint32_t left = per_tick - total % per_tick;
+  if (left < 2) {
+    done++; // A one-cycle reload would stop the counter
+    left = per_tick;
+  }
+  if (expired) done--; // The pending handler counts that one
+  uwTick += done;
+
+  // Finish the partial tick, then normal ticks (LOAD takes effect at the next reload)
+  SysTick->LOAD = left - 1;
+  SysTick->VAL = 0;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+  SysTick->LOAD = per_tick - 1;
+  return 1;
+}
+#endif
+
+void FCS_Power_Sleep(uint32_t idle_us) {
+  uint32_t t0 = FCS_Power_Now_Us();
+#if FCS_TICKLESS
+  if (!Power_Sleep_Tickless(idle_us)) {
+    HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+  }
+#else
+  (void)idle_us;
+  HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+#endif
+  pw_slept_us += FCS_Power_Now_Us() - t0;
+  pw_wakes++;
+}
+
+// [3] Statistics
+int FCS_Power_Window(uint16_t *sleep_pm, uint16_t *wake_dhz) {
+  uint32_t now = FCS_Power_Now_Us();
+  uint32_t span = now - pw_win_start;
+  if (span < FCS_POWER_WINDOW_MS * 1000U) return 0;
+
+  *sleep_pm = (uint16_t)((uint64_t)pw_slept_us * 1000U / span);
+  uint64_t dhz = (uint64_t)pw_wakes * 10000000U / span;
+  *wake_dhz = (dhz > 0xFFFF) ? 0xFFFF : (uint16_t)dhz;
+  pw_win_start = now;
+  pw_slept_us = 0;
+  pw_wakes = 0;
+  return 1;
+}
@@ -0,0 +1,59 @@
+#include "fcs_probe.h"
+#include <string.h>
+#ifdef FCS_PROBE_HOST
+#include <time.h>
+#endif
+
+typedef struct {
+  uint32_t count;
+  uint32_t min_cyc;
+  uint32_t max_cyc;
+  uint64_t sum_cyc;
+  uint16_t hist[FCS_PROBE_BINS];
+} Probe_t;
+
+static Probe_t probes[PROBE_COUNT];
+static const char probe_names[PROBE_COUNT][4] = {
+  [PROBE_SOLVE] = "SLV", [PROBE_PARSE] = "PRS", [PROBE_UI] = "UI",
+  [PROBE_LCD] = "LCD", [PROBE_SENSOR] = "BMP",
+};
+
+#ifdef FCS_PROBE_HOST
+uint32_t FCS_Probe_Now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  uint64_t ns = (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+  return (uint32_t)(ns * (FCS_PROBE_HOST_HZ / 1000000U) / 1000U); // Wraps like CYCCNT
+}
+#endif
+
+static uint8_t Probe_Bin(uint32_t cyc) {
+  if (cyc < (1UL << (FCS_PROBE_BIN_SHIFT + 1))) return 0;
+  uint8_t log2 = (uint8_t)(31 - __builtin_clz(cyc)); // CLZ on the M4
+  uint8_t bin = (uint8_t)(log2 - FCS_PROBE_BIN_SHIFT);
+  return bin < FCS_PROBE_BINS ? bin : FCS_PROBE_BINS - 1;
+}
+
+void FCS_Probe_Record(FCS_ProbeId_t id, uint32_t cyc) {
+  Probe_t *p = &probes[id];
+  if (p->count == 0 || cyc < p->min_cyc) p->min_cyc = cyc;
+  if (cyc > p->max_cyc) p->max_cyc = cyc;
+  p->sum_cyc += cyc;
+  p->count++;
+  uint16_t *h = &p->hist[Probe_Bin(cyc)];
+  if (*h != UINT16_MAX) (*h)++;
+}
+
+void FCS_Probe_Stat(uint8_t idx, FCS_ProbeStat_t *out) {
+  const Probe_t *p = &probes[idx];
+  memcpy(out->name, probe_names[idx], sizeof(out->name));
+  out->count = p->count;
+  out->min_cyc = p->min_cyc;
+  out->mean_cyc = p->count ? (uint32_t)(p->sum_cyc / p->count) : 0;
+  out->max_cyc = p->max_cyc;
+  memcpy(out->hist, p->hist, sizeof(out->hist));
+}
+
+void FCS_Probe_Reset(void) {
+  memset(probes, 0, sizeof(probes));
+}
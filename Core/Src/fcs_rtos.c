@@ -0,0 +1,141 @@
+#include "fcs_rtos.h"
+
+#if FCS_USE_RTOS
+#include "cmsis_os2.h"
+#include "fcs_sched.h" // Task rates
+#include "fcs_boot.h"  // Boot poll rate
+#include <stddef.h>
+
+#define FLAG_WAKE  0x01U
+
+static osThreadId_t r_link, r_mission, r_keys, r_sensor, r_display;
+static osMessageQueueId_t r_jobs;
+static osMutexId_t r_state_lock, r_link_lock, r_bus_lock;
+
+static const osMutexAttr_t r_state_lock_attr = { .name = "state", .attr_bits = osMutexRecursive | osMutexPrioInherit };
+static const osMutexAttr_t r_link_lock_attr = { .name = "link", .attr_bits = osMutexRecursive | osMutexPrioInherit };
+static const osMutexAttr_t r_bus_lock_attr = { .name = "i2c", .attr_bits = osMutexRecursive | osMutexPrioInherit };
+
+static const osThreadAttr_t r_link_attr = {
+  .name = "LINK", .stack_size = FCS_RTOS_STACK_LINK, .priority = osPriorityHigh };
+static const osThreadAttr_t r_mission_attr = {
+  .name = "MISSION", .stack_size = FCS_RTOS_STACK_MISSION, .priority = osPriorityAboveNormal };
+static const osThreadAttr_t r_keys_attr = {
+  .name = "KEYS", .stack_size = FCS_RTOS_STACK_KEYS, .priority = osPriorityNormal };
+static const osThreadAttr_t r_sensor_attr = {
+  .name = "SENSOR", .stack_size = FCS_RTOS_STACK_SENSOR, .priority = osPriorityBelowNormal };
+static const osThreadAttr_t r_display_attr = {
+  .name = "DISPLAY", .stack_size = FCS_RTOS_STACK_DISPLAY, .priority = osPriorityLow };
+
+static uint32_t Rtos_Ticks(uint32_t ms) {
+  return ms * osKernelGetTickFreq() / 1000U;
+}
+
+// [Tasks]
+static void Link_Task(void *arg) {
+  (void)arg;
+  uint32_t wait = 0; // Bytes may have arrived before the kernel started
+  for (;;) {
+    osThreadFlagsWait(FLAG_WAKE, osFlagsWaitAny, wait); // A timeout is a wake too
+    uint32_t ms = FCS_App_Link();
+    wait = ms ? Rtos_Ticks(ms) : osWaitForever;
+  }
+}
+
+static void Mission_Task(void *arg) {
+  (void)arg;
+  void *job;
+  for (;;) {
+    if (osMessageQueueGet(r_jobs, &job, NULL, osWaitForever) == osOK) FCS_App_Mission(job);
+  }
+}
+
+// Fixed-rate loop. Releases missed entirely are dropped, keeping the phase (as fcs_sched)
+static void Rtos_Periodic(uint32_t period_ms, void (*body)(void)) {
+  uint32_t period = Rtos_Ticks(period_ms);
+  uint32_t next = osKernelGetTickCount();
+  for (;;) {
+    body();
+    next += period;
+    uint32_t now = osKernelGetTickCount();
+    if ((int32_t)(now - next) >= 0) next += ((now - next) / period + 1) * period;
+    osDelayUntil(next);
+  }
+}
+
+static void Keys_Task(void *arg) {
+  (void)arg;
+  Rtos_Periodic(FCS_TASK_KEYS_MS, FCS_App_Keys);
+}
+
+static void Sensor_Task(void *arg) {
+  (void)arg;
+  // Owns the I2C devices: brings them up first, while the link already runs
+  while (!FCS_App_Boot()) osDelay(Rtos_Ticks(FCS_BOOT_POLL_MS));
+  Rtos_Periodic(FCS_TASK_SENSOR_MS, FCS_App_Sensor);
+}
+
+static void Display_Task(void *arg) {
+  (void)arg;
+  for (;;) {
+    osThreadFlagsWait(FLAG_WAKE, osFlagsWaitAny, osWaitForever);
+    FCS_App_Display();
+  }
+}
+
+void FCS_Rtos_Start(void) {
+  osKernelInitialize();
+  r_state_lock = osMutexNew(&r_state_lock_attr);
+  r_link_lock = osMutexNew(&r_link_lock_attr);
+  r_bus_lock = osMutexNew(&r_bus_lock_attr);
+  r_jobs = osMessageQueueNew(FCS_RTOS_JOB_DEPTH, sizeof(void *), NULL);
+
+  r_link = osThreadNew(Link_Task, NULL, &r_link_attr);
+  r_mission = osThreadNew(Mission_Task, NULL, &r_mission_attr);
+  r_keys = osThreadNew(Keys_Task, NULL, &r_keys_attr);
+  r_sensor = osThreadNew(Sensor_Task, NULL, &r_sensor_attr);
+  r_display = osThreadNew(Display_Task, NULL, &r_display_attr);
+
+  osKernelStart();
+  for (;;) {
+  }
+}
+
+// [Signals]
+void FCS_Rtos_Link_Wake(void) {
+  if (r_link != NULL) osThreadFlagsSet(r_link, FLAG_WAKE);
+}
+
+int FCS_Rtos_Post_Job(void *job) {
+  return osMessageQueuePut(r_jobs, &job, 0, 0) == osOK;
+}
+
+void FCS_Rtos_Redraw(void) {
+  if (r_display != NULL) osThreadFlagsSet(r_display, FLAG_WAKE);
+}
+
+// [Locks] No-ops until the kernel objects exist (init code runs single-threaded)
+void FCS_Rtos_State_Lock(void) {
+  if (r_state_lock != NULL) osMutexAcquire(r_state_lock, osWaitForever);
+}
+
+void FCS_Rtos_State_Unlock(void) {
+  if (r_state_lock != NULL) osMutexRelease(r_state_lock);
+}
+
+void FCS_Rtos_Link_Lock(void) {
+  if (r_link_lock != NULL) osMutexAcquire(r_link_lock, osWaitForever);
+}
+
+void FCS_Rtos_Link_Unlock(void) {
+  if (r_link_lock != NULL) osMutexRelease(r_link_lock);
+}
+
+void FCS_Rtos_Bus_Lock(void) {
+  if (r_bus_lock != NULL) osMutexAcquire(r_bus_lock, osWaitForever);
+}
+
+void FCS_Rtos_Bus_Unlock(void) {
+  if (r_bus_lock != NULL) osMutexRelease(r_bus_lock);
+}
+#endif
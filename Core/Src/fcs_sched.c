@@ -0,0 +1,170 @@
+#include "fcs_sched.h"
+#include <stddef.h>
+
+static FCS_Task_t *s_tasks = NULL;
+static uint8_t s_count = 0;
+static uint32_t (*s_now)(void) = NULL;
+static FCS_SchedPass_t s_pass = { .max_task = -1 };
+
+// Current deadline window
+static uint32_t w_start = 0;
+static uint32_t w_over_us = 0;  // Time in overrun passes
+
+#define DUE(now, t) ((int32_t)((now) - (t)) >= 0)
+
+void FCS_Sched_Init(FCS_Task_t *tasks, uint8_t count, uint32_t (*now_us)(void)) {
+  if (count > FCS_SCHED_MAX_TASKS) count = FCS_SCHED_MAX_TASKS;
+  s_tasks = tasks;
+  s_count = count;
+  s_now = now_us;
+
+  uint32_t now = s_now();
+  for (uint8_t i = 0; i < s_count; i++) {
+    FCS_Task_t *t = &s_tasks[i];
+    if (t->deadline_us == 0) t->deadline_us = t->period_us;
+    t->next_us = now; // Every periodic task runs once at start
+    t->signalled = 0;
+  }
+  w_start = now;
+  w_over_us = 0;
+  s_pass.missed = 0;
+  s_pass.tripped = 0;
+  FCS_Sched_Reset_Stats();
+}
+
+static int Sched_Ready(const FCS_Task_t *t, uint32_t now) {
+  return t->signalled || (t->period_us != 0 && DUE(now, t->next_us));
+}
+
+// Pass accounting: overruns, worst pass and the deadline windows
+static void Sched_Pass_End(uint32_t start, uint32_t busy, int8_t top) {
+  uint32_t end = s_now();
+  uint32_t len = end - start;
+  if (busy > 0) {
+    s_pass.passes++;
+    if (len > s_pass.max_us) {
+      s_pass.max_us = len;
+      s_pass.max_task = top;
+    }
+    if (len > FCS_SCHED_PASS_BUDGET_US) {
+      s_pass.overruns++;
+      w_over_us += len;
+      if (++s_pass.streak > s_pass.max_streak) s_pass.max_streak = s_pass.streak;
+    } else {
+      s_pass.streak = 0;
+    }
+  }
+
+  uint32_t span = end - w_start;
+  if (span < FCS_SCHED_WINDOW_US) return;
+  if ((uint64_t)w_over_us * 1000U < (uint64_t)span * FCS_SCHED_MISS_PM) s_pass.missed = 0;
+  else if (s_pass.missed < UINT8_MAX) s_pass.missed++;
+  if (s_pass.missed >= FCS_SCHED_TRIP_WINDOWS) s_pass.tripped = 1;
+  w_start = end;
+  w_over_us = 0;
+}
+
+uint32_t FCS_Sched_Run(void) {
+  uint32_t busy = 0;
+  uint32_t start = s_now();
+  uint32_t top_us = 0;
+  int8_t top = -1;
+  for (;;) {
+    uint32_t now = s_now();
+    uint8_t i = 0;
+    while (i < s_count && !Sched_Ready(&s_tasks[i], now)) i++;
+    if (i == s_count) {
+      Sched_Pass_End(start, busy, top);
+      return busy;
+    }
+
+    // Release time: the periodic slot if it is due, else now (signal)
+    FCS_Task_t *t = &s_tasks[i];
+    uint32_t release = now;
+    if (t->period_us != 0 && DUE(now, t->next_us)) {
+      release = t->next_us;
+      t->next_us += t->period_us;
+      if (DUE(now, t->next_us)) {
+        // Late by whole periods: drop those releases, keep the phase
+        uint32_t missed = (now - t->next_us) / t->period_us + 1;
+        t->skipped += missed;
+        t->next_us += missed * t->period_us;
+      }
+    }
+    t->signalled = 0; // Before running: a signal raised meanwhile runs it again
+
+    t->run();
+
+    uint32_t end = s_now();
+    uint32_t run = end - now;
+    uint32_t late = now - release;
+    t->runs++;
+    t->last_us = run;
+    t->total_us += run;
+    if (run > t->max_us) t->max_us = run;
+    if (late > t->max_late_us) t->max_late_us = late;
+    if (t->deadline_us != 0 && end - release > t->deadline_us) t->overruns++;
+    if (run >= top_us) {
+      top_us = run;
+      top = (int8_t)i;
+    }
+    busy += run;
+  }
+}
+
+void FCS_Sched_Signal(FCS_Task_t *task) {
+  task->signalled = 1;
+}
+
+uint32_t FCS_Sched_Idle_Us(void) {
+  uint32_t now = s_now();
+  uint32_t idle = UINT32_MAX;
+  for (uint8_t i = 0; i < s_count; i++) {
+    const FCS_Task_t *t = &s_tasks[i];
+    if (Sched_Ready(t, now)) return 0;
+    if (t->period_us != 0 && t->next_us - now < idle) idle = t->next_us - now;
+  }
+  return idle;
+}
+
+void FCS_Sched_Set_Period(FCS_Task_t *task, uint32_t period_ms) {
+  uint32_t period_us = period_ms * 1000U;
+  if (task->period_us == period_us) return;
+  task->period_us = period_us;
+  task->next_us = s_now() + period_us;
+}
+
+uint8_t FCS_Sched_Count(void) {
+  return s_count;
+}
+
+const FCS_Task_t *FCS_Sched_Task(uint8_t idx) {
+  return (idx < s_count) ? &s_tasks[idx] : NULL;
+}
+
+const FCS_SchedPass_t *FCS_Sched_Pass(void) {
+  return &s_pass;
+}
+
+int FCS_Sched_Healthy(void) {
+  return !s_pass.tripped;
+}
+
+void FCS_Sched_Reset_Stats(void) {
+  s_pass.passes = 0;
+  s_pass.overruns = 0;
+  s_pass.max_us = 0;
+  s_pass.max_task = -1;
+  s_pass.streak = 0;
+  s_pass.max_streak = 0;
+  for (uint8_t i = 0; i < s_count; i++) {
+    FCS_Task_t *t = &s_tasks[i];
+    t->runs = 0;
+    t->overruns = 0;
+    t->skipped = 0;
+    t->last_us = 0;
+    t->max_us = 0;
+    t->total_us = 0;
+    t->max_late_us = 0;
+  }
+}
@@ -0,0 +1,36 @@
+#include "fcs_stack.h"
+#include "main.h"
+#include <stddef.h>
+
+// Linker script symbols (their addresses are the values)
+extern uint8_t _end;
+extern uint8_t _estack;
+extern uint8_t _Min_Heap_Size;
+extern uint8_t _Min_Stack_Size;
+
+#define STACK_MARGIN  16  // Words left unpainted below the live SP
+
+static uint32_t *s_bottom = NULL; // Lowest painted word
+
+void FCS_Stack_Paint(void) {
+  uintptr_t top = (uintptr_t)&_estack;
+  uintptr_t bottom = top - (uintptr_t)&_Min_Stack_Size - FCS_STACK_GUARD;
+  uintptr_t heap = (uintptr_t)&_end + (uintptr_t)&_Min_Heap_Size; // Keep off the heap reserve
+  if (bottom < heap) bottom = heap;
+  bottom = (bottom + 3U) & ~(uintptr_t)3U;
+
+  uint32_t *sp = (uint32_t *)__get_MSP() - STACK_MARGIN;
+  s_bottom = (uint32_t *)bottom;
+  for (uint32_t *p = s_bottom; p < sp; p++) *p = FCS_STACK_FILL;
+}
+
+uint32_t FCS_Stack_Hwm(void) {
+  if (s_bottom == NULL) return 0;
+  const uint32_t *p = s_bottom;
+  while (*p == FCS_STACK_FILL) p++; // Stops at the live frames at the latest
+  return (uint32_t)((uintptr_t)&_estack - (uintptr_t)p);
+}
+
+uint32_t FCS_Stack_Budget(void) {
+  return (uint32_t)(uintptr_t)&_Min_Stack_Size;
+}
@@ -0,0 +1,35 @@
+#include "fcs_wdg.h"
+#include "main.h"
+
+// IWDG key register values
+#define WDG_KEY_RELOAD  0xAAAAU
+#define WDG_KEY_ACCESS  0x5555U
+#define WDG_KEY_START   0xCCCCU
+
+#define WDG_LSI_HZ      32000U
+#define WDG_PRESCALER   64U     // PR = 4
+#define WDG_RELOAD      ((uint32_t)FCS_WDG_TIMEOUT_MS * (WDG_LSI_HZ / WDG_PRESCALER) / 1000U)
+
+_Static_assert(WDG_RELOAD <= 0xFFF, "Watchdog timeout exceeds the 12-bit reload");
+
+uint8_t FCS_Wdg_Boot(void) {
+  uint8_t wdg = (RCC->CSR & RCC_CSR_IWDGRSTF) != 0;
+  RCC->CSR |= RCC_CSR_RMVF; // Clear for the next reset
+  return wdg;
+}
+
+#if FCS_DEADLINE_WDG
+void FCS_Wdg_Start(void) {
+  DBGMCU->APB1FZ |= DBGMCU_APB1_FZ_DBG_IWDG_STOP; // Hold while halted in the debugger
+  IWDG->KR = WDG_KEY_START;  // Starts the LSI; cannot be stopped until reset
+  IWDG->KR = WDG_KEY_ACCESS;
+  IWDG->PR = IWDG_PR_PR_2;   // /64
+  IWDG->RLR = WDG_RELOAD;
+  while (IWDG->SR != 0) {}   // PR/RLR cross into the LSI domain
+  IWDG->KR = WDG_KEY_RELOAD;
+}
+
+void FCS_Wdg_Feed(void) {
+  IWDG->KR = WDG_KEY_RELOAD;
+}
+#endif
@@ -1,7 +1,7 @@
 #include "flash_ops.h"
+#include "fcs_wdg.h"
 #include <string.h>
 #include <stddef.h>
-#include <stdio.h>
 
 // Software CRC32 (Polynomial 0xEDB88320, reflected)
 // No lookup table — saves Flash, only called on save/load
@@ -87,6 +87,7 @@ void Flash_Save_BatteryPos(FCS_System_t *sys) {
   EraseInitStruct.Sector = FLASH_SECTOR_7;
   EraseInitStruct.NbSectors = 1;
 
+  FCS_Wdg_Feed(); // 128 KB erase: up to 2 s with the core stalled
   if (HAL_FLASHEx_Erase(&EraseInitStruct, &SectorError) != HAL_OK) {
     DBG_PRINT("[FLASH] Erase Error (Code: %lu)\r\n", (unsigned long)SectorError);
     HAL_FLASH_Lock();
@@ -8,7 +8,7 @@
   */
 // [Input Scan] - With Dead Zones (Safety)
 KeyState Input_Scan(uint32_t adc_value) {
-  if (adc_value > 3800) return KEY_NONE;
+  if (adc_value > INPUT_KEY_IDLE_MIN) return KEY_NONE;
   if (adc_value < 200)  return KEY_LEFT;
   if (adc_value > 400  && adc_value < 900)  return KEY_UP;
   if (adc_value > 1100 && adc_value < 1600) return KEY_DOWN;
@@ -35,3 +35,26 @@ void Input_Read_All(ADC_HandleTypeDef *hadc, uint32_t *dest) {
   }
   HAL_ADC_Stop(hadc);
 }
+
+// [Key Wake] Register level: the HAL watchdog config would also rewrite the
+// scan settings Input_Read_All relies on.
+void Input_Wake_Arm(ADC_HandleTypeDef *hadc) {
+  ADC_TypeDef *adc = hadc->Instance;
+  HAL_ADC_Stop(hadc);
+  adc->LTR = INPUT_KEY_IDLE_MIN;
+  adc->HTR = 0xFFF;
+  adc->CR1 = (adc->CR1 & ~ADC_CR1_AWDCH) | INPUT_KEY_CHANNEL | ADC_CR1_AWDSGL | ADC_CR1_AWDEN;
+  adc->CR2 &= ~ADC_CR2_EOCS;  // EOC per sequence: no overrun stop while nobody reads DR
+  __HAL_ADC_CLEAR_FLAG(hadc, ADC_FLAG_AWD);
+  __HAL_ADC_ENABLE_IT(hadc, ADC_IT_AWD);
+  HAL_ADC_Start(hadc);        // Continuous scan
+}
+
+void Input_Wake_Disarm(ADC_HandleTypeDef *hadc) {
+  ADC_TypeDef *adc = hadc->Instance;
+  __HAL_ADC_DISABLE_IT(hadc, ADC_IT_AWD);
+  HAL_ADC_Stop(hadc);
+  adc->CR1 &= ~(ADC_CR1_AWDEN | ADC_CR1_AWDSGL);
+  adc->CR2 |= ADC_CR2_EOCS;   // ADC_EOC_SINGLE_CONV, as MX_ADC1_Init
+  __HAL_ADC_CLEAR_FLAG(hadc, ADC_FLAG_AWD | ADC_FLAG_OVR);
+}
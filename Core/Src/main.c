@@ -7,13 +7,13 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "adc.h"
+#include "dma.h"
 #include "i2c.h"
 #include "usart.h"
 #include "gpio.h"
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-#include <stdio.h>
 #include <string.h>
 #include "ssd1306.h"
 #include "ssd1306_fonts.h"
@@ -22,6 +22,13 @@
 #include "input.h" 
 #include "flash_ops.h"
 #include "fcs_core.h" // Business Logic Core
+#include "fcs_sched.h"
+#include "fcs_power.h"
+#include "fcs_rtos.h"
+#include "fcs_wdg.h"
+#include "fcs_boot.h"
+#include "fcs_clock.h"
+#include "fcs_stack.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -31,7 +38,10 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+#define KEYS_IDLE_SCANS   50  // 500 ms without a key or knob move -> wake on ADC watchdog
+#define KNOB_MOVE_DELTA   32  // ADC counts; above the ladder noise
+#define BOOT_BMP_TIMEOUT_MS  100  // Reset -> first sample; the old blind wait is now the bound
+#define BOOT_LCD_TIMEOUT_MS  100  // Power-up -> panel ACK
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -49,6 +59,75 @@ FCS_System_t fcs; // System Global Instance
 // Only Handle injection remains here.
 
 extern UART_HandleTypeDef huart2;
+
+// [Tasks] Priority order (index 0 first); rates in fcs_sched.h
+static void Task_Serial(void);
+static void Task_Keys(void);
+static void Task_Boot(void);
+static void Task_Sensor(void);
+static void Task_Display(void);
+static void Task_Led(void);
+
+enum { TASK_SERIAL, TASK_KEYS, TASK_BOOT, TASK_SENSOR, TASK_DISPLAY, TASK_LED, TASK_COUNT };
+
+static FCS_Task_t tasks[TASK_COUNT] = {
+  [TASK_SERIAL]  = FCS_TASK("SER", Task_Serial, FCS_TASK_SERIAL_MS, 20),
+  [TASK_KEYS]    = FCS_TASK("KEY", Task_Keys, FCS_TASK_KEYS_MS, 0),
+  [TASK_BOOT]    = FCS_TASK("BOOT", Task_Boot, FCS_BOOT_POLL_MS, 0), // Retires once the devices are up
+  [TASK_SENSOR]  = FCS_TASK("BMP", Task_Sensor, FCS_TASK_SENSOR_MS, 0),
+  [TASK_DISPLAY] = FCS_TASK("LCD", Task_Display, FCS_TASK_DISPLAY_MS, 0),
+  [TASK_LED]     = FCS_TASK("LED", Task_Led, FCS_TASK_LED_MS, 0),
+};
+
+_Static_assert(FCS_TASK_SENSOR_MS == BMP280_ODR_MS, "Sensor task must follow the BMP280 output rate");
+
+// [Boot Lines] I2C devices, brought up by the boot task while the link is
+// served (fcs_boot.h). Each step is one short transfer.
+static int8_t Boot_Bmp_Reset(void) {
+  BMP280_Reset();
+  return FCS_STEP_DONE;
+}
+
+static int8_t Boot_Bmp_Ready(void) {
+  return BMP280_Busy() ? FCS_STEP_WAIT : FCS_STEP_DONE;
+}
+
+static int8_t Boot_Bmp_Config(void) {
+  return (BMP280_Configure() == 0) ? FCS_STEP_DONE : FCS_STEP_FAIL;
+}
+
+// The data registers hold their reset value until the first conversion (t_meas)
+static int8_t Boot_Bmp_Sample(void) {
+  BMP280_Data_t d;
+  BMP280_Read_All(&d);
+  return (d.raw_pressure == BMP280_ADC_RESET && d.raw_temperature == BMP280_ADC_RESET) ? FCS_STEP_WAIT
+                                                                                         : FCS_STEP_DONE;
+}
+
+static int8_t Boot_Lcd_Ready(void) {
+  return ssd1306_Ready() ? FCS_STEP_DONE : FCS_STEP_WAIT;
+}
+
+static int8_t Boot_Lcd_Config(void) {
+  ssd1306_Configure(); // Commands only; the display task pushes the first frame
+  return FCS_STEP_DONE;
+}
+
+static const FCS_BootStep_t boot_bmp[] = { Boot_Bmp_Reset, Boot_Bmp_Ready, Boot_Bmp_Config, Boot_Bmp_Sample };
+static const FCS_BootStep_t boot_lcd[] = { Boot_Lcd_Ready, Boot_Lcd_Config };
+
+enum { BOOT_BMP, BOOT_LCD, BOOT_COUNT }; // Bit order of diag.boot_fail
+
+static FCS_BootLine_t boot_lines[BOOT_COUNT] = {
+  [BOOT_BMP] = FCS_BOOT_LINE("BMP280", boot_bmp, BOOT_BMP_TIMEOUT_MS),
+  [BOOT_LCD] = FCS_BOOT_LINE("OLED", boot_lcd, BOOT_LCD_TIMEOUT_MS),
+};
+
+// [Key Scan Mode] Active: 10 ms scans. Idle: the ADC watchdog wakes on a press
+// and the knobs are sampled on the sensor wake.
+static uint8_t keys_idle = 0;
+static uint8_t keys_quiet = 0;      // Scans without a key or knob move
+static uint32_t knob_ref[3];
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -65,7 +144,173 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
   if (huart->Instance == USART2 || huart->Instance == USART1) { 
     FCS_UART_RxCallback(huart);
   }
+  if (huart->Instance == USART1) {
+#if FCS_USE_RTOS
+    FCS_Rtos_Link_Wake();
+#else
+    FCS_Sched_Signal(&tasks[TASK_SERIAL]); // Link byte: parse now, not at the next poll
+#endif
+  }
+}
+
+// [UART Tx Callback] Debug log DMA drained a run
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+#if FCS_LOG_DEFERRED
+  if (huart->Instance == USART2) FCS_Log_Tx_Done();
+#endif
+}
+
+// [ADC Watchdog] Key pressed while the scan is idle
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc) {
+  __HAL_ADC_DISABLE_IT(hadc, ADC_IT_AWD); // Fires every conversion while held
+  FCS_Sched_Signal(&tasks[TASK_KEYS]);
+}
+
+static void Task_Serial(void) {
+  FCS_Clock_Boost(); // Parse and solve at 84 MHz
+  FCS_Task_Serial(&fcs, &huart1); // Respond to BT
+  if (FCS_Serial_Busy()) FCS_Sched_Signal(&tasks[TASK_SERIAL]);
+
+  // Poll only while a timeout or telemetry is pending; RX signals the rest
+  FCS_Sched_Set_Period(&tasks[TASK_SERIAL], FCS_Serial_Timed() ? FCS_TASK_SERIAL_MS : 0);
+  FCS_Sched_Signal(&tasks[TASK_DISPLAY]); // A request may have changed the screen
+}
+
+static void Keys_Set_Idle(uint8_t idle) {
+  keys_idle = idle;
+  keys_quiet = 0;
+  FCS_Sched_Set_Period(&tasks[TASK_KEYS], idle ? 0 : FCS_TASK_KEYS_MS);
+}
+
+static void Task_Keys(void) {
+  KeyState key = fcs.input.key_state;
+  UI_State_t state = fcs.state;
+  uint8_t cursor = fcs.cursor_pos;
+
+  if (keys_idle) Input_Wake_Disarm(&hadc1);
+  FCS_Update_Input(&fcs, &hadc1);
+  UI_Update(&fcs);
+
+  // Key edge or screen change: redraw now
+  if (fcs.input.key_state != key || fcs.state != state || fcs.cursor_pos != cursor) {
+    FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+  }
+
+  int moved = 0;
+  for (int i = 0; i < 3; i++) {
+    uint32_t v = fcs.input.knob_values[i];
+    if ((v > knob_ref[i] ? v - knob_ref[i] : knob_ref[i] - v) > KNOB_MOVE_DELTA) {
+      knob_ref[i] = v;
+      moved = 1;
+    }
+  }
+  if (fcs.input.key_state != KEY_NONE || moved) {
+    if (keys_idle) Keys_Set_Idle(0);
+    keys_quiet = 0;
+  } else if (!keys_idle && ++keys_quiet >= KEYS_IDLE_SCANS) {
+    Keys_Set_Idle(1);
+  }
+  if (keys_idle) Input_Wake_Arm(&hadc1);
 }
+
+// Returns 1 once every device is up or failed; records the boot times once
+static uint8_t Boot_Poll(void) {
+  if (!FCS_Boot_Poll()) return 0;
+  if (fcs.diag.boot_done_ms == 0) {
+    uint32_t now = HAL_GetTick();
+    fcs.diag.boot_done_ms = (uint16_t)(now > 0xFFFF ? 0xFFFF : (now > 0 ? now : 1));
+    fcs.diag.boot_fail = FCS_Boot_Failed();
+    DBG_PRINT("[BOOT] link %u ms, devices %u ms, failed 0x%02X\r\n", (unsigned)fcs.diag.boot_link_ms,
+              (unsigned)fcs.diag.boot_done_ms, (unsigned)fcs.diag.boot_fail);
+  }
+  return 1;
+}
+
+static void Task_Boot(void) {
+  if (!Boot_Poll()) return;
+  FCS_Sched_Set_Period(&tasks[TASK_BOOT], 0); // Retired: nothing signals it
+  FCS_Sched_Signal(&tasks[TASK_SENSOR]);      // First sample into env
+  FCS_Sched_Signal(&tasks[TASK_DISPLAY]);     // First frame
+}
+
+static void Task_Sensor(void) {
+  if (FCS_Boot_Up(BOOT_BMP)) FCS_Update_Sensors(&fcs); // Else standard atmosphere (FCS_Init_System)
+  FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+  if (keys_idle) FCS_Sched_Signal(&tasks[TASK_KEYS]); // Knob check on the same wake
+}
+
+static void Task_Display(void) {
+  // Panel configured, and no 100 ms push while another device is still coming up
+  if (!FCS_Boot_Done_Us() || !FCS_Boot_Up(BOOT_LCD)) return;
+  UI_Draw(&fcs); // No-op unless the shown data changed
+}
+
+static void Task_Led(void) {
+  HAL_GPIO_TogglePin(LD2_GPIO_Port, LD2_Pin); // ~1Hz heartbeat
+}
+
+#if FCS_USE_RTOS
+// [RTOS Tasks] Bodies for fcs_rtos.c, which replaces the table above.
+// Keys scan at a fixed rate here (no ADC watchdog idle mode).
+uint32_t FCS_App_Link(void) {
+  return FCS_Link_Poll(&fcs, &huart1);
+}
+
+void FCS_App_Mission(void *job) {
+  FCS_Link_Job(&fcs, &huart1, job);
+  FCS_Rtos_Redraw(); // A request may have changed the screen
+}
+
+void FCS_App_Keys(void) {
+  FCS_Rtos_State_Lock();
+  KeyState key = fcs.input.key_state;
+  UI_State_t state = fcs.state;
+  uint8_t cursor = fcs.cursor_pos;
+  FCS_Update_Input(&fcs, &hadc1);
+  UI_Update(&fcs);
+  int changed = fcs.input.key_state != key || fcs.state != state || fcs.cursor_pos != cursor;
+  FCS_Rtos_State_Unlock();
+  if (changed) FCS_Rtos_Redraw();
+}
+
+uint8_t FCS_App_Boot(void) {
+  FCS_Rtos_Bus_Lock();
+  uint8_t done = Boot_Poll();
+  FCS_Rtos_Bus_Unlock();
+  if (done) FCS_Rtos_Redraw(); // First frame
+  return done;
+}
+
+void FCS_App_Sensor(void) {
+  static uint8_t beat = 0;
+  if (FCS_Boot_Up(BOOT_BMP)) {
+    FCS_Rtos_Bus_Lock(); // Waits out a panel push in progress
+    FCS_Rtos_State_Lock();
+    FCS_Update_Sensors(&fcs);
+    FCS_Rtos_State_Unlock();
+    FCS_Rtos_Bus_Unlock();
+  }
+  FCS_Rtos_Redraw();
+#if FCS_LOG_DEFERRED
+  FCS_Log_Kick();
+#endif
+  if (++beat >= FCS_TASK_LED_MS / FCS_TASK_SENSOR_MS) {
+    beat = 0;
+    Task_Led();
+  }
+}
+
+void FCS_App_Display(void) {
+  if (!FCS_Boot_Done_Us() || !FCS_Boot_Up(BOOT_LCD)) return;
+  FCS_Rtos_State_Lock();
+  int drawn = UI_Render(&fcs); // Frame buffer is the display task's own
+  FCS_Rtos_State_Unlock();
+  if (!drawn) return;
+  FCS_Rtos_Bus_Lock();
+  UI_Push(); // Preempted by every other task
+  FCS_Rtos_Bus_Unlock();
+}
+#endif
 /* USER CODE END 0 */
 
 /**
@@ -76,7 +321,7 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
-
+  FCS_Stack_Paint(); // Watermark for STATUS
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -97,28 +342,16 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
   MX_ADC1_Init();
   MX_I2C1_Init();
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
   
-  // 1. OLED Init
-  HAL_Delay(100); 
-  ssd1306_Init(); 
-  ssd1306_Fill(0); 
-  
-  // 2. BMP280 Init
-  HAL_Delay(100);
-  uint8_t bmp_res = BMP280_Init();
-  if (bmp_res != 0) {
-      ssd1306_SetCursor(0,0);
-      ssd1306_WriteString("SENSOR ERROR", Font_7x10, White);
-      ssd1306_UpdateScreen();
-  }
-  
-  // 3. System & UI Init
+  // 1. System & UI Init (RAM only: no device waits before the link is up)
   FCS_Init_System(&fcs);
+  fcs.diag.reset_wdg = FCS_Wdg_Boot();
   UI_Init(&fcs); // Initialize UI State specifically
   
   // [Flash] Load Saved Battery Position
@@ -177,8 +410,18 @@ int main(void)
   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
   DWT->CYCCNT = 0;
   DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  fcs.diag.boot_link_ms = (uint16_t)HAL_GetTick();
+
+  // 2. I2C devices: the boot task (or the RTOS sensor task) steps them up
+  FCS_Boot_Init(boot_lines, BOOT_COUNT, FCS_Power_Now_Us);
 
   DBG_PRINT("\r\n[FCS] System Ready. Waiting for Commands...\r\n");
+#if FCS_USE_RTOS
+  FCS_Rtos_Start(); // Does not return
+#endif
+  FCS_Sched_Init(tasks, TASK_COUNT, FCS_Power_Now_Us);
+  FCS_Clock_Init(FCS_Power_Now_Us);
+  FCS_Wdg_Start();
   
   /* USER CODE END 2 */
 
@@ -189,30 +432,31 @@ int main(void)
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
-    uint32_t tick_start = HAL_GetTick();
-
-    // [1] State Updates (Business Logic)
-    FCS_Update_Input(&fcs, &hadc1);
-    FCS_Update_Sensors(&fcs);
-
-    // [2] UI Logic
-    UI_Update(&fcs);
-    UI_Draw(&fcs);
-
-    // [3] Background Tasks
-    FCS_Task_Serial(&fcs, &huart1); // Respond to BT
-
-    // [4] LED Heartbeat (~1Hz, toggle every 500ms)
-    static uint32_t led_tick = 0;
-    if (HAL_GetTick() - led_tick >= 500) {
-      led_tick = HAL_GetTick();
-      HAL_GPIO_TogglePin(LD2_GPIO_Port, LD2_Pin);
-    }
-
-    // [5] Control Loop Rate (~50Hz, WFI saves power during idle)
-    while (HAL_GetTick() - tick_start < 20) {
-      HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
-    }
+    // [1] Run every task that is due or signalled, highest priority first
+    uint32_t busy_us = FCS_Sched_Run();
+
+    // Busy time of this pass (reported via telemetry)
+    if (busy_us > 0) FCS_Update_LoopTime(&fcs, busy_us);
+
+    // Deadline monitor: a hung or saturated loop stops feeding the watchdog
+    if (FCS_Sched_Healthy()) FCS_Wdg_Feed();
+
+    uint16_t sleep_pm, wake_dhz;
+    if (FCS_Power_Window(&sleep_pm, &wake_dhz)) FCS_Update_Sleep(&fcs, sleep_pm, wake_dhz);
+#if FCS_LOG_DEFERRED
+    FCS_Log_Kick(); // Debug log drains by DMA while the core sleeps
+#endif
+
+    // Clock governor: 16 MHz only on the idle screen with nothing in flight
+    FCS_Clock_Idle(fcs.state == UI_WAITING && keys_idle && FCS_Boot_Done_Us() != 0 &&
+                   FCS_Serial_GetBaud() == FCS_BAUD_DEFAULT && !FCS_Serial_Busy());
+
+    // [2] Idle: sleep until the next release or interrupt (UART, key ADC watchdog).
+    // Checked with IRQs masked: a signal raised after the check still ends the WFI.
+    __disable_irq();
+    uint32_t idle_us = FCS_Sched_Idle_Us();
+    if (idle_us > 0) FCS_Power_Sleep(idle_us);
+    __enable_irq();
   }
   /* USER CODE END 3 */
 }
@@ -264,7 +508,7 @@ void SystemClock_Config(void)
 }
 
 /* USER CODE BEGIN 4 */
-// [UART Redirect] printf to USART2
+// [UART Redirect] printf to USART2 (DBG_PRINT uses it only with FCS_LOG_DEFERRED=0)
 int _write(int file, char *ptr, int len) {
     HAL_UART_Transmit(&huart2, (uint8_t*)ptr, len, 1000);
     return len;
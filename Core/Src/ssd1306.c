@@ -9,6 +9,11 @@ void ssd1306_Reset(void) {
   /* for I2C - do nothing */
 }
 
+// Controller out of reset: it ACKs its address
+uint8_t ssd1306_Ready(void) {
+  return HAL_I2C_IsDeviceReady(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 1, 2) == HAL_OK;
+}
+
 // Send a byte to the command register
 void ssd1306_WriteCommand(uint8_t byte) {
   HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1, &byte, 1, HAL_MAX_DELAY);
@@ -32,6 +37,10 @@ void ssd1306_Reset(void) {
   HAL_Delay(10);
 }
 
+uint8_t ssd1306_Ready(void) {
+  return 1; // Reset pulse above
+}
+
 // Send a byte to the command register
 void ssd1306_WriteCommand(uint8_t byte) {
   HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
@@ -77,6 +86,15 @@ void ssd1306_Init(void) {
   // Wait for the screen to boot
   HAL_Delay(100);
 
+  ssd1306_Configure();
+
+  // Flush buffer to screen
+  ssd1306_UpdateScreen();
+}
+
+/* Initialize without the boot wait or the blank push: for callers that poll
+   ssd1306_Ready() and push their first frame themselves */
+void ssd1306_Configure(void) {
   // Init OLED
   ssd1306_SetDisplayOn(0); //display off
 
@@ -161,9 +179,6 @@ void ssd1306_Init(void) {
   // Clear screen
   ssd1306_Fill(Black);
   
-  // Flush buffer to screen
-  ssd1306_UpdateScreen();
-  
   // Set default values for screen object
   SSD1306.CurrentX = 0;
   SSD1306.CurrentY = 0;
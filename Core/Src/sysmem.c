@@ -23,6 +23,23 @@
 /* Includes */
 #include <errno.h>
 #include <stdint.h>
+#include <stddef.h>
+
+#if defined(FCS_NO_HEAP_STDIO) && FCS_NO_HEAP_STDIO
+/* Heap-free profile (fcs_common.h): the linker script sizes the heap from
+ * __fcs_heap_size and discards .fcs_noheap, so anything that still pulls in
+ * _sbrk (malloc, newlib stdio) stops the link with
+ * "`_sbrk' referenced in section ... defined in discarded section `.fcs_noheap'". */
+__asm__(".global __fcs_heap_size\n.set __fcs_heap_size, 0");
+
+__attribute__((section(".fcs_noheap")))
+void *_sbrk(ptrdiff_t incr)
+{
+  (void)incr;
+  errno = ENOMEM;
+  return (void *)-1;
+}
+#else
 
 /**
  * Pointer to the current high watermark of the heap usage
@@ -77,3 +94,4 @@ void *_sbrk(ptrdiff_t incr)
 
   return (void *)prev_heap_end;
 }
+#endif /* FCS_NO_HEAP_STDIO */
@@ -1,7 +1,8 @@
 #include "ui.h"
 #include "fcs_math.h" // Added Math Module
 #include "flash_ops.h" // Added Flash Logic
-#include <stdio.h>
+#include "fcs_probe.h"
+#include "fcs_fmt.h"
 #include <string.h>
 #include <math.h> 
 
@@ -11,7 +12,6 @@
 // UI Constants
 #define ADC_MAX           4096
 #define KEY_DEBOUNCE_MS   200
-#define BOOT_DELAY_MS     1000
 #define CHARGE_MAX        7
 #define ROUNDS_MIN        1
 #define ROUNDS_MAX        10
@@ -41,12 +41,8 @@ void UI_Init(FCS_System_t *sys) {
   sys->adj.range_m = 0;
   sys->adj.az_mil = 0;
     
-  // 초기화 메시지
-  ssd1306_Fill(0);
-  ssd1306_SetCursor(20, 20); // Center Aligned
-  ssd1306_WriteString("SYSTEM INIT...", Font_7x10, White);
-  ssd1306_UpdateScreen();
-  HAL_Delay(BOOT_DELAY_MS);
+  // No splash: the panel comes up in the background (fcs_boot.h) and its
+  // first frame is already the battery screen
     
   // 바로 1단계 진입
   sys->state = UI_BP_SETTING;
@@ -226,9 +222,87 @@ void UI_Update(FCS_System_t *sys) {
   last_key = key;
 }
 
-// [화면 그리기]
-void UI_Draw(FCS_System_t *sys) {
+// [Display Cache] Everything UI_Draw shows. A full push is ~1.1 KB over I2C at
+// 100 kHz (~100 ms), so the panel is only rendered and sent when one changes.
+typedef struct {
+  uint8_t  state;
+  uint8_t  cursor;
+  uint16_t mask;
+  int16_t  adj_range, adj_az;
+  int32_t  charge, rounds, error;
+  float    az, el;
+  float    air_temp, air_pressure, prop_temp;
+  int32_t  zone[2];
+  char     band[2];
+  double   easting[2], northing[2];
+  float    alt[2];
+} UI_View_t;
+
+static UI_View_t ui_shown;
+static uint8_t ui_valid = 0;
+
+static int UI_View_Changed(const FCS_System_t *sys) {
+  UI_View_t v;
+  memset(&v, 0, sizeof(v)); // Padding compares equal
+  v.state = (uint8_t)sys->state;
+  v.cursor = sys->cursor_pos;
+  v.mask = sys->mask_angle;
+  v.adj_range = sys->adj.range_m;
+  v.adj_az = sys->adj.az_mil;
+  v.charge = sys->fire.charge;
+  v.rounds = sys->fire.rounds;
+  v.error = sys->fire.error;
+  v.az = sys->fire.azimuth;
+  v.el = sys->fire.elevation;
+  v.air_temp = sys->env.air_temp;
+  v.air_pressure = sys->env.air_pressure;
+  v.prop_temp = sys->env.prop_temp;
+  const UTM_Coord_t *pos[2] = { &sys->user_pos, &sys->tgt_pos };
+  for (int i = 0; i < 2; i++) {
+    v.zone[i] = pos[i]->zone;
+    v.band[i] = pos[i]->band;
+    v.easting[i] = pos[i]->easting;
+    v.northing[i] = pos[i]->northing;
+    v.alt[i] = pos[i]->altitude;
+  }
+  if (ui_valid && memcmp(&v, &ui_shown, sizeof(v)) == 0) return 0;
+  ui_shown = v;
+  ui_valid = 1;
+  return 1;
+}
+
+// [위치 표시] Zone/band + easting, northing, altitude (BP_SETTING, TARGET_LOCK)
+static void UI_Draw_Position(const UTM_Coord_t *pos) {
+    char buf[32];
+    FCS_Fmt_t f;
+
+    FCS_Fmt_Init(&f, buf, sizeof(buf)); // "%d%c E:%06lu"
+    FCS_Fmt_Int(&f, pos->zone, 0, ' ');
+    FCS_Fmt_Char(&f, pos->band);
+    FCS_Fmt_Str(&f, " E:");
+    FCS_Fmt_Uint(&f, (uint32_t)pos->easting, 6, '0');
+    ssd1306_SetCursor(0, 16);
+    ssd1306_WriteString(buf, Font_7x10, White);
+
+    FCS_Fmt_Init(&f, buf, sizeof(buf)); // "    N:0%07lu"
+    FCS_Fmt_Str(&f, "    N:0");
+    FCS_Fmt_Uint(&f, (uint32_t)pos->northing, 7, '0');
+    ssd1306_SetCursor(0, 28);
+    ssd1306_WriteString(buf, Font_7x10, White);
+
+    // Line 3: A, Y=40 - Aligned with Colon
+    FCS_Fmt_Init(&f, buf, sizeof(buf)); // "    A:%04d m"
+    FCS_Fmt_Str(&f, "    A:");
+    FCS_Fmt_Int(&f, (int32_t)pos->altitude, 4, '0');
+    FCS_Fmt_Str(&f, " m");
+    ssd1306_SetCursor(0, 40);
+    ssd1306_WriteString(buf, Font_7x10, White);
+}
+
+// [화면 그리기] Into the frame buffer only
+static void UI_Render_View(FCS_System_t *sys) {
     char buf[32];
+    FCS_Fmt_t f;
     ssd1306_Fill(0); 
 
     int cx = 0, cw = 0, cy = 0;
@@ -245,18 +319,7 @@ void UI_Draw(FCS_System_t *sys) {
             ssd1306_WriteString("[BATTERY POS]", Font_6x8, White);
 
             // Data
-            snprintf(buf, sizeof(buf), "%d%c E:%06lu", sys->user_pos.zone, sys->user_pos.band, (uint32_t)sys->user_pos.easting);
-            ssd1306_SetCursor(0, 16);
-            ssd1306_WriteString(buf, Font_7x10, White);
-
-            snprintf(buf, sizeof(buf), "    N:0%07lu", (uint32_t)sys->user_pos.northing);
-            ssd1306_SetCursor(0, 28);
-            ssd1306_WriteString(buf, Font_7x10, White);
-
-            // Data (Line 3: A) Y=40 - Aligned with Colon
-            snprintf(buf, sizeof(buf), "    A:%04d m", (int)sys->user_pos.altitude);
-            ssd1306_SetCursor(0, 40); 
-            ssd1306_WriteString(buf, Font_7x10, White);
+            UI_Draw_Position(&sys->user_pos);
 
             // Action Button
             ssd1306_SetCursor(80, 54);
@@ -277,19 +340,29 @@ void UI_Draw(FCS_System_t *sys) {
             ssd1306_WriteString("[STANDBY]", Font_6x8, White);
             
             // Env Data
-            snprintf(buf, sizeof(buf), "T:%d.%d  P:%d",
-                (int)sys->env.air_temp, (int)(sys->env.air_temp * 10)%10,
-                (int)sys->env.air_pressure);
+            FCS_Fmt_Init(&f, buf, sizeof(buf)); // "T:%d.%d  P:%d"
+            FCS_Fmt_Str(&f, "T:");
+            FCS_Fmt_Int(&f, (int32_t)sys->env.air_temp, 0, ' ');
+            FCS_Fmt_Char(&f, '.');
+            FCS_Fmt_Int(&f, (int32_t)(sys->env.air_temp * 10) % 10, 0, ' ');
+            FCS_Fmt_Str(&f, "  P:");
+            FCS_Fmt_Int(&f, (int32_t)sys->env.air_pressure, 0, ' ');
             ssd1306_SetCursor(10, 14);
             ssd1306_WriteString(buf, Font_7x10, White);
 
             // Propellant Temperature
-            snprintf(buf, sizeof(buf), "PT:%3d C", (int)sys->env.prop_temp);
+            FCS_Fmt_Init(&f, buf, sizeof(buf)); // "PT:%3d C"
+            FCS_Fmt_Str(&f, "PT:");
+            FCS_Fmt_Int(&f, (int32_t)sys->env.prop_temp, 3, ' ');
+            FCS_Fmt_Str(&f, " C");
             ssd1306_SetCursor(32, 28);
             ssd1306_WriteString(buf, Font_7x10, White);
 
             // Mask Data
-            snprintf(buf, sizeof(buf), "Mask: %03u mil", sys->mask_angle);
+            FCS_Fmt_Init(&f, buf, sizeof(buf)); // "Mask: %03u mil"
+            FCS_Fmt_Str(&f, "Mask: ");
+            FCS_Fmt_Uint(&f, sys->mask_angle, 3, '0');
+            FCS_Fmt_Str(&f, " mil");
             ssd1306_SetCursor(18, 42);
             ssd1306_WriteString(buf, Font_7x10, White);
             break;
@@ -299,18 +372,7 @@ void UI_Draw(FCS_System_t *sys) {
             ssd1306_WriteString("[MSN CHECK]", Font_6x8, White);
             
             // Target Data (Unified Layout with BP_SETTING)
-            snprintf(buf, sizeof(buf), "%d%c E:%06lu", sys->tgt_pos.zone, sys->tgt_pos.band, (uint32_t)sys->tgt_pos.easting);
-            ssd1306_SetCursor(0, 16);
-            ssd1306_WriteString(buf, Font_7x10, White);
-
-            snprintf(buf, sizeof(buf), "    N:0%07lu", (uint32_t)sys->tgt_pos.northing);
-            ssd1306_SetCursor(0, 28);
-            ssd1306_WriteString(buf, Font_7x10, White);
-
-            // Altitude Input (Unified)
-            snprintf(buf, sizeof(buf), "    A:%04d m", (int)sys->tgt_pos.altitude);
-            ssd1306_SetCursor(0, 40); 
-            ssd1306_WriteString(buf, Font_7x10, White);
+            UI_Draw_Position(&sys->tgt_pos);
 
             // Action Button
             ssd1306_SetCursor(80, 54);
@@ -330,11 +392,16 @@ void UI_Draw(FCS_System_t *sys) {
             ssd1306_SetCursor(28, 0);
             ssd1306_WriteString("[FIRE ORDER]", Font_6x8, White);
             
-            snprintf(buf, sizeof(buf), "CH:%d  AM:HE", sys->fire.charge);
+            FCS_Fmt_Init(&f, buf, sizeof(buf)); // "CH:%d  AM:HE"
+            FCS_Fmt_Str(&f, "CH:");
+            FCS_Fmt_Int(&f, sys->fire.charge, 0, ' ');
+            FCS_Fmt_Str(&f, "  AM:HE");
             ssd1306_SetCursor(20, 16);
             ssd1306_WriteString(buf, Font_7x10, White);
 
-            snprintf(buf, sizeof(buf), "FU:Q6 RD:%d", sys->fire.rounds);
+            FCS_Fmt_Init(&f, buf, sizeof(buf)); // "FU:Q6 RD:%d"
+            FCS_Fmt_Str(&f, "FU:Q6 RD:");
+            FCS_Fmt_Int(&f, sys->fire.rounds, 0, ' ');
             ssd1306_SetCursor(20, 28);
             ssd1306_WriteString(buf, Font_7x10, White);
             
@@ -353,7 +420,11 @@ void UI_Draw(FCS_System_t *sys) {
                 ssd1306_SetCursor(22, 48);
                 ssd1306_WriteString("!MASK ERROR!", Font_7x10, White); 
             } else {
-                snprintf(buf, sizeof(buf), "AZ:%04d QE:%03d", (int)sys->fire.azimuth, (int)sys->fire.elevation);
+                FCS_Fmt_Init(&f, buf, sizeof(buf)); // "AZ:%04d QE:%03d"
+                FCS_Fmt_Str(&f, "AZ:");
+                FCS_Fmt_Int(&f, (int32_t)sys->fire.azimuth, 4, '0');
+                FCS_Fmt_Str(&f, " QE:");
+                FCS_Fmt_Int(&f, (int32_t)sys->fire.elevation, 3, '0');
                 ssd1306_SetCursor(15, 48);
                 ssd1306_WriteString(buf, Font_7x10, White);
             }
@@ -371,7 +442,11 @@ void UI_Draw(FCS_System_t *sys) {
             else if (abs_mil > 0) { dir_c = 'R'; }
             
             // "DEV : " (6 chars) + "C" (1) + "  " (2) + "XXX" (3)
-            snprintf(buf, sizeof(buf), "DEV : %c  %3d", dir_c, abs_mil);
+            FCS_Fmt_Init(&f, buf, sizeof(buf));
+            FCS_Fmt_Str(&f, "DEV : ");
+            FCS_Fmt_Char(&f, dir_c);
+            FCS_Fmt_Str(&f, "  ");
+            FCS_Fmt_Int(&f, abs_mil, 3, ' ');
             ssd1306_SetCursor(10, 20);
             ssd1306_WriteString(buf, Font_7x10, White);
 
@@ -384,7 +459,11 @@ void UI_Draw(FCS_System_t *sys) {
             if (sys->adj.range_m == 0) sign_c = ' ';
 
             // "RNG : " (6 chars) + "S" (1) + " " (1) + "XXXX" (4)
-            snprintf(buf, sizeof(buf), "RNG : %c %4d", sign_c, abs_rng);
+            FCS_Fmt_Init(&f, buf, sizeof(buf));
+            FCS_Fmt_Str(&f, "RNG : ");
+            FCS_Fmt_Char(&f, sign_c);
+            FCS_Fmt_Char(&f, ' ');
+            FCS_Fmt_Int(&f, abs_rng, 4, ' ');
             ssd1306_SetCursor(10, 35);
             ssd1306_WriteString(buf, Font_7x10, White);
 
@@ -393,6 +472,22 @@ void UI_Draw(FCS_System_t *sys) {
             ssd1306_WriteString("[UPDATE]", Font_6x8, White);
             break;
     }
-    
-    ssd1306_UpdateScreen(); 
+}
+
+int UI_Render(FCS_System_t *sys) {
+    if (!UI_View_Changed(sys)) return 0;
+    PROBE_BEGIN(PROBE_UI);
+    UI_Render_View(sys);
+    PROBE_END(PROBE_UI);
+    return 1;
+}
+
+void UI_Push(void) {
+    PROBE_BEGIN(PROBE_LCD);
+    ssd1306_UpdateScreen(); // ~100 ms of I2C at 100 kHz
+    PROBE_END(PROBE_LCD);
+}
+
+void UI_Draw(FCS_System_t *sys) {
+    if (UI_Render(sys)) UI_Push();
 }
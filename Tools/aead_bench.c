@@ -0,0 +1,164 @@
+// Host check and benchmark for the firmware AEAD codec (Core/Src/fcs_aead.c).
+//
+//   gcc -O2 -I../Core/Inc aead_bench.c ../Core/Src/fcs_codec.c ../Core/Src/fcs_aead.c -o aead_bench
+//   ./aead_bench aead_vectors.txt
+//
+// [1] Runs every vector in aead_vectors.txt (the client self-test reads the same
+//     file); frame lines are opened by the firmware's codec (fcs_codec.c).
+// [2] Times seal + open per frame size. These are host figures: they show the
+//     per-byte/per-frame split, not Cortex-M4 cycles. On target the budget
+//     (FCS_AEAD_BUDGET_*) is checked with DWT and reported in the status reply.
+#include "fcs_aead.h"
+#include "fcs_codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Development key (FCS_AEAD_KEY_BYTES in fcs_core.h)
+static const uint8_t dev_key[FCS_AEAD_KEY_SIZE] = {
+  0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+  0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f
+};
+
+#define MAX_FIELD 512
+
+// Hex field -> bytes ('-' = empty). Returns length, -1 if malformed.
+static int Hex_Field(const char *s, uint8_t *out) {
+  if (strcmp(s, "-") == 0) return 0;
+  size_t n = strlen(s);
+  if (n % 2 != 0 || n / 2 > MAX_FIELD) return -1;
+  for (size_t i = 0; i < n / 2; i++) {
+    unsigned v;
+    if (sscanf(s + 2 * i, "%2x", &v) != 1) return -1;
+    out[i] = (uint8_t)v;
+  }
+  return (int)(n / 2);
+}
+
+// [STX][CMD][SEQ][VER][LEN][SESS][CTR][ciphertext][tag][CRC][ETX] -> plaintext
+static int Open_Frame(uint8_t *f, int n, uint8_t *cmd, uint8_t *seq, uint8_t **text) {
+  if (n > 255 || FCS_Codec_Unframe(f, (uint8_t)n, 0) < 0) return -1;
+  int len = FCS_Codec_Open(f, FCS_CODEC_F_AEAD, dev_key, FCS_CODEC_DIR_TO_FCS);
+  if (len < 0) return -1;
+  *text = &f[4 + FCS_AEAD_HDR_SIZE];
+  *cmd = f[0];
+  *seq = f[1];
+  return len;
+}
+
+static int Run_Vectors(const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (fp == NULL) {
+    perror(path);
+    return -1;
+  }
+  static uint8_t v[6][MAX_FIELD];
+  int len[6];
+  char line[4096];
+  int count = 0, fails = 0;
+
+  while (fgets(line, sizeof(line), fp)) {
+    char *tok[8];
+    int nt = 0;
+    for (char *p = strtok(line, " \t\r\n"); p && nt < 8; p = strtok(NULL, " \t\r\n")) tok[nt++] = p;
+    if (nt == 0 || tok[0][0] == '#') continue;
+
+    int ok = 1;
+    for (int i = 1; i < nt && i <= 6; i++) {
+      len[i - 1] = Hex_Field(tok[i], v[i - 1]);
+      if (len[i - 1] < 0) len[i - 1] = 0;
+    }
+
+    if (strcmp(tok[0], "chacha20") == 0 && nt == 6) {
+      uint32_t ctr = (uint32_t)strtoul(tok[3], NULL, 10);
+      len[3] = Hex_Field(tok[4], v[3]);
+      len[4] = Hex_Field(tok[5], v[4]);
+      FCS_ChaCha20_Xor(v[0], v[1], ctr, v[3], (uint32_t)len[3]);
+      ok = (len[3] == len[4]) && memcmp(v[3], v[4], (size_t)len[3]) == 0;
+    } else if (strcmp(tok[0], "poly1305") == 0 && nt == 4) {
+      uint8_t tag[FCS_AEAD_TAG_SIZE];
+      FCS_Poly1305(v[0], v[1], (uint32_t)len[1], tag);
+      ok = memcmp(tag, v[2], FCS_AEAD_TAG_SIZE) == 0;
+    } else if (strcmp(tok[0], "aead") == 0 && nt == 7) {
+      uint8_t tag[FCS_AEAD_TAG_SIZE];
+      uint8_t pt[MAX_FIELD];
+      memcpy(pt, v[3], (size_t)len[3]);
+      FCS_AEAD_Seal(v[0], v[1], v[2], (uint32_t)len[2], v[3], (uint32_t)len[3], tag);
+      ok = (len[3] == len[4]) && memcmp(v[3], v[4], (size_t)len[3]) == 0 && memcmp(tag, v[5], FCS_AEAD_TAG_SIZE) == 0;
+      ok = ok && FCS_AEAD_Open(v[0], v[1], v[2], (uint32_t)len[2], v[3], (uint32_t)len[3], tag, FCS_AEAD_TAG_LEN) &&
+           memcmp(v[3], pt, (size_t)len[3]) == 0;
+    } else if (strcmp(tok[0], "frame") == 0 && nt == 7) {
+      uint8_t cmd = 0, seq = 0, *text = NULL;
+      len[4] = Hex_Field(tok[5], v[4]);
+      len[5] = Hex_Field(tok[6], v[5]);
+      int n = Open_Frame(v[5], len[5], &cmd, &seq, &text);
+      ok = n >= 0 && n == len[4] && cmd == (uint8_t)strtoul(tok[3], NULL, 16) &&
+           seq == (uint8_t)atoi(tok[4]) && memcmp(text, v[4], (size_t)n) == 0;
+    } else {
+      continue;
+    }
+    count++;
+    if (!ok) {
+      fails++;
+      printf("FAIL: %s vector %d\n", tok[0], count);
+    }
+  }
+  fclose(fp);
+  printf("Vectors: %d/%d passed\n", count - fails, count);
+  return fails;
+}
+
+static double Now_Ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void Run_Bench(void) {
+  static const uint32_t sizes[] = { 0, 8, 16, 32, 64, 104 }; // 104 = FCS_APP_MAX_PAYLOAD
+  const int iters = 200000;
+  uint8_t nonce[FCS_AEAD_NONCE_SIZE] = {0};
+  uint8_t aad[4] = { 0xA2, 0x01, FCS_AEAD_VERSION, 0 };
+  uint8_t ct[128], buf[128], tag[FCS_AEAD_TAG_SIZE];
+  double seal_at[2] = {0, 0};
+
+  printf("\nHost timing (not Cortex-M4 cycles)\n");
+  printf("%6s %15s %15s\n", "bytes", "seal ns/frame", "open ns/frame");
+  for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    uint32_t n = sizes[s];
+    aad[3] = (uint8_t)(n + FCS_AEAD_HDR_SIZE + FCS_AEAD_TAG_LEN);
+    memset(ct, 0x5A, sizeof(ct));
+
+    double t0 = Now_Ns();
+    for (int i = 0; i < iters; i++) {
+      memcpy(nonce, &i, sizeof(i));
+      FCS_AEAD_Seal(dev_key, nonce, aad, 4, ct, n, tag);
+    }
+    double t1 = Now_Ns();
+    int ok = 0;
+    for (int i = 0; i < iters; i++) {
+      memcpy(buf, ct, n);
+      ok += FCS_AEAD_Open(dev_key, nonce, aad, 4, buf, n, tag, FCS_AEAD_TAG_LEN);
+    }
+    double t2 = Now_Ns();
+
+    double seal = (t1 - t0) / iters;
+    double open = (t2 - t1) / iters;
+    if (ok != iters) printf("open failed %d/%d\n", iters - ok, iters);
+    printf("%6u %15.0f %15.0f\n", (unsigned)n, seal, open);
+    if (n == 64) seal_at[0] = seal;
+    if (n == 104) seal_at[1] = seal;
+  }
+  // Per-byte slope between two multi-block frames; the rest is the fixed part
+  double slope = (seal_at[1] - seal_at[0]) / (104 - 64);
+  printf("seal: %.2f ns/byte + %.0f ns/frame\n", slope, seal_at[1] - slope * 104);
+}
+
+int main(int argc, char **argv) {
+  const char *path = (argc > 1) ? argv[1] : "aead_vectors.txt";
+  int fails = Run_Vectors(path);
+  if (fails != 0) return 1;
+  Run_Bench();
+  return 0;
+}
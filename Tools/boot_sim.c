@@ -0,0 +1,295 @@
+// Host run of the boot sequencer (Core/Src/fcs_boot.c) under the scheduler
+// (Core/Src/fcs_sched.c) on a virtual clock, against modelled I2C devices.
+//
+//   gcc -O2 -Wall -I../Core/Inc boot_sim.c ../Core/Src/fcs_boot.c ../Core/Src/fcs_sched.c -o boot_sim
+//   ./boot_sim [nobmp|nolcd|slowlcd]
+//
+// The task table and boot lines mirror main.c; sched_sim.c covers the steady
+// state after boot. A client sends a fire request at power-on and retries
+// every RTO_MIN_MS (fcs_terminal.py) until one is answered; a byte that
+// arrives before FCS_Serial_Start is lost, so both boots answer a retry, not
+// the power-on request: the old one the first after ~1.6 s, the new one the
+// first at all (its link is up in ~1 ms). A second client polls every
+// POLL_MS during bring-up, to see how long the link waits on the devices.
+// The previous blocking boot (fixed HAL_Delays, splash) is modelled from its
+// delays and the same bus costs for comparison.
+//
+// Device and bus figures are estimates from the datasheets and the bus
+// traffic at 100 kHz (~90 us per byte), not measurements:
+//   MCU    reset -> main() peripherals configured        ~1 ms
+//   BMP280 t_startup after soft reset 2 ms, first conversion t_meas 6.4 ms
+//          after normal mode; reset write 0.3 ms, status read 0.4 ms,
+//          ID + calibration + config 3.7 ms, data read 0.8 ms
+//   OLED   address ACK LCD_ACK_MS after power-up ('slowlcd': 60 ms),
+//          init commands 27 x 3 bytes 7.3 ms, full push 100 ms
+//   SER    one request (parse + solve + reply)             ~400 us
+//
+// Checks (exit 1 on failure):
+// [1] The link is receiving before any device is waited for (FAIL_LINK_US).
+// [2] No request waits more than FAIL_WAIT_US while the devices come up.
+// [3] Present devices are up, absent ones failed, within their line timeout.
+// [4] No sensor read before the BMP280 is up, no push before the panel is.
+#include "fcs_boot.h"
+#include "fcs_sched.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MCU_START_US      1000
+#define BMP_STARTUP_US    2000
+#define BMP_TMEAS_US      6400
+#define COST_BMP_RST_US   300
+#define COST_BMP_STAT_US  400
+#define COST_BMP_CFG_US   3700
+#define COST_BMP_READ_US  800
+#define COST_ACK_US       100    // Address byte only (IsDeviceReady)
+#define COST_LCD_CFG_US   7300
+#define COST_LCD_US       100000
+#define COST_SER_US       400
+#define COST_KEY_US       60
+#define COST_LED_US       2
+#define LCD_ACK_MS        1
+#define LCD_ACK_SLOW_MS   60
+
+#define RTO_MIN_MS        300    // Client retry (fcs_terminal.py)
+#define POLL_MS           2      // Second client during bring-up
+#define RUN_US            2000000
+
+#define BOOT_BMP_TIMEOUT_MS 100  // As main.c
+#define BOOT_LCD_TIMEOUT_MS 100
+
+#define FAIL_LINK_US      5000
+#define FAIL_WAIT_US      10000
+
+static uint32_t v_now = 0;
+static uint32_t Sim_Now(void) { return v_now; }
+
+static int bmp_present = 1, lcd_present = 1;
+static uint32_t lcd_ack_us = LCD_ACK_MS * 1000U;
+
+// [Devices]
+static uint32_t bmp_ready_at = 0;   // NVM copied (after the soft reset)
+static uint32_t bmp_sample_at = 0;  // First conversion done
+static int bmp_up_model = 0, lcd_up_model = 0, violations = 0;
+
+// [Link] Requests lost before the UART is armed, else answered by the serial task
+static int link_armed = 0;
+static uint32_t link_up_us = 0;
+static uint32_t rto_at = 0, poll_at = 0;
+static uint32_t pending[64];        // Poll arrivals
+static int n_pending = 0, fire_pending = 0;
+static uint32_t first_fire_us = 0, wait_max_us = 0, boot_done_us = 0;
+static uint32_t polls_sent = 0, polls_lost = 0;
+static int lcd_dirty = 1;
+
+enum { TASK_SERIAL, TASK_KEYS, TASK_BOOT, TASK_SENSOR, TASK_DISPLAY, TASK_LED, TASK_COUNT };
+static FCS_Task_t tasks[TASK_COUNT];
+
+// [Boot Lines] As main.c, each step a bus transaction on the models
+static int8_t Boot_Bmp_Reset(void) {
+  v_now += COST_BMP_RST_US;
+  if (bmp_present) bmp_ready_at = v_now + BMP_STARTUP_US;
+  return FCS_STEP_DONE;
+}
+
+static int8_t Boot_Bmp_Ready(void) {
+  v_now += COST_BMP_STAT_US;
+  return (bmp_present && (int32_t)(v_now - bmp_ready_at) >= 0) ? FCS_STEP_DONE : FCS_STEP_WAIT;
+}
+
+static int8_t Boot_Bmp_Config(void) {
+  v_now += COST_BMP_CFG_US;
+  bmp_sample_at = v_now + BMP_TMEAS_US;
+  return FCS_STEP_DONE;
+}
+
+static int8_t Boot_Bmp_Sample(void) {
+  v_now += COST_BMP_READ_US;
+  if ((int32_t)(v_now - bmp_sample_at) < 0) return FCS_STEP_WAIT;
+  bmp_up_model = 1;
+  return FCS_STEP_DONE;
+}
+
+static int8_t Boot_Lcd_Ready(void) {
+  v_now += COST_ACK_US;
+  return (lcd_present && v_now >= lcd_ack_us) ? FCS_STEP_DONE : FCS_STEP_WAIT;
+}
+
+static int8_t Boot_Lcd_Config(void) {
+  v_now += COST_LCD_CFG_US;
+  lcd_up_model = 1;
+  return FCS_STEP_DONE;
+}
+
+static const FCS_BootStep_t boot_bmp[] = { Boot_Bmp_Reset, Boot_Bmp_Ready, Boot_Bmp_Config, Boot_Bmp_Sample };
+static const FCS_BootStep_t boot_lcd[] = { Boot_Lcd_Ready, Boot_Lcd_Config };
+
+enum { BOOT_BMP, BOOT_LCD, BOOT_COUNT };
+
+static FCS_BootLine_t boot_lines[BOOT_COUNT] = {
+  [BOOT_BMP] = FCS_BOOT_LINE("BMP280", boot_bmp, BOOT_BMP_TIMEOUT_MS),
+  [BOOT_LCD] = FCS_BOOT_LINE("OLED", boot_lcd, BOOT_LCD_TIMEOUT_MS),
+};
+
+// [Tasks] As main.c
+static void Task_Serial(void) {
+  for (int i = 0; i < n_pending; i++) {
+    v_now += COST_SER_US;
+    uint32_t wait = v_now - pending[i];
+    if (!boot_done_us && wait > wait_max_us) wait_max_us = wait;
+  }
+  n_pending = 0;
+  if (fire_pending) {
+    v_now += COST_SER_US;
+    first_fire_us = v_now;
+    fire_pending = 0;
+  }
+  FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+}
+
+static void Task_Keys(void) { v_now += COST_KEY_US; }
+
+static void Task_Boot(void) {
+  if (!FCS_Boot_Poll()) return;
+  if (!boot_done_us) boot_done_us = v_now;
+  FCS_Sched_Set_Period(&tasks[TASK_BOOT], 0);
+  FCS_Sched_Signal(&tasks[TASK_SENSOR]);
+  FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+}
+
+static void Task_Sensor(void) {
+  if (!FCS_Boot_Up(BOOT_BMP)) return;
+  if (!bmp_up_model) violations++;
+  v_now += COST_BMP_READ_US;
+}
+
+static void Task_Display(void) {
+  if (!FCS_Boot_Done_Us() || !FCS_Boot_Up(BOOT_LCD)) return;
+  if (!lcd_up_model) violations++;
+  if (!lcd_dirty) return;
+  lcd_dirty = 0;
+  v_now += COST_LCD_US;
+}
+
+static void Task_Led(void) { v_now += COST_LED_US; }
+
+// [Client] Fire request at power-on and every RTO_MIN_MS until answered;
+// the polling client only while the devices come up
+static uint32_t Next_Arrival(void) {
+  uint32_t next = first_fire_us ? UINT32_MAX : rto_at;
+  if (!boot_done_us && poll_at < next) next = poll_at;
+  return next;
+}
+
+static int Link_Catches(uint32_t sent_at) {
+  return link_armed && (int32_t)(sent_at - link_up_us) >= 0;
+}
+
+static void Deliver(void) {
+  int got = 0;
+  while (!first_fire_us && !fire_pending && (int32_t)(v_now - rto_at) >= 0) {
+    if (Link_Catches(rto_at)) fire_pending = got = 1;
+    rto_at += RTO_MIN_MS * 1000U;
+  }
+  while (!boot_done_us && (int32_t)(v_now - poll_at) >= 0) {
+    polls_sent++;
+    if (Link_Catches(poll_at)) pending[n_pending++] = poll_at, got = 1;
+    else polls_lost++;
+    poll_at += POLL_MS * 1000U;
+  }
+  if (got) FCS_Sched_Signal(&tasks[TASK_SERIAL]);
+}
+
+// Previous boot: every step blocking, serial started last
+static void Old_Boot(void) {
+  uint32_t t = MCU_START_US;
+  t += 100000;                                            // HAL_Delay(100)
+  t += 100000 + COST_LCD_CFG_US + COST_LCD_US;            // ssd1306_Init: boot wait, commands, blank push
+  t += 100000;                                            // HAL_Delay(100)
+  t += COST_BMP_RST_US + 100000 + COST_BMP_CFG_US;        // BMP280_Init: reset, blind wait, configure
+  t += COST_LCD_US + 1000000;                             // UI_Init: splash push, BOOT_DELAY_MS
+  uint32_t fire = 0;
+  while (fire < t) fire += RTO_MIN_MS * 1000U;            // First retry the armed UART catches
+  printf("Old boot:  link %7.1f ms, devices %7.1f ms, first fire %7.1f ms\n", t / 1000.0, t / 1000.0,
+         (fire + COST_SER_US) / 1000.0);
+}
+
+int main(int argc, char **argv) {
+  const char *mode = (argc > 1) ? argv[1] : "";
+  bmp_present = strcmp(mode, "nobmp") != 0;
+  lcd_present = strcmp(mode, "nolcd") != 0;
+  if (strcmp(mode, "slowlcd") == 0) lcd_ack_us = LCD_ACK_SLOW_MS * 1000U;
+
+  printf("Boot model%s%s (estimates, not measured on hardware)\n", *mode ? ": " : "", mode);
+  Old_Boot();
+
+  // main(): peripherals, FCS_Init_System/UI_Init (RAM only), serial start, then the sequencer
+  v_now = MCU_START_US;
+  link_armed = 1;
+  link_up_us = v_now;
+  FCS_Task_t table[TASK_COUNT] = {
+    [TASK_SERIAL]  = FCS_TASK("SER", Task_Serial, FCS_TASK_SERIAL_MS, 20),
+    [TASK_KEYS]    = FCS_TASK("KEY", Task_Keys, FCS_TASK_KEYS_MS, 0),
+    [TASK_BOOT]    = FCS_TASK("BOOT", Task_Boot, FCS_BOOT_POLL_MS, 0),
+    [TASK_SENSOR]  = FCS_TASK("BMP", Task_Sensor, FCS_TASK_SENSOR_MS, 0),
+    [TASK_DISPLAY] = FCS_TASK("LCD", Task_Display, FCS_TASK_DISPLAY_MS, 0),
+    [TASK_LED]     = FCS_TASK("LED", Task_Led, FCS_TASK_LED_MS, 0),
+  };
+  memcpy(tasks, table, sizeof(table));
+  uint32_t boot_start = v_now;
+  FCS_Boot_Init(boot_lines, BOOT_COUNT, Sim_Now);
+  FCS_Sched_Init(tasks, TASK_COUNT, Sim_Now);
+
+  while (v_now < RUN_US) {
+    FCS_Sched_Run();
+    Deliver(); // Arrived while a task ran
+    uint32_t idle = FCS_Sched_Idle_Us();
+    if (idle == 0) continue;
+    // Tickless WFI as sched_sim.c: next tick boundary at or after the release, or an RX interrupt
+    uint32_t tick0 = v_now - v_now % 1000U;
+    uint32_t ticks = (v_now - tick0 + (idle > 199000U ? 199000U : idle) + 999U) / 1000U;
+    uint32_t wake = tick0 + (ticks < 2 ? 1 : ticks) * 1000U;
+    uint32_t rx = Next_Arrival();
+    if (rx < wake) wake = rx;
+    if ((int32_t)(wake - v_now) > 0) v_now = wake;
+    Deliver();
+  }
+
+  printf("New boot:  link %7.1f ms, devices %7.1f ms, first fire %7.1f ms\n", link_up_us / 1000.0,
+         boot_done_us / 1000.0, first_fire_us / 1000.0);
+  int fail = 0;
+  for (int i = 0; i < BOOT_COUNT; i++) {
+    const FCS_BootLine_t *l = &boot_lines[i];
+    int present = (i == BOOT_BMP) ? bmp_present : lcd_present;
+    printf("  %-7s %-6s at %6.1f ms\n", l->name, FCS_Boot_Up((uint8_t)i) ? "up" : "FAILED",
+           (boot_start + l->end_us) / 1000.0);
+    if (FCS_Boot_Up((uint8_t)i) != present) {
+      printf("FAIL [3]: %s should be %s\n", l->name, present ? "up" : "failed");
+      fail = 1;
+    }
+    if (l->end_us > l->timeout_ms * 1000U + COST_LCD_CFG_US) {
+      printf("FAIL [3]: %s settled after its %u ms timeout\n", l->name, (unsigned)l->timeout_ms);
+      fail = 1;
+    }
+  }
+  printf("  Polls during bring-up: %u sent, %u lost, worst wait %.1f ms\n", (unsigned)polls_sent,
+         (unsigned)polls_lost, wait_max_us / 1000.0);
+
+  if (link_up_us > FAIL_LINK_US) {
+    printf("FAIL [1]: link up at %u us\n", (unsigned)link_up_us);
+    fail = 1;
+  }
+  if (wait_max_us > FAIL_WAIT_US) {
+    printf("FAIL [2]: a request waited %u us on the bring-up\n", (unsigned)wait_max_us);
+    fail = 1;
+  }
+  if (violations) {
+    printf("FAIL [4]: %d device accesses before the device was up\n", violations);
+    fail = 1;
+  }
+  if (!first_fire_us) {
+    printf("FAIL: no fire request answered\n");
+    fail = 1;
+  }
+  return fail;
+}
@@ -0,0 +1,174 @@
+// Host run of the clock governor (Core/Src/fcs_clock.c) on a virtual clock,
+// through a scripted session.
+//
+//   gcc -O2 -Wall -DFCS_CLOCK_HOST -I../Core/Inc clock_sim.c ../Core/Src/fcs_clock.c -o clock_sim
+//   ./clock_sim
+//
+// The loop follows main.c: a pass runs what is due (a request boosts first,
+// as Task_Serial), then FCS_Clock_Idle with main.c's condition, then sleeps
+// until the next event. Session:
+//     0-10 s   operator at the keys (UI_BP_SETTING, key scan running)
+//    10-60 s   idle screen; a mission burst at 20 s (3 requests 300 ms
+//              apart) and a single one at 40 s
+//    60-70 s   link raised to 921600 baud, a request every 500 ms
+//    70-120 s  idle screen at 9600 again
+// Sensor reads (1 s) and panel pushes (200 ms) run throughout.
+//
+// Work costs are estimates at 84 MHz, not measured on hardware: core-bound
+// work takes 84/16 as long at SLOW, I2C-bound work does not change.
+//   SER   one request (parse + solve + reply)    ~400 us core
+//   BMP   data read                               ~800 us I2C
+//   LCD   full push                               100 ms I2C
+//   KEY   one scan                                ~60 us core
+//   PLL   lock + VOS ready on the way to FAST     ~200 us
+//
+// Checks (exit 1 on failure):
+// [1] Every request is parsed and solved at FAST.
+// [2] Never SLOW while main.c's condition is false, nor before it has held
+//     for FCS_CLOCK_HOLD_MS.
+// [3] Every idle window longer than the hold ends up at SLOW.
+// [4] Residency adds up to the run time; switches stay bounded.
+#include "fcs_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define COST_SER_US      400
+#define COST_BMP_US      800
+#define COST_LCD_US      100000
+#define COST_KEY_US      60
+#define COST_PLL_US      200
+
+#define SENSOR_MS        1000
+#define DISPLAY_MS       200
+#define KEYS_MS          10
+#define RUN_US           120000000U
+
+#define SLOW_FACTOR_X100 525   // 84 / 16
+
+static uint32_t v_now = 0;
+static uint32_t Sim_Now(void) { return v_now; }
+
+typedef struct {
+  uint32_t from_us, to_us;
+  uint8_t keys;     // Operator at the keys (not UI_WAITING, scan running)
+  uint8_t raised;   // Link above FCS_BAUD_DEFAULT
+} Phase_t;
+
+static const Phase_t phases[] = {
+  {        0U,  10000000U, 1, 0 },
+  { 10000000U,  60000000U, 0, 0 },
+  { 60000000U,  70000000U, 0, 1 },
+  { 70000000U, 120000000U, 0, 0 },
+};
+#define PHASE_COUNT (sizeof(phases) / sizeof(phases[0]))
+
+static uint32_t requests[] = {
+  20000000U, 20300000U, 20600000U, 40000000U,
+  60500000U, 61000000U, 61500000U, 62000000U, 62500000U, 63000000U, 63500000U,
+  64000000U, 64500000U, 65000000U, 65500000U, 66000000U, 66500000U, 67000000U,
+  67500000U, 68000000U, 68500000U, 69000000U, 69500000U,
+};
+#define REQ_COUNT (sizeof(requests) / sizeof(requests[0]))
+
+static const Phase_t *Phase_At(uint32_t t) {
+  for (unsigned i = 0; i < PHASE_COUNT; i++) {
+    if (t >= phases[i].from_us && t < phases[i].to_us) return &phases[i];
+  }
+  return &phases[PHASE_COUNT - 1];
+}
+
+static int fails = 0;
+static void Fail(const char *what, uint32_t t) {
+  if (fails++ < 10) printf("FAIL %s at %.3f s\n", what, t / 1e6);
+}
+
+static uint32_t Core_Cost(uint32_t us) {
+  return (FCS_Clock_State() == FCS_CLK_SLOW) ? us * SLOW_FACTOR_X100 / 100U : us;
+}
+
+int main(void) {
+  FCS_Clock_Init(Sim_Now);
+  uint32_t next_sensor = 0, next_display = 0, next_keys = 0;
+  unsigned next_req = 0;
+  uint32_t lat_max = 0, lat_sum = 0;
+  uint32_t last_demand = 0;            // Last boost, or last pass with the condition false
+  FCS_ClkState_t was = FCS_CLK_FAST;
+
+  while (v_now < RUN_US) {
+    const Phase_t *ph = Phase_At(v_now);
+
+    // [Pass] Requests first (SER has the highest priority)
+    uint8_t served = 0;
+    while (next_req < REQ_COUNT && requests[next_req] <= v_now) {
+      FCS_ClkState_t before = FCS_Clock_State();
+      FCS_Clock_Boost();
+      last_demand = v_now;
+      if (before == FCS_CLK_SLOW) v_now += COST_PLL_US;
+      if (FCS_Clock_State() != FCS_CLK_FAST) Fail("request solved at SLOW", v_now);
+      v_now += Core_Cost(COST_SER_US);
+      uint32_t lat = v_now - requests[next_req];
+      if (lat > lat_max) lat_max = lat;
+      lat_sum += lat;
+      next_req++;
+      served = 1;
+    }
+    if (ph->keys && v_now >= next_keys) {
+      v_now += Core_Cost(COST_KEY_US);
+      next_keys += KEYS_MS * 1000U;
+    }
+    if (v_now >= next_sensor) {
+      v_now += COST_BMP_US;
+      next_sensor += SENSOR_MS * 1000U;
+    }
+    if (v_now >= next_display || served) {
+      v_now += COST_LCD_US;
+      next_display = v_now + DISPLAY_MS * 1000U;
+    }
+
+    // [Governor] main.c: UI_WAITING, keys idle, boot done, default baud, nothing queued
+    ph = Phase_At(v_now);
+    uint8_t may_slow = !ph->keys && !ph->raised;
+    if (!may_slow) last_demand = v_now;
+    FCS_Clock_Idle(may_slow);
+
+    FCS_ClkState_t now_state = FCS_Clock_State();
+    if (now_state == FCS_CLK_SLOW) {
+      if (!may_slow) Fail("SLOW while not allowed", v_now);
+      if (was == FCS_CLK_FAST && v_now - last_demand < FCS_CLOCK_HOLD_MS * 1000U) Fail("SLOW before the hold", v_now);
+    }
+    was = now_state;
+
+    // [Sleep] Until the next event
+    uint32_t wake = next_sensor;
+    if (next_display < wake) wake = next_display;
+    if (ph->keys && next_keys < wake) wake = next_keys;
+    if (next_req < REQ_COUNT && requests[next_req] < wake) wake = requests[next_req];
+    for (unsigned i = 0; i < PHASE_COUNT; i++) {
+      if (phases[i].from_us > v_now && phases[i].from_us < wake) wake = phases[i].from_us;
+    }
+    if (wake > v_now) v_now = wake;
+
+    // [3] An idle window longer than the hold (plus a display period for the pass
+    // that sees it) is at SLOW by now
+    ph = Phase_At(v_now);
+    if (may_slow && !ph->keys && !ph->raised && FCS_Clock_State() != FCS_CLK_SLOW &&
+        v_now - last_demand > FCS_CLOCK_HOLD_MS * 1000U + (DISPLAY_MS + COST_LCD_US / 1000U) * 1000U) {
+      Fail("idle window still at FAST", v_now);
+    }
+  }
+
+  FCS_ClkStats_t st;
+  FCS_Clock_Stats(&st);
+  uint32_t total = st.ms[FCS_CLK_FAST] + st.ms[FCS_CLK_SLOW];
+  uint32_t run_ms = v_now / 1000U;
+  if (total + 1 < run_ms || total > run_ms) Fail("residency does not add up", v_now);
+  if (st.switches > 2U * (REQ_COUNT + PHASE_COUNT)) Fail("too many switches", v_now);
+
+  printf("Clock governor, %u s session (model, not measured on hardware)\n", run_ms / 1000U);
+  printf("  FAST 84 MHz  %7.1f s  %5.1f %%\n", st.ms[FCS_CLK_FAST] / 1000.0, st.ms[FCS_CLK_FAST] * 100.0 / total);
+  printf("  SLOW 16 MHz  %7.1f s  %5.1f %%\n", st.ms[FCS_CLK_SLOW] / 1000.0, st.ms[FCS_CLK_SLOW] * 100.0 / total);
+  printf("  switches %u, requests %u: latency mean %u us, max %u us\n", st.switches, (unsigned)REQ_COUNT,
+         lat_sum / (unsigned)REQ_COUNT, lat_max);
+  printf(fails ? "FAILED (%d)\n" : "ok\n", fails);
+  return fails ? 1 : 0;
+}
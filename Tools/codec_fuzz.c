@@ -0,0 +1,284 @@
+// Host fuzz of frame resynchronisation (Core/Src/fcs_codec.c): frames lost
+// per injected byte error, for both framings.
+//
+//   gcc -O2 -Wall -I../Core/Inc codec_fuzz.c ../Core/Src/fcs_codec.c ../Core/Src/fcs_aead.c -o codec_fuzz
+//   ./codec_fuzz [seeds]
+//
+// Each stream is 100 frames (random CMD, payload 0..32 random bytes, XOR
+// sealed as the client does) with 1 or 5 errors of one kind at random
+// positions: a flipped bit, a dropped byte or an inserted random byte.
+// Three receivers read it:
+//   STX drop    STX/ETX; a candidate that fails FCS_Codec_Unframe is dropped
+//               whole and the hunt for STX goes on after it (the firmware
+//               parser before Proto_Resync)
+//   STX resync  the same, but the hunt goes on from the byte after the
+//               failed STX (Proto_Resync in fcs_core.c)
+//   COBS        every 0x00 ends a span, each span goes to FCS_Codec_Unframe
+// A frame counts as received if a receiver returns its exact body.
+//
+// Checks (exit 1 on failure):
+// [1] Clean streams: every frame received by every receiver.
+// [2] STX resync accepts exactly the frames FCS_Codec_Scan finds.
+// [3] COBS: a single error costs at most two frames (one that hits a
+//     delimiter merges its neighbours).
+// [4] STX resync and COBS lose fewer frames per error than STX drop, and
+//     bodies that were never sent are accepted at most once per 256 errors
+//     (the CRC8 rate for one damaged candidate per error).
+// Figures are from the model, not measured on hardware.
+#include "fcs_codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAMES         100
+#define MAX_PAYLOAD    32
+#define SEEDS          2000
+#define STREAM_MAX     (FRAMES * (FCS_PROTO_OVERHEAD + MAX_PAYLOAD + 2) + 16)
+
+enum { RX_DROP, RX_RESYNC, RX_COBS, RX_COUNT };
+enum { ERR_FLIP, ERR_DROP, ERR_INSERT, ERR_KINDS };
+static const char *const rx_name[RX_COUNT] = { "STX drop", "STX resync", "COBS" };
+static const char *const err_name[ERR_KINDS] = { "bit flip", "dropped byte", "inserted byte" };
+
+static int fails = 0;
+static void Fail(const char *what, unsigned seed) {
+  if (fails++ < 10) printf("FAIL %s (seed %u)\n", what, seed);
+}
+
+static uint32_t rng = 0x12345678U;
+static uint32_t Rand(void) {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+// [Stream]
+static uint8_t sent[FRAMES][FCS_PROTO_BODY_MAX];
+static uint8_t sent_len[FRAMES];
+static uint8_t got[FRAMES];
+static unsigned n_false = 0;       // Accepted bodies that were never sent
+
+static uint32_t Stream_Build(uint8_t *out, uint8_t cobs) {
+  uint32_t n = 0;
+  for (unsigned k = 0; k < FRAMES; k++) {
+    uint8_t buf[FCS_PROTO_BODY_MAX + 3];
+    uint8_t len = (uint8_t)(Rand() % (MAX_PAYLOAD + 1));
+    buf[1] = (uint8_t)(0xA0 + Rand() % 0x40);
+    buf[2] = (uint8_t)k;
+    buf[3] = (uint8_t)Rand(); // Salt
+    buf[4] = len;
+    for (unsigned i = 0; i < len; i++) buf[5 + i] = (uint8_t)Rand();
+    FCS_Codec_Seal(&buf[1], cobs ? FCS_CODEC_F_COBS : 0, NULL, 0, 0, FCS_CODEC_DIR_TO_FCS);
+    sent_len[k] = (uint8_t)(5 + len);
+    uint8_t w = FCS_Codec_Frame(buf, cobs ? FCS_CODEC_F_COBS : 0);
+    if (!cobs) memcpy(sent[k], &buf[1], sent_len[k]); // Body with its CRC
+    memcpy(&out[n], buf, w);
+    n += w;
+    if (cobs) {
+      uint8_t tmp[FCS_PROTO_BODY_MAX + 3];
+      memcpy(tmp, buf, w - 1);
+      FCS_Codec_Cobs_Decode(tmp, (uint8_t)(w - 1));
+      memcpy(sent[k], tmp, sent_len[k]);
+    }
+  }
+  return n;
+}
+
+// 'count' errors of one kind at random positions. Returns: new length
+static uint32_t Stream_Damage(uint8_t *s, uint32_t n, unsigned kind, unsigned count) {
+  for (unsigned e = 0; e < count; e++) {
+    uint32_t p = Rand() % n;
+    if (kind == ERR_FLIP) {
+      s[p] ^= (uint8_t)(1U << (Rand() % 8));
+    } else if (kind == ERR_DROP) {
+      memmove(&s[p], &s[p + 1], n - p - 1);
+      n--;
+    } else {
+      memmove(&s[p + 1], &s[p], n - p);
+      s[p] = (uint8_t)Rand();
+      n++;
+    }
+  }
+  return n;
+}
+
+static void Accept(const uint8_t *body, int len) {
+  for (unsigned k = 0; k < FRAMES; k++) {
+    if (sent_len[k] == len && memcmp(sent[k], body, (size_t)len) == 0) {
+      got[k] = 1;
+      return;
+    }
+  }
+  n_false++;
+}
+
+// [Receivers]
+static void Rx_Stx(const uint8_t *s, uint32_t n, uint8_t resync) {
+  uint32_t i = 0;
+  while (i < n) {
+    if (s[i] != FCS_PROTO_STX) {
+      i++;
+      continue;
+    }
+    if (n - i < 5) break;
+    uint32_t total = FCS_PROTO_OVERHEAD + s[i + 4];
+    uint8_t cand[FCS_PROTO_OVERHEAD + PROTO_MAX_PAYLOAD];
+    if (s[i + 4] > PROTO_MAX_PAYLOAD) {
+      i += resync ? 1 : 5; // The old parser had taken STX..LEN
+      continue;
+    }
+    if (n - i < total) {
+      // Stalls at the end of the stream until PARSER_TIMEOUT_MS
+      if (!resync) break;
+      i++;
+      continue;
+    }
+    memcpy(cand, &s[i], total);
+    int len = FCS_Codec_Unframe(cand, (uint8_t)total, 0);
+    if (len > 0) {
+      Accept(cand, len);
+      i += total;
+    } else {
+      i += resync ? 1 : total;
+    }
+  }
+}
+
+static void Rx_Cobs(const uint8_t *s, uint32_t n) {
+  uint32_t from = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    if (s[i] != 0x00) continue;
+    uint32_t span = i - from;
+    if (span > 0 && span <= FCS_PROTO_OVERHEAD - 1 + PROTO_MAX_PAYLOAD) {
+      uint8_t cand[FCS_PROTO_OVERHEAD + PROTO_MAX_PAYLOAD];
+      memcpy(cand, &s[from], span);
+      int len = FCS_Codec_Unframe(cand, (uint8_t)span, FCS_CODEC_F_COBS);
+      if (len > 0) Accept(cand, len);
+    }
+    from = i + 1;
+  }
+}
+
+// [2] What FCS_Codec_Scan finds in the stream. A candidate that still waits
+// for bytes at the end is given up from its next byte, as the firmware does
+// on PARSER_TIMEOUT_MS.
+static unsigned Scan_Frames(const uint8_t *s, uint32_t n, uint8_t *found) {
+  uint32_t at = 0, start;
+  unsigned count = 0;
+  memset(found, 0, FRAMES);
+  while (at < n) {
+    uint32_t len = FCS_Codec_Scan(&s[at], n - at, &start);
+    if (len == 0) {
+      at += start + 1;
+      continue;
+    }
+    uint8_t cand[FCS_PROTO_OVERHEAD + PROTO_MAX_PAYLOAD];
+    memcpy(cand, &s[at + start], len);
+    int body = FCS_Codec_Unframe(cand, (uint8_t)len, 0);
+    for (unsigned k = 0; k < FRAMES && body > 0; k++) {
+      if (sent_len[k] == body && memcmp(sent[k], cand, (size_t)body) == 0) found[k] = 1;
+    }
+    count++;
+    at += start + len;
+  }
+  return count;
+}
+
+typedef struct {
+  unsigned long lost, errors, worst;
+} Tally_t;
+
+int main(int argc, char **argv) {
+  unsigned seeds = (argc > 1) ? (unsigned)atoi(argv[1]) : SEEDS;
+  if (seeds == 0) seeds = SEEDS;
+  static const unsigned per_stream[] = { 1, 5 };
+  static uint8_t stream[STREAM_MAX];
+  Tally_t t[2][ERR_KINDS][RX_COUNT];
+  unsigned long false_accepts[RX_COUNT] = { 0 };
+  memset(t, 0, sizeof(t));
+
+  for (unsigned seed = 0; seed < seeds; seed++) {
+    for (unsigned rx = 0; rx < RX_COUNT; rx++) {
+      // [1]
+      rng = seed * 2654435761U + 1U;
+      uint8_t cobs = (rx == RX_COBS);
+      uint32_t n = Stream_Build(stream, cobs);
+      memset(got, 0, sizeof(got));
+      n_false = 0;
+      if (cobs) Rx_Cobs(stream, n);
+      else Rx_Stx(stream, n, rx == RX_RESYNC);
+      for (unsigned k = 0; k < FRAMES; k++) {
+        if (!got[k]) Fail("frame lost from a clean stream", seed);
+      }
+      if (n_false) Fail("clean stream gave a body never sent", seed);
+
+      for (unsigned m = 0; m < 2; m++) {
+        for (unsigned kind = 0; kind < ERR_KINDS; kind++) {
+          rng = (seed * 2654435761U) ^ (m * 97U + kind * 13U + 7U);
+          n = Stream_Build(stream, cobs);
+          n = Stream_Damage(stream, n, kind, per_stream[m]);
+          memset(got, 0, sizeof(got));
+          n_false = 0;
+          if (cobs) Rx_Cobs(stream, n);
+          else Rx_Stx(stream, n, rx == RX_RESYNC);
+
+          unsigned lost = 0;
+          for (unsigned k = 0; k < FRAMES; k++) lost += !got[k];
+          Tally_t *x = &t[m][kind][rx];
+          x->lost += lost;
+          x->errors += per_stream[m];
+          if (lost > x->worst) x->worst = lost;
+          false_accepts[rx] += n_false;
+
+          // [2]
+          if (rx == RX_RESYNC) {
+            uint8_t found[FRAMES];
+            unsigned count = Scan_Frames(stream, n, found);
+            if (memcmp(found, got, FRAMES) != 0 || count != FRAMES - lost + n_false) {
+              Fail("receiver and FCS_Codec_Scan disagree", seed);
+            }
+          }
+          // [3]
+          if (rx == RX_COBS && per_stream[m] == 1 && lost > 2) Fail("one error cost COBS more than two frames", seed);
+        }
+      }
+    }
+  }
+
+  printf("Frames lost per injected error, %u-frame streams x %u seeds (model, not measured on hardware)\n", FRAMES,
+         seeds);
+  printf("  %-8s %-14s %12s %12s %12s\n", "errors", "kind", rx_name[0], rx_name[1], rx_name[2]);
+  double mean[2][RX_COUNT] = { { 0 } };
+  for (unsigned m = 0; m < 2; m++) {
+    for (unsigned kind = 0; kind < ERR_KINDS; kind++) {
+      printf("  %u/%-6u %-14s", per_stream[m], FRAMES, err_name[kind]);
+      for (unsigned rx = 0; rx < RX_COUNT; rx++) {
+        const Tally_t *x = &t[m][kind][rx];
+        double per = (double)x->lost / x->errors;
+        mean[m][rx] += per / ERR_KINDS;
+        printf("  %5.2f (%3lu)", per, x->worst);
+      }
+      printf("\n");
+    }
+    printf("  %u/%-6u %-14s", per_stream[m], FRAMES, "mean");
+    for (unsigned rx = 0; rx < RX_COUNT; rx++) printf("  %5.2f      ", mean[m][rx]);
+    printf("\n");
+  }
+  printf("  (worst frames lost in one stream in brackets)\n");
+  printf("  bodies accepted that were never sent: %lu / %lu / %lu\n", false_accepts[0], false_accepts[1],
+         false_accepts[2]);
+
+  // [4]
+  for (unsigned m = 0; m < 2; m++) {
+    if (mean[m][RX_RESYNC] >= mean[m][RX_DROP]) Fail("STX resync no better than drop", 0);
+    if (mean[m][RX_COBS] >= mean[m][RX_DROP]) Fail("COBS no better than STX drop", 0);
+  }
+  for (unsigned rx = 0; rx < RX_COUNT; rx++) {
+    unsigned long errors = 0;
+    for (unsigned m = 0; m < 2; m++) {
+      for (unsigned kind = 0; kind < ERR_KINDS; kind++) errors += t[m][kind][rx].errors;
+    }
+    if (false_accepts[rx] * 256UL > errors) Fail("too many bodies accepted that were never sent", 0);
+  }
+  printf(fails ? "FAILED (%d)\n" : "ok\n", fails);
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+# ==============================================================================
+# Decoder for the firmware's deferred debug log (Core/Inc/fcs_log.h)
+# ==============================================================================
+# USART2 carries binary records [0xA5][id lo][id hi][n][n x u32 LE]. The ID is
+# the offset of the format string in the ELF's .fcs_logstr section, which is
+# kept in the ELF but never loaded to flash. This reads that section (plain
+# struct parsing, no dependencies) and prints the text.
+#
+#   python3 fcs_logdec.py Debug/FCS.elf /dev/ttyACM0 [baud]   # live (pyserial)
+#   python3 fcs_logdec.py Debug/FCS.elf capture.bin           # raw capture
+#
+# Use the ELF of the running build: IDs change whenever a format string does.
+# A byte that does not start a known record is skipped, so the decoder picks
+# up mid-stream and after line noise.
+import os
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+ID_DROPPED = 0xFFFF
+MAX_ARGS = 6  # FCS_LOG_MAX_ARGS
+
+CONV = re.compile(r"%([-+ 0#]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diouxXc%])")
+
+
+def load_strings(elf_path):
+    """Return {offset: format string} from the .fcs_logstr section."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] not in (1, 2):
+        raise ValueError("%s: not an ELF file" % elf_path)
+    end = "<" if elf[5] == 1 else ">"
+    wide = elf[4] == 2  # ELF64: host builds of the logger
+    shoff, = struct.unpack_from(end + ("Q" if wide else "I"), elf, 0x28 if wide else 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x3A if wide else 0x2E)
+
+    def section(i):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from(end + ("IIQQQQ" if wide else "IIIIII"), elf, shoff + i * shentsize)
+
+    names_off = section(shstrndx)[4]
+    for i in range(shnum):
+        name, _, _, _, off, size = section(i)
+        sname = elf[names_off + name:elf.index(b"\0", names_off + name)].decode()
+        if sname == ".fcs_logstr":
+            data = elf[off:off + size]
+            break
+    else:
+        raise ValueError("%s: no .fcs_logstr section (FCS_LOG_DEFERRED=0 build?)" % elf_path)
+
+    strings, pos = {}, 0
+    while pos < len(data):
+        nul = data.find(b"\0", pos)
+        if nul < 0:
+            break
+        if nul > pos:
+            strings[pos] = data[pos:nul].decode("utf-8", "replace")
+        pos = nul + 1
+    return strings
+
+
+def arg_count(fmt):
+    return sum(1 for m in CONV.finditer(fmt) if m.group(2) != "%")
+
+
+def format_record(fmt, args):
+    """printf subset of the firmware: 32-bit integer and char conversions."""
+    vals = iter(args)
+
+    def conv(m):
+        flags, kind = m.group(1), m.group(2)
+        if kind == "%":
+            return "%"
+        v = next(vals)
+        if kind in "di":
+            v = struct.unpack("<i", struct.pack("<I", v))[0]
+            kind = "d"
+        elif kind == "c":
+            return chr(v & 0xFF)
+        return ("%" + flags + kind) % v
+
+    return CONV.sub(conv, fmt)
+
+
+class Decoder:
+    def __init__(self, strings):
+        self.strings = strings
+        self.counts = {k: arg_count(v) for k, v in strings.items()}
+        self.buf = bytearray()
+        self.skipped = 0
+
+    def feed(self, data):
+        """Yield one decoded line per complete record in data."""
+        self.buf += data
+        while len(self.buf) >= 4:
+            if self.buf[0] != SYNC:
+                del self.buf[0]
+                self.skipped += 1
+                continue
+            rid = self.buf[1] | (self.buf[2] << 8)
+            n = self.buf[3]
+            want = 1 if rid == ID_DROPPED else self.counts.get(rid)
+            if want is None or n != want or n > MAX_ARGS:
+                del self.buf[0]  # Not a record start: resync
+                self.skipped += 1
+                continue
+            size = 4 + 4 * n
+            if len(self.buf) < size:
+                break
+            args = struct.unpack_from("<%dI" % n, self.buf, 4)
+            del self.buf[:size]
+            if rid == ID_DROPPED:
+                yield "[LOG] %u records dropped (ring full)" % args[0]
+            else:
+                yield format_record(self.strings[rid], args).strip("\r\n")
+
+
+def main(argv):
+    if len(argv) < 3:
+        print("usage: fcs_logdec.py <elf> <port|capture> [baud]", file=sys.stderr)
+        return 2
+    dec = Decoder(load_strings(argv[1]))
+    src = argv[2]
+    if os.path.isfile(src):
+        with open(src, "rb") as f:
+            for line in dec.feed(f.read()):
+                print(line)
+    else:
+        import serial
+        baud = int(argv[3]) if len(argv) > 3 else 9600  # USART2 default
+        with serial.Serial(src, baud, timeout=0.1) as port:
+            try:
+                while True:
+                    for line in dec.feed(port.read(256)):
+                        print(line, flush=True)
+            except KeyboardInterrupt:
+                pass
+    if dec.skipped:
+        print("(%d bytes skipped while resyncing)" % dec.skipped, file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
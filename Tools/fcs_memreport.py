@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+# ==============================================================================
+# Build-time RAM reports: worst-case stack per call chain, static RAM per module
+# ==============================================================================
+# stack: rolls the per-function frames of -fstack-usage up the call graph of
+#        -fcallgraph-info=su (GCC 10+). Add both to the compiler flags
+#        (CubeIDE: C/C++ Build > Settings > MCU GCC Compiler > Miscellaneous);
+#        every object then gets a .su and a .ci next to it.
+# ram:   .data and .bss per object file, from nm -S (no flags needed).
+#
+#   python3 fcs_memreport.py stack Debug [--ld STM32F401RETX_FLASH.ld] [--top N]
+#                                        [--extern snprintf=440 ...] [--fpu]
+#   python3 fcs_memreport.py ram Debug [--nm arm-none-eabi-nm] [--top N]
+#
+# The stack figures are bounds from the compiler's own frame sizes:
+# - Library functions (newlib: snprintf, sscanf...) have no .su. They count as
+#   0 and the chain is marked '+lib' unless --extern gives a size.
+# - An indirect call (scheduler task, command table, time callback) is taken
+#   as the deepest function that nothing calls directly: those are the ones
+#   only reached through pointers. --callbacks REGEX narrows that set (e.g.
+#   'Task_|Cmd_'). --indirect-depth limits how many pointer calls may nest
+#   (default 2: scheduler -> task -> handler).
+# - Recursion is cut at the repeated call and the chain is marked '+rec'.
+# - Frames marked dynamic (alloca, VLAs) are marked '+dyn'.
+# The MSP total is main's worst chain plus the deepest handler and one
+# exception frame (32 B, or 104 B with FPU context: --fpu). Nested interrupts
+# add one more handler each.
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+NODE = re.compile(r'node:\s*\{\s*title:\s*"([^"]*)"\s*label:\s*"([^"]*)"')
+EDGE = re.compile(r'edge:\s*\{\s*sourcename:\s*"([^"]*)"\s*targetname:\s*"([^"]*)"')
+FRAME = re.compile(r'\\n(\d+) bytes \(([^)]*)\)')
+LD_SYM = re.compile(r'^\s*(_Min_Stack_Size|_Min_Heap_Size)\s*=\s*(0x[0-9A-Fa-f]+|\d+)', re.M)
+INDIRECT = "__indirect_call"
+RAM_BYTES = 96 * 1024  # STM32F401RE
+EXC_FRAME, EXC_FRAME_FPU = 32, 104
+
+
+def find(root, ext):
+    out = []
+    for d, _, files in os.walk(root):
+        out += [os.path.join(d, f) for f in files if f.endswith(ext)]
+    return sorted(out)
+
+
+def linker_sizes(path):
+    if not path:
+        return {}
+    with open(path) as f:
+        return {k: int(v, 0) for k, v in LD_SYM.findall(f.read())}
+
+
+# ------------------------------------------------------------------------------
+# [Stack]
+# ------------------------------------------------------------------------------
+def short(title):
+    """GCC titles static functions 'path/file.c:name': keep 'file.c:name'."""
+    return os.path.basename(title)
+
+
+class Graph:
+    def __init__(self):
+        self.frame = {}   # key -> bytes
+        self.flags = {}   # key -> set of marks
+        self.calls = {}   # key -> [callee keys]
+        self.where = {}   # key -> "file:line"
+        self.callers = {}
+
+    def load(self, ci_files):
+        edges = []
+        for path in ci_files:
+            with open(path, errors="replace") as f:
+                text = f.read()
+            for title, label in NODE.findall(text):
+                m = FRAME.search(label)
+                if not m:
+                    continue  # Declared here, defined elsewhere (or a library)
+                key = short(title)
+                self.frame[key] = int(m.group(1))
+                self.flags[key] = {"+dyn"} if "dynamic" in m.group(2) else set()
+                self.where[key] = os.path.basename(label.split("\\n")[1]) if "\\n" in label else ""
+            edges += EDGE.findall(text)
+        for s, t in edges:
+            src = short(s)
+            dst = t if t == INDIRECT else short(t.lstrip("*"))
+            self.calls.setdefault(src, [])
+            if dst not in self.calls[src]:
+                self.calls[src].append(dst)
+                self.callers.setdefault(dst, set()).add(src)
+
+    def callbacks(self, entries, pattern):
+        """Functions nothing calls directly: reached through pointers."""
+        return [f for f in self.frame if not self.callers.get(f) and f not in entries
+                and (pattern is None or pattern.search(f))]
+
+    def roll(self, externs, entries, depth, pattern):
+        """Worst (bytes, chain, marks) per function, with 'depth' levels of pointer calls."""
+        cbs = self.callbacks(entries, pattern)
+        prev = None
+        for _ in range(depth + 1):
+            memo = {}
+
+            def worst(f, path):
+                if f in memo:
+                    return memo[f]
+                if f == INDIRECT:
+                    # A callback does not re-enter itself: skip those on the path
+                    subs = [prev[c] for c in cbs if prev and c not in path and not path & set(prev[c][1])]
+                    best = max(subs, key=lambda r: r[0]) if subs else (0, [], set())
+                    return (best[0], ["<indirect>"] + best[1], best[2] | {"+ind"})
+                if f in path:
+                    return (0, [f], {"+rec"})
+                if f not in self.frame:
+                    if f in externs:
+                        return (externs[f], [f], set())
+                    return (0, [f], {"+lib"})
+                best = (0, [], set())
+                marks = set(self.flags[f])
+                for c in self.calls.get(f, []):
+                    sub = worst(c, path | {f})
+                    marks |= sub[2]
+                    if sub[0] > best[0] or not best[1]:
+                        best = sub
+                r = (self.frame[f] + best[0], [f] + best[1], marks)
+                if not marks & {"+ind", "+rec"}:
+                    memo[f] = r  # Otherwise it depends on the path
+                return r
+
+            prev = {f: worst(f, frozenset()) for f in self.frame}
+        return prev
+
+
+def is_handler(name):
+    return name.endswith("_Handler") or name.endswith("_IRQHandler")
+
+
+def cmd_stack(args):
+    ci = find(args.build, ".ci")
+    if not ci:
+        sys.exit("%s: no .ci files; build with -fstack-usage -fcallgraph-info=su" % args.build)
+    externs = {}
+    for e in args.extern or []:
+        name, _, size = e.partition("=")
+        externs[name] = int(size, 0)
+    g = Graph()
+    g.load(ci)
+    entries = {"main", "Reset_Handler"} | {f for f in g.frame if is_handler(f)}
+    pattern = re.compile(args.callbacks) if args.callbacks else None
+    memo = g.roll(externs, entries, args.indirect_depth, pattern)
+
+    def chain(r):
+        return " > ".join(r[1]) + ("  [%s]" % " ".join(sorted(r[2])) if r[2] else "")
+
+    print("Worst stack per function (bytes: own frame / with callees)")
+    ranked = sorted(memo.items(), key=lambda kv: -kv[1][0])
+    for f, r in ranked[:args.top]:
+        print("  %5d %5d  %-28s %s" % (g.frame[f], r[0], f, g.where.get(f, "")))
+        print("               %s" % chain(r))
+
+    libs = sorted({c for cs in g.calls.values() for c in cs
+                   if c != INDIRECT and c not in g.frame and c not in externs})
+    if libs:
+        print("\nNo frame size (counted as 0; give one with --extern name=bytes):")
+        print("  " + " ".join(libs))
+
+    handlers = [(f, memo[f]) for f in g.frame if is_handler(f)]
+    if "main" in memo:
+        exc = EXC_FRAME_FPU if args.fpu else EXC_FRAME
+        isr = max(handlers, key=lambda h: h[1][0]) if handlers else ("no handler", (0, [], set()))
+        total = memo["main"][0] + isr[1][0] + exc
+        print("\nMSP worst case: main %d + %s %d + exception frame %d = %d bytes"
+              % (memo["main"][0], isr[0], isr[1][0], exc, total))
+        print("  main: " + chain(memo["main"]))
+        ld = linker_sizes(args.ld)
+        if "_Min_Stack_Size" in ld:
+            budget = ld["_Min_Stack_Size"]
+            print("  _Min_Stack_Size %d: %s" % (budget, "ok, %d spare" % (budget - total) if total <= budget
+                                              else "OVER by %d" % (total - budget)))
+
+
+# ------------------------------------------------------------------------------
+# [RAM]
+# ------------------------------------------------------------------------------
+def cmd_ram(args):
+    objs = find(args.build, ".o")
+    if not objs:
+        sys.exit("%s: no object files" % args.build)
+    mods, syms = [], []
+    for o in objs:
+        out = subprocess.run([args.nm, "-S", "--size-sort", o], capture_output=True, text=True)
+        if out.returncode != 0:
+            sys.exit(out.stderr.strip() or "%s failed on %s" % (args.nm, o))
+        data = bss = 0
+        for line in out.stdout.splitlines():
+            parts = line.split()
+            if len(parts) != 4:
+                continue
+            size, kind, name = int(parts[1], 16), parts[2], parts[3]
+            if kind in "dD":
+                data += size
+            elif kind in "bBC":
+                bss += size
+            else:
+                continue
+            syms.append((size, name, os.path.basename(o)))
+        if data or bss:
+            mods.append((data + bss, data, bss, os.path.relpath(o, args.build)))
+
+    mods.sort(reverse=True)
+    total = sum(m[0] for m in mods)
+    print("Static RAM per module (bytes; .data also takes flash for its initial values)")
+    print("  %6s %6s %6s %5s  %s" % ("total", ".data", ".bss", "%RAM", "module"))
+    for t, d, b, name in mods:
+        print("  %6d %6d %6d %5.1f  %s" % (t, d, b, t * 100.0 / RAM_BYTES, name))
+    print("  %6d %6d %6d %5.1f  (all)" % (total, sum(m[1] for m in mods), sum(m[2] for m in mods),
+                                         total * 100.0 / RAM_BYTES))
+
+    ld = linker_sizes(args.ld)
+    if ld:
+        reserve = ld.get("_Min_Heap_Size", 0) + ld.get("_Min_Stack_Size", 0)
+        print("  + heap %d + stack %d reserve: %d of %d bytes (%d free)"
+              % (ld.get("_Min_Heap_Size", 0), ld.get("_Min_Stack_Size", 0), total + reserve,
+                 RAM_BYTES, RAM_BYTES - total - reserve))
+
+    print("\nLargest symbols")
+    for size, name, obj in sorted(syms, reverse=True)[:args.top]:
+        print("  %6d  %-32s %s" % (size, name, obj))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    s = sub.add_parser("stack", help="worst-case stack from .su/.ci files")
+    s.add_argument("build", help="build directory (searched recursively)")
+    s.add_argument("--ld", help="linker script, for _Min_Stack_Size")
+    s.add_argument("--top", type=int, default=15)
+    s.add_argument("--extern", action="append", metavar="NAME=BYTES", help="frame size of a library function")
+    s.add_argument("--callbacks", metavar="REGEX", help="functions an indirect call may reach")
+    s.add_argument("--indirect-depth", type=int, default=2)
+    s.add_argument("--fpu", action="store_true", help="exception frame with FPU context (104 B)")
+    r = sub.add_parser("ram", help="static RAM per object file")
+    r.add_argument("build", help="build directory (searched recursively)")
+    r.add_argument("--nm", default="arm-none-eabi-nm")
+    r.add_argument("--ld", help="linker script, for the heap and stack reserves")
+    r.add_argument("--top", type=int, default=15)
+    args = ap.parse_args()
+    (cmd_stack if args.cmd == "stack" else cmd_ram)(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,227 @@
+// Host check of the integer formatter/parser (Core/Src/fcs_fmt.c) against
+// the C library it replaces, plus a timing spread.
+//
+//   gcc -O2 -Wall -I../Core/Inc fmt_check.c ../Core/Src/fcs_fmt.c -o fmt_check
+//   ./fmt_check
+//
+// [1] Every UI line format (ui.c) and the %d/%u width/padding cases give
+//     the same text as snprintf, including truncation at the buffer end.
+// [2] FCS_Parse_Int reads what sscanf("%ld") reads from the same input and
+//     stops at the same character. It rejects, where sscanf is undefined:
+//     over 10 digits and out-of-range values.
+// [3] The text-target grammar of FCS_Process_Command ("%d,%c,%ld,%ld,%d")
+//     gives the same field count on valid and broken commands.
+// Timings are host ns per call (not measured on hardware). They show that
+// the cost depends on the digit count only; snprintf's is for reference.
+#include "fcs_fmt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int fails = 0;
+
+static void Expect(const char *what, const char *got, const char *want) {
+  if (strcmp(got, want) == 0) return;
+  if (fails++ < 20) printf("FAIL %s: got \"%s\" want \"%s\"\n", what, got, want);
+}
+
+static uint32_t rng = 0x12345678U;
+static uint32_t Rand(void) {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+// Random value with a random digit count, so short and long numbers both occur
+static int32_t Rand_Int(void) {
+  static const int32_t mod[] = { 10, 100, 1000, 100000, 10000000, 0 };
+  int32_t v = (int32_t)Rand();
+  int32_t m = mod[Rand() % 6];
+  return m ? v % m : v;
+}
+
+// [1]
+static void Check_Format(void) {
+  static const int32_t edge[] = { 0, 1, -1, 9, -9, 10, 99, 100, 999, 1000, -1000, 9999, 123456,
+                                  2147483647, -2147483647 - 1 };
+  char got[32], want[32];
+  FCS_Fmt_t f;
+  for (unsigned i = 0; i < 200000; i++) {
+    int32_t v = (i < sizeof(edge) / sizeof(edge[0])) ? edge[i] : Rand_Int();
+    uint8_t width = (uint8_t)(Rand() % 12);
+    char pad = (Rand() & 1) ? '0' : ' ';
+    uint16_t size = (uint16_t)(1 + Rand() % 16);
+
+    FCS_Fmt_Init(&f, got, size);
+    FCS_Fmt_Int(&f, v, width, pad);
+    snprintf(want, size, pad == '0' ? "%0*d" : "%*d", width, (int)v);
+    Expect("int", got, want);
+
+    FCS_Fmt_Init(&f, got, size);
+    FCS_Fmt_Uint(&f, (uint32_t)v, width, pad);
+    snprintf(want, size, pad == '0' ? "%0*u" : "%*u", width, (unsigned)v);
+    Expect("uint", got, want);
+  }
+
+  // ui.c lines, as they were written with snprintf into char[32]
+  for (unsigned i = 0; i < 20000; i++) {
+    int32_t zone = (int32_t)(Rand() % 61), alt = Rand_Int() % 10000, a = Rand_Int() % 100000;
+    uint32_t e = Rand() % 10000000U, n = Rand() % 100000000U;
+    char band = (char)('C' + Rand() % 20), c = (Rand() & 1) ? 'L' : ' ';
+
+    FCS_Fmt_Init(&f, got, sizeof(got));
+    FCS_Fmt_Int(&f, zone, 0, ' ');
+    FCS_Fmt_Char(&f, band);
+    FCS_Fmt_Str(&f, " E:");
+    FCS_Fmt_Uint(&f, e, 6, '0');
+    snprintf(want, sizeof(want), "%d%c E:%06lu", (int)zone, band, (unsigned long)e);
+    Expect("zone/easting", got, want);
+
+    FCS_Fmt_Init(&f, got, sizeof(got));
+    FCS_Fmt_Str(&f, "    N:0");
+    FCS_Fmt_Uint(&f, n, 7, '0');
+    snprintf(want, sizeof(want), "    N:0%07lu", (unsigned long)n);
+    Expect("northing", got, want);
+
+    FCS_Fmt_Init(&f, got, sizeof(got));
+    FCS_Fmt_Str(&f, "    A:");
+    FCS_Fmt_Int(&f, alt, 4, '0');
+    FCS_Fmt_Str(&f, " m");
+    snprintf(want, sizeof(want), "    A:%04d m", (int)alt);
+    Expect("altitude", got, want);
+
+    FCS_Fmt_Init(&f, got, sizeof(got));
+    FCS_Fmt_Str(&f, "AZ:");
+    FCS_Fmt_Int(&f, a % 6400, 4, '0');
+    FCS_Fmt_Str(&f, " QE:");
+    FCS_Fmt_Int(&f, a % 1600, 3, '0');
+    snprintf(want, sizeof(want), "AZ:%04d QE:%03d", (int)(a % 6400), (int)(a % 1600));
+    Expect("fire data", got, want);
+
+    FCS_Fmt_Init(&f, got, sizeof(got));
+    FCS_Fmt_Str(&f, "DEV : ");
+    FCS_Fmt_Char(&f, c);
+    FCS_Fmt_Str(&f, "  ");
+    FCS_Fmt_Int(&f, a % 1000, 3, ' ');
+    snprintf(want, sizeof(want), "DEV : %c  %3d", c, (int)(a % 1000));
+    Expect("deviation", got, want);
+
+    FCS_Fmt_Init(&f, got, sizeof(got));
+    FCS_Fmt_Str(&f, "Mask: ");
+    FCS_Fmt_Uint(&f, (uint16_t)a, 3, '0');
+    FCS_Fmt_Str(&f, " mil");
+    snprintf(want, sizeof(want), "Mask: %03u mil", (unsigned)(uint16_t)a);
+    Expect("mask", got, want);
+  }
+}
+
+// [2]
+static void Check_Parse(void) {
+  static const char *const cases[] = {
+    "0", "-0", "+7", "  42,", "\t-13x", "2147483647", "-2147483648", "007", "", "-", "+", " ,1", "x1",
+    "1234567890", "12a", "-0000012",
+  };
+  static const char *const rejected[] = { "2147483648", "-2147483649", "12345678901", "99999999999999" };
+  char buf[24], what[64];
+  for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]) + 100000; i++) {
+    const char *s = buf;
+    if (i < sizeof(cases) / sizeof(cases[0])) {
+      s = cases[i];
+    } else {
+      const char *lead = (Rand() & 3) ? "" : ((Rand() & 1) ? " " : "\t");
+      snprintf(buf, sizeof(buf), "%s%s%d%s", lead, (Rand() & 7) ? "" : "+", (int)Rand_Int(), (Rand() & 1) ? ",S" : "");
+    }
+    long want = 0;
+    int used = 0;
+    int ok = (sscanf(s, "%ld%n", &want, &used) == 1);
+    int32_t got = 0;
+    const char *end = FCS_Parse_Int(s, &got);
+    snprintf(what, sizeof(what), "parse \"%s\"", s);
+    if (ok != (end != NULL) || (ok && (got != want || end != s + used))) {
+      Expect(what, end ? "number" : "none", ok ? "number" : "none");
+      if (ok && end) {
+        char g[24], w[24];
+        snprintf(g, sizeof(g), "%ld@%d", (long)got, (int)(end - s));
+        snprintf(w, sizeof(w), "%ld@%d", want, used);
+        Expect(what, g, w);
+      }
+    }
+  }
+  for (unsigned i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++) {
+    int32_t got;
+    if (FCS_Parse_Int(rejected[i], &got) != NULL) Expect("out of range", "accepted", "rejected");
+  }
+}
+
+// [3] Same grammar as FCS_Parse_Target in fcs_core.c
+static int Parse_Target(const char *s, int32_t *z, char *b, int32_t *e, int32_t *n, int32_t *a) {
+  if (!(s = FCS_Parse_Int(s, z))) return 0;
+  if (*s++ != ',' || *s == '\0') return 1;
+  *b = *s++;
+  if (*s++ != ',' || !(s = FCS_Parse_Int(s, e))) return 2;
+  if (*s++ != ',' || !(s = FCS_Parse_Int(s, n))) return 3;
+  if (*s++ != ',' || !FCS_Parse_Int(s, a)) return 4;
+  return 5;
+}
+
+static void Check_Target(void) {
+  static const char *const cases[] = {
+    "52,S,333712,4132894,100", "52,S,333712,4132894,-5", " 52,S, 333712, 4132894, 100", "52,S,333712,4132894",
+    "52,S,333712", "52,S", "52,", "52", "", "x", "52;S,1,2,3", "52,S;1,2,3", "52, ,1,2,3", "52,S,a,2,3",
+    "52,S,1,2,3trailing", "-1,S,1,2,3", "52,S,1,,3",
+  };
+  char what[64];
+  for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    int z = 0, a = 0;
+    char b = 0;
+    long e = 0, n = 0;
+    int want = sscanf(cases[i], "%d,%c,%ld,%ld,%d", &z, &b, &e, &n, &a);
+    if (want < 0) want = 0; // EOF on empty input: the firmware only tests for 5
+    int32_t gz = 0, ge = 0, gn = 0, ga = 0;
+    char gb = 0;
+    int got = Parse_Target(cases[i], &gz, &gb, &ge, &gn, &ga);
+    char g[16], w[16];
+    snprintf(g, sizeof(g), "%d", got);
+    snprintf(w, sizeof(w), "%d", want);
+    snprintf(what, sizeof(what), "target \"%s\"", cases[i]);
+    Expect(what, g, w);
+    if (got == 5 && (gz != z || gb != b || ge != e || gn != n || ga != a)) Expect(what, "fields", "same fields");
+  }
+}
+
+static double Ns_Per_Call(int32_t v, int use_libc) {
+  char buf[32];
+  FCS_Fmt_t f;
+  volatile char sink = 0;
+  const int reps = 2000000;
+  struct timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (int i = 0; i < reps; i++) {
+    if (use_libc) {
+      snprintf(buf, sizeof(buf), "%06d", (int)v);
+    } else {
+      FCS_Fmt_Init(&f, buf, sizeof(buf));
+      FCS_Fmt_Int(&f, v, 6, '0');
+    }
+    sink ^= buf[0];
+    __asm__ volatile("" ::: "memory");
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  (void)sink;
+  return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / reps;
+}
+
+int main(void) {
+  Check_Format();
+  Check_Parse();
+  Check_Target();
+
+  printf("Format \"%%06d\" (host ns per call, not measured on hardware)\n");
+  printf("  %12s %8s %8s\n", "value", "fcs_fmt", "snprintf");
+  static const int32_t v[] = { 0, 12345, -2147483647 - 1 };
+  for (unsigned i = 0; i < 3; i++) {
+    printf("  %12ld %8.1f %8.1f\n", (long)v[i], Ns_Per_Call(v[i], 0), Ns_Per_Call(v[i], 1));
+  }
+  printf(fails ? "FAILED (%d)\n" : "ok\n", fails);
+  return fails ? 1 : 0;
+}
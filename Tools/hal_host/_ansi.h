@@ -0,0 +1,11 @@
+// Host stand-in for the newlib header that ssd1306.h includes
+#ifndef HAL_HOST_ANSI_H_
+#define HAL_HOST_ANSI_H_
+#ifdef __cplusplus
+#define _BEGIN_STD_C extern "C" {
+#define _END_STD_C   }
+#else
+#define _BEGIN_STD_C
+#define _END_STD_C
+#endif
+#endif
@@ -0,0 +1,104 @@
+// Host stand-in for the part of the STM32F4 HAL and CMSIS that the link code
+// (Core/Src/fcs_core.c) touches, so it builds unchanged for a host sim.
+//
+// Found through -Ihal_host in place of Drivers/: the CubeMX headers in
+// Core/Inc (main.h, usart.h, ssd1306.h...) include it as they would on the
+// target. Only types, registers and prototypes are here; the functions are
+// defined by the sim, which is the model of the wire (see uart_sim.c).
+// The USART register block has SR and DR only: writing DR is how the ISR
+// sends XON/XOFF, and the sim takes the byte from there.
+#ifndef STM32F4XX_HAL_H_
+#define STM32F4XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+// [Core]
+typedef struct { volatile uint32_t CTRL, CYCCNT; } DWT_Type;
+typedef struct { volatile uint32_t DEMCR; } CoreDebug_Type;
+extern DWT_Type hal_host_dwt;
+extern CoreDebug_Type hal_host_coredebug;
+#define DWT        (&hal_host_dwt)
+#define CoreDebug  (&hal_host_coredebug)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk     (1UL << 0)
+
+extern uint32_t SystemCoreClock;
+
+// Single-threaded host: the sim calls the RX callback between statements,
+// never inside a masked section, so masking is a no-op
+#define __disable_irq()   ((void)0)
+#define __enable_irq()    ((void)0)
+#define __get_PRIMASK()   0U
+#define __set_PRIMASK(x)  ((void)(x))
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t ms);
+
+// [GPIO]
+typedef struct { uint32_t Pin, Mode, Pull, Speed, Alternate; } GPIO_InitTypeDef;
+typedef struct { volatile uint32_t ODR; } GPIO_TypeDef;
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+extern GPIO_TypeDef hal_host_gpio[3];
+#define GPIOA  (&hal_host_gpio[0])
+#define GPIOB  (&hal_host_gpio[1])
+#define GPIOC  (&hal_host_gpio[2])
+#define GPIO_PIN_0   0x0001U
+#define GPIO_PIN_1   0x0002U
+#define GPIO_PIN_2   0x0004U
+#define GPIO_PIN_3   0x0008U
+#define GPIO_PIN_4   0x0010U
+#define GPIO_PIN_5   0x0020U
+#define GPIO_PIN_6   0x0040U
+#define GPIO_PIN_7   0x0080U
+#define GPIO_PIN_8   0x0100U
+#define GPIO_PIN_9   0x0200U
+#define GPIO_PIN_10  0x0400U
+#define GPIO_PIN_11  0x0800U
+#define GPIO_PIN_12  0x1000U
+#define GPIO_PIN_13  0x2000U
+#define GPIO_PIN_14  0x4000U
+#define GPIO_PIN_15  0x8000U
+#define GPIO_MODE_OUTPUT_PP        0x01U
+#define GPIO_MODE_AF_PP            0x02U
+#define GPIO_NOPULL                0x00U
+#define GPIO_PULLDOWN              0x02U
+#define GPIO_SPEED_FREQ_VERY_HIGH  0x03U
+#define GPIO_AF7_USART1            0x07U
+#define __HAL_RCC_GPIOA_CLK_ENABLE() ((void)0)
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init);
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+
+// [UART]
+typedef struct { volatile uint32_t SR, DR; } USART_TypeDef;
+extern USART_TypeDef hal_host_usart[2];
+#define USART1  (&hal_host_usart[0])
+#define USART2  (&hal_host_usart[1])
+#define USART_SR_TXE  (1UL << 7)
+
+typedef struct {
+  uint32_t BaudRate, WordLength, StopBits, Parity, Mode, HwFlowCtl, OverSampling;
+} UART_InitTypeDef;
+typedef struct {
+  USART_TypeDef *Instance;
+  UART_InitTypeDef Init;
+  volatile uint32_t gState;
+} UART_HandleTypeDef;
+#define HAL_UART_STATE_READY  0x20U
+#define UART_HWCONTROL_NONE   0x000U
+#define UART_HWCONTROL_CTS    0x200U
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart);
+
+// [Other handles] Declared by the CubeMX headers; never used by the link code
+typedef struct { void *Instance; } ADC_HandleTypeDef;
+typedef struct { void *Instance; } I2C_HandleTypeDef;
+typedef struct { void *Instance; } DMA_HandleTypeDef;
+
+#endif
@@ -0,0 +1,2 @@
+// Host stand-in: ssd1306.h includes the GPIO part on its own
+#include "stm32f4xx_hal.h"
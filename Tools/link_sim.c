@@ -0,0 +1,494 @@
+// Host loopback of the request window over a lossy link: the client's
+// window and retransmit rules (ClientApp/fcs_terminal.py) against the real
+// receive path of Core/Src/fcs_core.c and the frame codec (fcs_codec.c).
+//
+//   SRC="../Core/Src/fcs_codec.c ../Core/Src/fcs_aead.c ../Core/Src/fcs_math.c ../Core/Src/fcs_sched.c
+//        ../Core/Src/fcs_probe.c ../Core/Src/fcs_fmt.c ../Core/Src/fcs_clock.c"
+//   gcc -O2 -Wall -DFCS_CLOCK_HOST -Ihal_host -I../Core/Inc link_sim.c $SRC -lm -o link_sim
+//   ./link_sim [seeds]
+//
+// Build it with and without -DFCS_PROTO_COBS=1 for the two parsers.
+//
+// The wire and main loop are those of uart_sim.c (fcs_core.c compiled in,
+// hal_host/ for the types, 10 bit times a byte at FCS_BAUD_DEFAULT, a 100 ms
+// panel push every 200 ms). Every byte, both ways, is hit by an error with
+// the given probability: half are dropped, half have one bit flipped.
+//
+// The client sends 45 binary targets. It keeps WINDOW_FRAMES frames and
+// WINDOW_BYTES bytes in flight (stop-and-wait: one frame), polls its timers
+// every RTO_POLL_MS and applies fcs_terminal.py's rules: RTO of twice the
+// smoothed RTT (Karn), at least RTO_MIN_MS; NAK CRC resends at once; NAK BUSY
+// restarts the timer; STX/ETX holds the line quiet for RESYNC_GAP_MS after a
+// timeout, then resends what is still unanswered; COBS resends each timed-out
+// frame alone; a frame is given up after MAX_RETRIES resends. Runs are
+// back to back with a quiet second between them.
+//
+// Checks (exit 1 on failure):
+// [1] Every reply the client takes for a target in flight is its
+//     FIRE_RESULT or a NAK, every run ends (answered or given up) within
+//     RUN_LIMIT_MS, and the RX ring never overflows.
+// [2] Without errors: every target answered, no resend, and the window is
+//     faster than stop-and-wait.
+// [3] At 0.1 % byte errors every run completes and the window stays faster
+//     than stop-and-wait.
+// Times are from the model, not measured on hardware.
+#include "../Core/Src/fcs_core.c"
+#include <stdio.h>
+
+#if FCS_PROTO_AEAD
+#error "link_sim models the XOR frame version: build without FCS_PROTO_AEAD"
+#endif
+
+#define LCD_PERIOD_MS    200
+#define LCD_PUSH_MS      100     // Full SSD1306 push at 100 kHz (estimate)
+#define PASS_COST_US     20      // One serial task pass with nothing to do
+#define SETTLE_MS        1000    // Between runs: stray bytes time out
+#define RUN_LIMIT_MS     60000
+
+// fcs_terminal.py
+#define WINDOW_FRAMES    4
+#define WINDOW_BYTES     192
+#define RTO_MIN_MS       300
+#define RTO_POLL_MS      50
+#define RESYNC_GAP_MS    550
+#define MAX_RETRIES      2
+
+#define TARGETS          45
+#define SEEDS            20
+
+// [HAL stand-in state]
+DWT_Type hal_host_dwt;
+CoreDebug_Type hal_host_coredebug;
+GPIO_TypeDef hal_host_gpio[3];
+USART_TypeDef hal_host_usart[2] = { { USART_SR_TXE, 0 }, { USART_SR_TXE, 0 } };
+uint32_t SystemCoreClock = 84000000U;
+UART_HandleTypeDef huart1 = { .Instance = USART1, .Init = { .BaudRate = FCS_BAUD_DEFAULT }, .gState = HAL_UART_STATE_READY };
+static FCS_System_t fcs;
+
+static uint64_t v_ns = 0;
+static uint64_t byte_ns;
+static uint8_t *rx_dst = NULL;     // Armed by HAL_UART_Receive_IT
+
+static int fails = 0;
+static void Fail(const char *what) {
+  if (fails++ < 10) printf("FAIL %s at %.3f s\n", what, v_ns / 1e9);
+}
+
+// [Line] Byte errors, both directions
+static uint32_t rng = 1;
+static uint32_t Rand(void) {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+static uint32_t l_err_ppm = 0;
+static unsigned l_errors = 0;
+
+// Returns 0 if the byte is lost
+static int Line_Pass(uint8_t *b) {
+  if (Rand() % 1000000U >= l_err_ppm) return 1;
+  l_errors++;
+  if (Rand() & 1) return 0;
+  *b ^= (uint8_t)(1U << (Rand() % 8));
+  return 1;
+}
+
+// [Client]
+typedef struct {
+  uint8_t used, seq, len, tries;
+  uint8_t frame[FCS_PROTO_OVERHEAD + FCS_TARGET_RECORD_SIZE + 2];
+  uint64_t sent_ns;
+} Inflight_t;
+
+static Inflight_t c_win[WINDOW_FRAMES];
+static unsigned c_frames = WINDOW_FRAMES; // 1: stop-and-wait
+static unsigned c_left = 0, c_done = 0, c_lost = 0, c_retx = 0;
+static uint8_t c_seq = 0;
+static uint8_t c_active = 0;       // Cleared between runs: replies are dropped
+static uint64_t c_quiet_until = 0;
+static uint8_t c_resync = 0;
+static double c_srtt_ms = -1.0;
+static uint64_t c_tick_ns = 0;
+
+static uint8_t c_tx[4096];         // Serial driver buffer
+static unsigned c_tx_head = 0, c_tx_tail = 0;
+static uint64_t c_next_ns = UINT64_MAX; // Next byte at the ISR, UINT64_MAX while idle
+
+static uint8_t c_rx[1024];
+static unsigned c_rx_len = 0;
+
+static void Client_Write(const uint8_t *data, unsigned n) {
+  for (unsigned i = 0; i < n; i++) {
+    c_tx[c_tx_head] = data[i];
+    c_tx_head = (c_tx_head + 1) % sizeof(c_tx);
+  }
+  if (c_next_ns == UINT64_MAX) c_next_ns = v_ns + byte_ns;
+}
+
+static unsigned Client_Inflight(unsigned *bytes) {
+  unsigned n = 0, b = 0;
+  for (unsigned i = 0; i < WINDOW_FRAMES; i++) {
+    if (!c_win[i].used) continue;
+    n++;
+    b += c_win[i].len;
+  }
+  if (bytes) *bytes = b;
+  return n;
+}
+
+static Inflight_t *Client_Find(uint8_t seq) {
+  for (unsigned i = 0; i < WINDOW_FRAMES; i++) {
+    if (c_win[i].used && c_win[i].seq == seq) return &c_win[i];
+  }
+  return NULL;
+}
+
+static void Client_Pump(void) {
+  if (v_ns < c_quiet_until) return;
+  unsigned bytes;
+  while (c_left > 0 && Client_Inflight(&bytes) < c_frames) {
+    uint8_t buf[sizeof(c_win[0].frame)];
+    FCS_TargetRecord_t t = { 52, 'S', 334000U + (TARGETS - c_left) * 100U, 4131000U, 120 };
+    memcpy(&buf[5], &t, sizeof(t));
+    while (Client_Find(c_seq)) c_seq++;
+    uint8_t seq = c_seq++;
+    buf[1] = FCS_CMD_TARGET_BIN;
+    buf[2] = seq;
+    buf[3] = (uint8_t)Rand(); // Salt
+    buf[4] = sizeof(t);
+    FCS_Codec_Seal(&buf[1], FCS_PROTO_FLAGS, NULL, 0, 0, FCS_CODEC_DIR_TO_FCS);
+    uint8_t len = FCS_Codec_Frame(buf, FCS_PROTO_FLAGS);
+    if (bytes > 0 && bytes + len > WINDOW_BYTES) break;
+
+    Inflight_t *e = NULL;
+    for (unsigned i = 0; i < WINDOW_FRAMES && !e; i++) {
+      if (!c_win[i].used) e = &c_win[i];
+    }
+    e->used = 1;
+    e->seq = seq;
+    e->len = len;
+    e->tries = 0;
+    e->sent_ns = v_ns;
+    memcpy(e->frame, buf, len);
+    Client_Write(buf, len);
+    c_left--;
+    bytes += len;
+  }
+}
+
+static double Client_Rto_Ms(void) {
+  if (c_srtt_ms < 0) return RTO_MIN_MS * 2;
+  return (2 * c_srtt_ms > RTO_MIN_MS) ? 2 * c_srtt_ms : RTO_MIN_MS;
+}
+
+static void Client_Retransmit(Inflight_t *e) {
+  if (e->tries >= MAX_RETRIES) {
+    e->used = 0;
+    c_lost++;
+    Client_Pump();
+    return;
+  }
+  if (v_ns < c_quiet_until) return; // Picked up when the quiet gap ends
+  e->sent_ns = v_ns;
+  e->tries++;
+  c_retx++;
+  Client_Write(e->frame, e->len);
+}
+
+static void Client_Tick(void) {
+  if (v_ns < c_quiet_until) return;
+  if (c_resync) {
+    // Anything still unanswered after the quiet gap went into the desynced parser
+    c_resync = 0;
+    for (unsigned i = 0; i < WINDOW_FRAMES; i++) {
+      if (c_win[i].used && c_win[i].sent_ns < c_quiet_until - RESYNC_GAP_MS * 1000000ULL) Client_Retransmit(&c_win[i]);
+    }
+    Client_Pump();
+    return;
+  }
+  uint64_t rto_ns = (uint64_t)(Client_Rto_Ms() * 1e6);
+  for (unsigned i = 0; i < WINDOW_FRAMES; i++) {
+    if (!c_win[i].used || v_ns - c_win[i].sent_ns <= rto_ns) continue;
+#if FCS_PROTO_COBS
+    Client_Retransmit(&c_win[i]);
+#else
+    // A lost byte leaves the firmware parser mid-frame: hold the line quiet
+    // until it times out, then resend
+    c_resync = 1;
+    c_quiet_until = v_ns + RESYNC_GAP_MS * 1000000ULL;
+    break;
+#endif
+  }
+}
+
+static void Client_Frame(uint8_t *body) {
+  Inflight_t *e = Client_Find(body[1]);
+  if (!e) return; // Late reply to a frame already answered
+  int n = FCS_Codec_Open(body, FCS_PROTO_FLAGS, NULL, FCS_CODEC_DIR_FROM_FCS);
+  const uint8_t *pl = &body[4 + FCS_Codec_Text_Ofs(FCS_PROTO_FLAGS)];
+  if (body[0] == FCS_CMD_NAK && n >= 2 && pl[1] == FCS_NAK_CRC) {
+    Client_Retransmit(e);
+    return;
+  }
+  if (body[0] == FCS_CMD_NAK && n >= 2 && pl[1] == FCS_NAK_BUSY) {
+    e->sent_ns = v_ns;
+    return;
+  }
+  // [1]
+  if (body[0] != FCS_CMD_FIRE_RESULT) Fail("reply of the wrong type");
+  if (e->tries == 0) {
+    double rtt_ms = (v_ns - e->sent_ns) / 1e6;
+    c_srtt_ms = (c_srtt_ms < 0) ? rtt_ms : 0.875 * c_srtt_ms + 0.125 * rtt_ms;
+  }
+  e->used = 0;
+  c_done++;
+  Client_Pump();
+}
+
+static void Client_Rx(uint8_t b) {
+  if (!c_active) return;
+  if (c_rx_len == sizeof(c_rx)) c_rx_len = 0;
+  c_rx[c_rx_len++] = b;
+#if FCS_PROTO_COBS
+  // Each 0x00 ends a frame; a span that fails to decode or check is dropped
+  if (b != 0x00) return;
+  if (c_rx_len > 1 && FCS_Codec_Unframe(c_rx, (uint8_t)(c_rx_len - 1), FCS_CODEC_F_COBS) > 0) Client_Frame(c_rx);
+  c_rx_len = 0;
+#else
+  uint32_t start, n;
+  while ((n = FCS_Codec_Scan(c_rx, c_rx_len, &start)) > 0) {
+    Client_Frame(&c_rx[start + 1]);
+    c_rx_len -= start + n;
+    memmove(c_rx, &c_rx[start + n], c_rx_len);
+  }
+  c_rx_len -= start;
+  memmove(c_rx, &c_rx[start], c_rx_len);
+#endif
+}
+
+// [Wire]
+static unsigned ring_peak = 0;
+
+static void Sim_Clock(uint64_t ns) {
+  v_ns = ns;
+  DWT->CYCCNT = (uint32_t)(ns * (SystemCoreClock / 1000000U) / 1000U);
+}
+
+static void Wire_Rx(uint8_t b) {
+  if (!Line_Pass(&b) || !rx_dst) return;
+  *rx_dst = b;
+  rx_dst = NULL;
+  FCS_UART_RxCallback(&huart1);
+  if (Serial_Ring_Fill() > ring_peak) ring_peak = Serial_Ring_Fill();
+}
+
+// Delivers every client byte and runs every client timer due up to 'to'
+static void Sim_Advance(uint64_t to) {
+  for (;;) {
+    uint64_t next = (c_next_ns < c_tick_ns) ? c_next_ns : c_tick_ns;
+    if (next > to) break;
+    Sim_Clock(next);
+    if (next == c_next_ns) {
+      uint8_t b = c_tx[c_tx_tail];
+      c_tx_tail = (c_tx_tail + 1) % sizeof(c_tx);
+      c_next_ns = (c_tx_tail != c_tx_head) ? v_ns + byte_ns : UINT64_MAX;
+      Wire_Rx(b);
+    } else {
+      c_tick_ns += RTO_POLL_MS * 1000000ULL;
+      if (c_active) Client_Tick();
+    }
+  }
+  if (to > v_ns) Sim_Clock(to);
+}
+
+uint32_t HAL_GetTick(void) {
+  return (uint32_t)(v_ns / 1000000U);
+}
+
+void HAL_Delay(uint32_t ms) {
+  Sim_Advance(v_ns + ms * 1000000ULL);
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init) {
+  (void)port;
+  (void)init;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state) {
+  if (state == GPIO_PIN_SET) port->ODR |= pin;
+  else port->ODR &= ~(uint32_t)pin;
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+  byte_ns = 10000000000ULL / huart->Init.BaudRate;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size, uint32_t timeout) {
+  (void)huart;
+  (void)timeout;
+  for (uint16_t i = 0; i < size; i++) {
+    Sim_Advance(v_ns + byte_ns);
+    uint8_t b = data[i];
+    if (Line_Pass(&b)) Client_Rx(b);
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size) {
+  (void)huart;
+  (void)size;
+  rx_dst = data;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart) {
+  (void)huart;
+  rx_dst = NULL;
+  return HAL_OK;
+}
+
+void Error_Handler(void) {
+  Fail("Error_Handler");
+}
+
+// [Other modules] Not part of the link path
+void BMP280_Read_All(BMP280_Data_t *data) {
+  data->temperature = 15.0f;
+  data->pressure = 1013.25f;
+}
+
+void Input_Read_All(ADC_HandleTypeDef *hadc, uint32_t *dest) {
+  (void)hadc;
+  for (int i = 0; i < 4; i++) dest[i] = 4000;
+}
+
+KeyState Input_Scan(uint32_t adc_value) {
+  (void)adc_value;
+  return KEY_NONE;
+}
+
+uint32_t FCS_Stack_Hwm(void) { return 0; }
+uint32_t FCS_Stack_Budget(void) { return 0; }
+
+// [Runs]
+static uint64_t next_lcd = 0;
+
+// Main loop of uart_sim.c until 'done' or 'until'
+static void Firmware_Run(uint64_t until, int (*done)(void)) {
+  while (v_ns < until && !(done && done())) {
+    FCS_Task_Serial(&fcs, &huart1);
+    Sim_Advance(v_ns + PASS_COST_US * 1000ULL);
+    if (v_ns >= next_lcd) {
+      Sim_Advance(v_ns + LCD_PUSH_MS * 1000000ULL);
+      next_lcd = v_ns + (LCD_PERIOD_MS - LCD_PUSH_MS) * 1000000ULL;
+    }
+    if (FCS_Serial_Busy()) continue;
+    uint64_t wake = next_lcd;
+    if (c_next_ns < wake) wake = c_next_ns;
+    if (c_tick_ns < wake) wake = c_tick_ns;
+    if (FCS_Serial_Timed() && v_ns + FCS_TASK_SERIAL_MS * 1000000ULL < wake) wake = v_ns + FCS_TASK_SERIAL_MS * 1000000ULL;
+    if (until < wake) wake = until;
+    Sim_Advance(wake);
+  }
+}
+
+static int Run_Done(void) {
+  return c_left == 0 && Client_Inflight(NULL) == 0;
+}
+
+typedef struct {
+  unsigned runs, complete, lost, retx, errors;
+  double sum_ms, max_ms;
+} Result_t;
+
+static void Run(Result_t *r, uint32_t err_ppm, unsigned frames, uint32_t seed) {
+  // Quiet line first: whatever the last run left in the parser times out
+  c_active = 0;
+  l_err_ppm = 0;
+  Firmware_Run(v_ns + SETTLE_MS * 1000000ULL, NULL);
+
+  rng = seed * 2654435761U + 1U;
+  memset(c_win, 0, sizeof(c_win));
+  c_frames = frames;
+  c_left = TARGETS;
+  c_done = c_lost = c_retx = 0;
+  c_quiet_until = 0;
+  c_resync = 0;
+  c_srtt_ms = -1.0;
+  c_rx_len = 0;
+  c_active = 1;
+  l_err_ppm = err_ppm;
+  l_errors = 0;
+
+  uint64_t t0 = v_ns;
+  Client_Pump();
+  Firmware_Run(t0 + RUN_LIMIT_MS * 1000000ULL, Run_Done);
+  double ms = (v_ns - t0) / 1e6;
+
+  if (c_done + c_lost != TARGETS) Fail("run did not finish");
+  r->runs++;
+  r->complete += (c_lost == 0);
+  r->lost += c_lost;
+  r->retx += c_retx;
+  r->errors += l_errors;
+  r->sum_ms += ms;
+  if (ms > r->max_ms) r->max_ms = ms;
+}
+
+int main(int argc, char **argv) {
+  unsigned seeds = (argc > 1) ? (unsigned)atoi(argv[1]) : SEEDS;
+  if (seeds == 0) seeds = SEEDS;
+  static const uint32_t err_ppm[] = { 0, 1000, 3000, 10000 };
+  enum { RATES = sizeof(err_ppm) / sizeof(err_ppm[0]) };
+  Result_t res[RATES][2];
+  memset(res, 0, sizeof(res));
+
+  FCS_Init_System(&fcs);
+  fcs.user_pos = (UTM_Coord_t){ .zone = 52, .band = 'S', .easting = 333712, .northing = 4132894, .altitude = 100 };
+  fcs.env.air_temp = 15.0f;
+  fcs.env.air_pressure = 1013.25f;
+  fcs.fire.charge = 5;
+  HAL_UART_Init(&huart1);
+  FCS_Serial_Start(&huart1);
+  c_tick_ns = RTO_POLL_MS * 1000000ULL;
+  next_lcd = LCD_PERIOD_MS * 1000000ULL;
+
+  for (unsigned i = 0; i < RATES; i++) {
+    for (unsigned s = 0; s < seeds; s++) {
+      Run(&res[i][0], err_ppm[i], WINDOW_FRAMES, s);
+      Run(&res[i][1], err_ppm[i], 1, s);
+    }
+  }
+
+  printf("Link loss, %u binary targets x %u seeds at %u baud, %s (model, not measured on hardware)\n", TARGETS, seeds,
+         (unsigned)huart1.Init.BaudRate, FCS_PROTO_COBS ? "COBS" : "STX/ETX");
+  printf("  byte err  %-38s  %s\n", "window 4 / 192 B", "stop-and-wait");
+  printf("            %-38s  %s\n", "done  mean s  max s  resends  ms/error", "done  mean s  max s  resends  ms/error");
+  for (unsigned i = 0; i < RATES; i++) {
+    printf("  %5.1f %%  ", err_ppm[i] / 10000.0);
+    for (unsigned w = 0; w < 2; w++) {
+      const Result_t *r = &res[i][w];
+      const Result_t *base = &res[0][w];
+      double mean = r->sum_ms / r->runs;
+      double per_err = r->errors ? (r->sum_ms - base->sum_ms / base->runs * r->runs) / r->errors : 0.0;
+      printf("  %2u/%-2u %6.2f %6.2f %8.1f %9.0f", r->complete, r->runs, mean / 1000.0, r->max_ms / 1000.0,
+             (double)r->retx / r->runs, per_err);
+    }
+    printf("\n");
+  }
+  printf("  ring peak %u of %u, overflow %u bytes\n", ring_peak, RING_SIZE - 1, (unsigned)FCS_Serial_GetOverflowCount());
+
+  // [1]
+  if (FCS_Serial_GetOverflowCount() != 0) Fail("ring overflow");
+
+  // [2]
+  if (res[0][0].complete != res[0][0].runs || res[0][1].complete != res[0][1].runs) Fail("targets lost without errors");
+  if (res[0][0].retx != 0 || res[0][1].retx != 0) Fail("resends without errors");
+  if (res[0][0].sum_ms >= res[0][1].sum_ms) Fail("window no faster than stop-and-wait");
+  // [3]
+  if (res[1][0].complete != res[1][0].runs || res[1][1].complete != res[1][1].runs) Fail("targets lost at 0.1 %");
+  if (res[1][0].sum_ms >= res[1][1].sum_ms) Fail("window no faster than stop-and-wait at 0.1 %");
+  printf(fails ? "FAILED (%d)\n" : "ok\n", fails);
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+// Host run of the firmware probes (Core/Src/fcs_probe.c) on the clock_gettime
+// backend, timing the ballistic solver (Core/Src/fcs_math.c).
+//
+//   gcc -O2 -DFCS_PROBE_HOST -I../Core/Inc probe_host.c ../Core/Src/fcs_probe.c ../Core/Src/fcs_math.c -lm -o probe_host
+//   ./probe_host [solves]
+//
+// Targets are spread over the firing table's range band. Each solve is timed
+// with the same PROBE_BEGIN/PROBE_END as the firmware's PROBE_SOLVE, and the
+// records are printed as the client prints the 0xCA dump. Host ticks are
+// scaled to FCS_PROBE_HOST_HZ so the bins read as target cycles, but the
+// times are host times: compare the shape, not the numbers, with a target dump.
+#include "fcs_probe.h"
+#include "fcs_math.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void Print_Stat(const FCS_ProbeStat_t *s) {
+  double us = 1e6 / FCS_PROBE_HOST_HZ;
+  printf("%-4.4s %8u %9.1f %9.1f %9.1f  ", s->name, (unsigned)s->count, s->min_cyc * us, s->mean_cyc * us,
+         s->max_cyc * us);
+  for (int b = 0; b < FCS_PROBE_BINS; b++) printf(s->hist[b] ? "%u " : ". ", (unsigned)s->hist[b]);
+  printf("\n");
+}
+
+int main(int argc, char **argv) {
+  int solves = (argc > 1) ? atoi(argv[1]) : 10000;
+  if (solves <= 0) solves = 10000;
+
+  FCS_System_t sys;
+  memset(&sys, 0, sizeof(sys));
+  sys.user_pos = (UTM_Coord_t){ .zone = 52, .band = 'S', .easting = 333712, .northing = 4132894, .altitude = 100 };
+  sys.env.air_temp = 15.0f;
+  sys.env.air_pressure = 1013.25f;
+  sys.env.prop_temp = 21.0f;
+  sys.fire.charge = 5;
+
+  for (int i = 0; i < solves; i++) {
+    double range = 500.0 + (i % 97) * 100.0; // 0.5 .. 10.1 km
+    double az = (i % 360) * 0.0174533;
+    sys.tgt_pos = sys.user_pos;
+    sys.tgt_pos.easting += range * sin(az);
+    sys.tgt_pos.northing += range * cos(az);
+    sys.tgt_pos.altitude = (float)(i % 50);
+    PROBE_BEGIN(PROBE_SOLVE);
+    FCS_Calculate_FireData(&sys);
+    PROBE_END(PROBE_SOLVE);
+  }
+
+  printf("Host figures (clock_gettime), not measured on the target\n");
+  printf("%-4s %8s %9s %9s %9s  log2 bins from < %u cycles\n", "NAME", "COUNT", "MIN us", "MEAN us", "MAX us",
+         1u << (FCS_PROBE_BIN_SHIFT + 1));
+  for (uint8_t i = 0; i < PROBE_COUNT; i++) {
+    FCS_ProbeStat_t s;
+    FCS_Probe_Stat(i, &s);
+    if (s.count > 0) Print_Stat(&s);
+  }
+  return 0;
+}
@@ -0,0 +1,107 @@
+// Host port of the CMSIS-RTOS2 subset used by Core/Src/fcs_rtos.c.
+//
+// Same names and signatures as the CMSIS-RTOS2 API, implemented on POSIX
+// threads in cmsis_os2_posix.c. Threads run SCHED_FIFO at their osPriority_t
+// value on a single CPU, so a ready higher-priority thread preempts a lower
+// one as it would on the target. Needs CAP_SYS_NICE (root); without it the
+// threads fall back to normal scheduling and a warning is printed.
+#ifndef CMSIS_OS2_H_
+#define CMSIS_OS2_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define osWaitForever       0xFFFFFFFFU
+
+#define osFlagsWaitAny      0x00000000U
+#define osFlagsWaitAll      0x00000001U
+#define osFlagsNoClear      0x00000002U
+#define osFlagsError        0x80000000U
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+#define osFlagsErrorResource 0xFFFFFFFDU
+
+#define osMutexRecursive    0x00000001U
+#define osMutexPrioInherit  0x00000002U
+
+typedef enum {
+  osOK = 0,
+  osError = -1,
+  osErrorTimeout = -2,
+  osErrorResource = -3,
+  osErrorParameter = -4,
+  osErrorNoMemory = -5,
+  osErrorISR = -6,
+  osStatusReserved = 0x7FFFFFFF
+} osStatus_t;
+
+typedef enum {
+  osPriorityNone = 0,
+  osPriorityIdle = 1,
+  osPriorityLow = 8,
+  osPriorityBelowNormal = 16,
+  osPriorityNormal = 24,
+  osPriorityAboveNormal = 32,
+  osPriorityHigh = 40,
+  osPriorityRealtime = 48,
+  osPriorityISR = 56,
+  osPriorityError = -1,
+  osPriorityReserved = 0x7FFFFFFF
+} osPriority_t;
+
+typedef void (*osThreadFunc_t)(void *argument);
+typedef void *osThreadId_t;
+typedef void *osMutexId_t;
+typedef void *osMessageQueueId_t;
+typedef uint32_t TZ_ModuleId_t;
+
+typedef struct {
+  const char *name;
+  uint32_t attr_bits;
+  void *cb_mem;
+  uint32_t cb_size;
+  void *stack_mem;
+  uint32_t stack_size;
+  osPriority_t priority;
+  TZ_ModuleId_t tz_module;
+  uint32_t reserved;
+} osThreadAttr_t;
+
+typedef struct {
+  const char *name;
+  uint32_t attr_bits;
+  void *cb_mem;
+  uint32_t cb_size;
+} osMutexAttr_t;
+
+typedef struct {
+  const char *name;
+  uint32_t attr_bits;
+  void *cb_mem;
+  uint32_t cb_size;
+  void *mq_mem;
+  uint32_t mq_size;
+} osMessageQueueAttr_t;
+
+osStatus_t osKernelInitialize(void);
+osStatus_t osKernelStart(void); // Host: starts the threads and returns; the caller becomes idle
+uint32_t osKernelGetTickCount(void);
+uint32_t osKernelGetTickFreq(void);
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr);
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags);
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout);
+osStatus_t osDelay(uint32_t ticks);
+osStatus_t osDelayUntil(uint32_t ticks);
+
+osMutexId_t osMutexNew(const osMutexAttr_t *attr);
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout);
+osStatus_t osMutexRelease(osMutexId_t mutex_id);
+
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr);
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout);
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout);
+
+// Host only: runs func at above every task priority (the model's interrupts)
+int osHostIsrThread(void *(*func)(void *), void *argument);
+
+#endif
@@ -0,0 +1,256 @@
+// CMSIS-RTOS2 subset on POSIX threads (see cmsis_os2.h).
+#define _GNU_SOURCE
+#include "cmsis_os2.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_THREADS  16
+#define ISR_PRIORITY 90  // Above osPriorityISR (56)
+
+typedef struct {
+  pthread_t th;
+  osThreadFunc_t func;
+  void *arg;
+  int prio;
+  uint32_t flags;
+  pthread_mutex_t m;
+  pthread_cond_t c;
+} Thread_t;
+
+typedef struct {
+  pthread_mutex_t m;
+  pthread_cond_t not_empty, not_full;
+  uint32_t count, size, head, used;
+  uint8_t *buf;
+} Queue_t;
+
+static Thread_t threads[MAX_THREADS];
+static int thread_count = 0;
+static __thread Thread_t *self = NULL;
+static struct timespec t_start;
+static int rt_ok = 1;
+
+// [1] Time: 1 kHz ticks from CLOCK_MONOTONIC
+static struct timespec Ts_Add_Ms(struct timespec t, uint32_t ms) {
+  t.tv_sec += ms / 1000U;
+  t.tv_nsec += (long)(ms % 1000U) * 1000000L;
+  if (t.tv_nsec >= 1000000000L) {
+    t.tv_sec++;
+    t.tv_nsec -= 1000000000L;
+  }
+  return t;
+}
+
+static struct timespec Ts_Deadline(uint32_t ms) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return Ts_Add_Ms(now, ms);
+}
+
+uint32_t osKernelGetTickCount(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  int64_t ms = (int64_t)(now.tv_sec - t_start.tv_sec) * 1000 + (now.tv_nsec - t_start.tv_nsec) / 1000000;
+  return (uint32_t)ms;
+}
+
+uint32_t osKernelGetTickFreq(void) {
+  return 1000U;
+}
+
+osStatus_t osDelay(uint32_t ticks) {
+  struct timespec t = Ts_Deadline(ticks);
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR) {
+  }
+  return osOK;
+}
+
+osStatus_t osDelayUntil(uint32_t ticks) {
+  struct timespec t = Ts_Add_Ms(t_start, ticks);
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR) {
+  }
+  return osOK;
+}
+
+static void Cond_Init(pthread_cond_t *c) {
+  pthread_condattr_t a;
+  pthread_condattr_init(&a);
+  pthread_condattr_setclock(&a, CLOCK_MONOTONIC);
+  pthread_cond_init(c, &a);
+  pthread_condattr_destroy(&a);
+}
+
+// Waits on c; 0 on signal, ETIMEDOUT after timeout ticks
+static int Cond_Wait(pthread_cond_t *c, pthread_mutex_t *m, uint32_t timeout, const struct timespec *deadline) {
+  if (timeout == osWaitForever) return pthread_cond_wait(c, m);
+  return pthread_cond_timedwait(c, m, deadline);
+}
+
+// [2] Kernel and threads
+osStatus_t osKernelInitialize(void) {
+  clock_gettime(CLOCK_MONOTONIC, &t_start);
+  // One CPU: a higher-priority thread that becomes ready preempts at once
+  cpu_set_t cpu;
+  CPU_ZERO(&cpu);
+  CPU_SET(0, &cpu);
+  sched_setaffinity(0, sizeof(cpu), &cpu);
+  return osOK;
+}
+
+static void *Thread_Entry(void *p) {
+  self = p;
+  self->func(self->arg);
+  return NULL;
+}
+
+static int Thread_Spawn(pthread_t *th, void *(*entry)(void *), void *arg, int prio) {
+  pthread_attr_t a;
+  pthread_attr_init(&a);
+  if (rt_ok) {
+    struct sched_param sp = { .sched_priority = prio };
+    pthread_attr_setinheritsched(&a, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&a, SCHED_FIFO);
+    pthread_attr_setschedparam(&a, &sp);
+  }
+  int rc = pthread_create(th, &a, entry, arg);
+  if (rc == EPERM && rt_ok) {
+    fprintf(stderr, "cmsis_os2_posix: no SCHED_FIFO (needs CAP_SYS_NICE), priorities not enforced\n");
+    rt_ok = 0;
+    rc = pthread_create(th, NULL, entry, arg);
+  }
+  pthread_attr_destroy(&a);
+  return rc;
+}
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr) {
+  if (thread_count == MAX_THREADS) return NULL;
+  Thread_t *t = &threads[thread_count++];
+  t->func = func;
+  t->arg = argument;
+  t->prio = (attr && attr->priority > 0) ? attr->priority : osPriorityNormal;
+  pthread_mutex_init(&t->m, NULL);
+  Cond_Init(&t->c);
+  return t;
+}
+
+// Threads made before the start run from here on; the caller keeps the CPU
+// only while every thread is blocked (it is the idle loop)
+osStatus_t osKernelStart(void) {
+  for (int i = 0; i < thread_count; i++) {
+    if (Thread_Spawn(&threads[i].th, Thread_Entry, &threads[i], threads[i].prio) != 0) return osError;
+  }
+  return osOK;
+}
+
+int osHostIsrThread(void *(*func)(void *), void *argument) {
+  pthread_t th;
+  return Thread_Spawn(&th, func, argument, ISR_PRIORITY);
+}
+
+// [3] Thread flags
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags) {
+  Thread_t *t = thread_id;
+  pthread_mutex_lock(&t->m);
+  t->flags |= flags;
+  uint32_t now = t->flags;
+  pthread_cond_signal(&t->c);
+  pthread_mutex_unlock(&t->m);
+  return now;
+}
+
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout) {
+  Thread_t *t = self;
+  struct timespec deadline = Ts_Deadline(timeout == osWaitForever ? 0 : timeout);
+  uint32_t got;
+  pthread_mutex_lock(&t->m);
+  for (;;) {
+    got = t->flags & flags;
+    if ((options & osFlagsWaitAll) ? got == flags : got != 0) break;
+    if (timeout == 0 || Cond_Wait(&t->c, &t->m, timeout, &deadline) == ETIMEDOUT) {
+      pthread_mutex_unlock(&t->m);
+      return timeout == 0 ? osFlagsErrorResource : osFlagsErrorTimeout;
+    }
+  }
+  if (!(options & osFlagsNoClear)) t->flags &= ~got;
+  pthread_mutex_unlock(&t->m);
+  return got;
+}
+
+// [4] Mutexes
+osMutexId_t osMutexNew(const osMutexAttr_t *attr) {
+  pthread_mutex_t *m = malloc(sizeof(*m));
+  pthread_mutexattr_t a;
+  pthread_mutexattr_init(&a);
+  uint32_t bits = attr ? attr->attr_bits : 0;
+  if (bits & osMutexRecursive) pthread_mutexattr_settype(&a, PTHREAD_MUTEX_RECURSIVE);
+  if (bits & osMutexPrioInherit) pthread_mutexattr_setprotocol(&a, PTHREAD_PRIO_INHERIT);
+  pthread_mutex_init(m, &a);
+  pthread_mutexattr_destroy(&a);
+  return m;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout) {
+  if (timeout == osWaitForever) return pthread_mutex_lock(mutex_id) ? osError : osOK;
+  if (timeout == 0) return pthread_mutex_trylock(mutex_id) ? osErrorResource : osOK;
+  struct timespec deadline = Ts_Deadline(timeout);
+  return pthread_mutex_clocklock(mutex_id, CLOCK_MONOTONIC, &deadline) ? osErrorTimeout : osOK;
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id) {
+  return pthread_mutex_unlock(mutex_id) ? osError : osOK;
+}
+
+// [5] Message queues (FIFO; msg_prio is ignored)
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr) {
+  (void)attr;
+  Queue_t *q = calloc(1, sizeof(*q));
+  q->buf = malloc((size_t)msg_count * msg_size);
+  q->count = msg_count;
+  q->size = msg_size;
+  pthread_mutex_init(&q->m, NULL);
+  Cond_Init(&q->not_empty);
+  Cond_Init(&q->not_full);
+  return q;
+}
+
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout) {
+  (void)msg_prio;
+  Queue_t *q = mq_id;
+  struct timespec deadline = Ts_Deadline(timeout == osWaitForever ? 0 : timeout);
+  pthread_mutex_lock(&q->m);
+  while (q->used == q->count) {
+    if (timeout == 0 || Cond_Wait(&q->not_full, &q->m, timeout, &deadline) == ETIMEDOUT) {
+      pthread_mutex_unlock(&q->m);
+      return timeout == 0 ? osErrorResource : osErrorTimeout;
+    }
+  }
+  memcpy(&q->buf[((q->head + q->used) % q->count) * q->size], msg_ptr, q->size);
+  q->used++;
+  pthread_cond_signal(&q->not_empty);
+  pthread_mutex_unlock(&q->m);
+  return osOK;
+}
+
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout) {
+  Queue_t *q = mq_id;
+  struct timespec deadline = Ts_Deadline(timeout == osWaitForever ? 0 : timeout);
+  pthread_mutex_lock(&q->m);
+  while (q->used == 0) {
+    if (timeout == 0 || Cond_Wait(&q->not_empty, &q->m, timeout, &deadline) == ETIMEDOUT) {
+      pthread_mutex_unlock(&q->m);
+      return timeout == 0 ? osErrorResource : osErrorTimeout;
+    }
+  }
+  memcpy(msg_ptr, &q->buf[q->head * q->size], q->size);
+  q->head = (q->head + 1) % q->count;
+  q->used--;
+  if (msg_prio) *msg_prio = 0;
+  pthread_cond_signal(&q->not_full);
+  pthread_mutex_unlock(&q->m);
+  return osOK;
+}
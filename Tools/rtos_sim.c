@@ -0,0 +1,262 @@
+// Host run of the RTOS build's task layout (Core/Src/fcs_rtos.c) on the POSIX
+// port in rtos_posix/, with modelled task bodies as in sched_sim.c.
+//
+//   gcc -O2 -pthread -DFCS_USE_RTOS=1 -I../Core/Inc -Irtos_posix -o rtos_sim rtos_sim.c
+//       ../Core/Src/fcs_rtos.c ../Core/Src/fcs_sched.c rtos_posix/cmsis_os2_posix.c
+//   sudo ./rtos_sim [seconds] [seed] [coop]
+//
+// Link frames come from a top-priority "ISR" thread. The time from a frame's
+// arrival to its reply is recorded, split by whether a panel push was in
+// progress when it arrived. 'coop' runs the same bodies under the cooperative
+// scheduler (fcs_sched.c, as main.c) for comparison. Costs are busy-waits on
+// the thread's CPU clock, so a preempted body takes longer in wall time as it
+// would on the target. They are estimates, not measurements:
+//   LINK  parse one frame                        ~50 us
+//   SER   one request (solve + reply)            ~400 us
+//   KEY   4 polled ADC conversions + UI logic     ~60 us
+//   BMP   6-byte I2C read at 100 kHz              ~800 us
+//   LCD   full SSD1306 push, 1112 bytes at 100 kHz ~100 ms (compare only: ~20 us)
+//
+// Exit 1 if an RTOS run answers a frame that arrived during a push later than
+// FAIL_PUSH_US: the mission task must not wait for the display.
+#define _GNU_SOURCE
+#include "fcs_rtos.h"
+#include "fcs_sched.h"
+#include "cmsis_os2.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define COST_LINK_US    50
+#define COST_SER_US     400
+#define COST_KEY_US     60
+#define COST_BMP_US     800
+#define COST_LCD_US     100000
+#define COST_CMP_US     20
+
+#define FRAME_MEAN_MS   300
+#define KEY_MEAN_MS     1500
+#define BMP_CHANGE_1_IN 4
+
+#define FAIL_PUSH_US    10000
+
+static int coop = 0;
+
+static uint64_t Now_Ns(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static void Spend(uint32_t us) {
+  struct timespec t;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  uint64_t end = (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec + (uint64_t)us * 1000U;
+  do {
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  } while ((uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec < end);
+}
+
+// [Link] "ISR" -> ring (single producer, single consumer) -> jobs
+typedef struct {
+  uint64_t arrival_ns;
+  int during_push;
+} Frame_t;
+
+#define RING 64
+static Frame_t ring[RING];
+static volatile uint32_t ring_head = 0, ring_tail = 0;
+static volatile int lcd_pushing = 0;
+static volatile int lcd_dirty = 1;
+static volatile int key_edge = 0;
+
+// Reply latency per class: [0] display idle, [1] push in progress
+static uint64_t lat_max[2], lat_sum[2];
+static uint32_t lat_n[2], dropped = 0, pushes = 0;
+
+static uint32_t run_s;
+static osThreadId_t coop_thread;
+enum { TASK_SERIAL, TASK_KEYS, TASK_SENSOR, TASK_DISPLAY, TASK_LED, TASK_COUNT };
+static FCS_Task_t tasks[TASK_COUNT];
+
+static uint32_t Rand_Ms(uint32_t mean) {
+  return (uint32_t)(rand() % (2 * mean) + 1);
+}
+
+static int Report(void);
+
+static void *Isr_Thread(void *arg) {
+  (void)arg;
+  uint64_t end = Now_Ns() + (uint64_t)run_s * 1000000000ULL;
+  uint64_t next_frame = Now_Ns() + Rand_Ms(FRAME_MEAN_MS) * 1000000ULL;
+  uint64_t next_key = Now_Ns() + Rand_Ms(KEY_MEAN_MS) * 1000000ULL;
+  for (;;) {
+    uint64_t next = next_frame < next_key ? next_frame : next_key;
+    if (next >= end) {
+      fflush(stdout);
+      exit(Report());
+    }
+    struct timespec t = { (time_t)(next / 1000000000ULL), (long)(next % 1000000000ULL) };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL);
+    uint64_t now = Now_Ns();
+    if (now >= next_key) {
+      key_edge = 1; // Seen by the next key scan
+      next_key = now + Rand_Ms(KEY_MEAN_MS) * 1000000ULL;
+    }
+    if (now < next_frame) continue;
+    next_frame = now + Rand_Ms(FRAME_MEAN_MS) * 1000000ULL;
+    if (ring_head - ring_tail == RING) {
+      dropped++;
+      continue;
+    }
+    ring[ring_head % RING] = (Frame_t){ now, lcd_pushing };
+    __atomic_store_n(&ring_head, ring_head + 1, __ATOMIC_RELEASE);
+    if (coop) {
+      FCS_Sched_Signal(&tasks[TASK_SERIAL]);
+      osThreadFlagsSet(coop_thread, 1);
+    } else {
+      FCS_Rtos_Link_Wake();
+    }
+  }
+  return NULL;
+}
+
+static void Reply(Frame_t *f) {
+  uint64_t lat = (Now_Ns() - f->arrival_ns) / 1000U;
+  int c = f->during_push;
+  if (lat > lat_max[c]) lat_max[c] = lat;
+  lat_sum[c] += lat;
+  lat_n[c]++;
+}
+
+// [Bodies] Shared by both runs
+static Frame_t jobs[RING];
+static uint32_t job_n = 0;
+
+uint32_t FCS_App_Link(void) {
+  while (ring_tail != __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE)) {
+    Frame_t *f = &jobs[job_n++ % RING];
+    *f = ring[ring_tail % RING];
+    ring_tail++;
+    Spend(COST_LINK_US);
+    if (coop) {
+      Spend(COST_SER_US); // Job runs inline in the serial task
+      Reply(f);
+      lcd_dirty = 1;
+      FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+    } else if (!FCS_Rtos_Post_Job(f)) {
+      dropped++; // NAK BUSY
+    }
+  }
+  return 0;
+}
+
+void FCS_App_Mission(void *job) {
+  FCS_Rtos_State_Lock();
+  Spend(COST_SER_US);
+  FCS_Rtos_State_Unlock();
+  Reply(job);
+  lcd_dirty = 1;
+  FCS_Rtos_Redraw();
+}
+
+void FCS_App_Keys(void) {
+  Spend(COST_KEY_US);
+  if (key_edge) {
+    key_edge = 0;
+    lcd_dirty = 1;
+    if (coop) FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+    else FCS_Rtos_Redraw();
+  }
+}
+
+uint8_t FCS_App_Boot(void) {
+  return 1; // Devices up from the start (bring-up is modelled in boot_sim.c)
+}
+
+void FCS_App_Sensor(void) {
+  FCS_Rtos_Bus_Lock(); // As main.c: waits out a push
+  Spend(COST_BMP_US);
+  FCS_Rtos_Bus_Unlock();
+  if (rand() % BMP_CHANGE_1_IN == 0) lcd_dirty = 1;
+  if (coop) FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+  else FCS_Rtos_Redraw();
+}
+
+void FCS_App_Display(void) {
+  FCS_Rtos_State_Lock();
+  Spend(COST_CMP_US);
+  int dirty = lcd_dirty;
+  lcd_dirty = 0;
+  FCS_Rtos_State_Unlock();
+  if (!dirty) return;
+  pushes++;
+  FCS_Rtos_Bus_Lock();
+  lcd_pushing = 1;
+  Spend(COST_LCD_US);
+  lcd_pushing = 0;
+  FCS_Rtos_Bus_Unlock();
+}
+
+// [Cooperative run] main.c's task table in one thread
+static void Coop_Serial(void) { FCS_App_Link(); }
+static void Coop_Led(void) { Spend(2); }
+
+static uint32_t Coop_Now_Us(void) {
+  return (uint32_t)(Now_Ns() / 1000U);
+}
+
+static void Coop_Thread(void *arg) {
+  (void)arg;
+  for (;;) {
+    FCS_Sched_Run();
+    uint32_t idle = FCS_Sched_Idle_Us();
+    if (idle > 0) osThreadFlagsWait(1, osFlagsWaitAny, idle == UINT32_MAX ? osWaitForever : (idle + 999U) / 1000U);
+  }
+}
+
+static int Report(void) {
+  static const char *cls[2] = { "display idle", "during push" };
+  printf("%s run: %u panel pushes, %u frames dropped\n", coop ? "Cooperative" : "RTOS", (unsigned)pushes,
+         (unsigned)dropped);
+  for (int c = 0; c < 2; c++) {
+    printf("  %-13s %5u frames, reply mean %6.0f us, worst %6u us\n", cls[c], (unsigned)lat_n[c],
+           lat_n[c] ? (double)lat_sum[c] / lat_n[c] : 0.0, (unsigned)lat_max[c]);
+  }
+  if (!coop && lat_max[1] > FAIL_PUSH_US) {
+    printf("FAIL: a frame waited %u us behind a panel push\n", (unsigned)lat_max[1]);
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  run_s = (argc > 1) ? (uint32_t)atoi(argv[1]) : 20;
+  srand((argc > 2) ? (unsigned)atoi(argv[2]) : 1);
+  coop = (argc > 3) && strcmp(argv[3], "coop") == 0;
+  if (run_s == 0 || run_s > 600) run_s = 20;
+
+  osKernelInitialize(); // Pins this thread (and all spawned from it) to one CPU
+  if (coop) {
+    FCS_Task_t table[TASK_COUNT] = {
+      [TASK_SERIAL]  = FCS_TASK("SER", Coop_Serial, FCS_TASK_SERIAL_MS, 20),
+      [TASK_KEYS]    = FCS_TASK("KEY", FCS_App_Keys, FCS_TASK_KEYS_MS, 0),
+      [TASK_SENSOR]  = FCS_TASK("BMP", FCS_App_Sensor, FCS_TASK_SENSOR_MS, 0),
+      [TASK_DISPLAY] = FCS_TASK("LCD", FCS_App_Display, FCS_TASK_DISPLAY_MS, 0),
+      [TASK_LED]     = FCS_TASK("LED", Coop_Led, FCS_TASK_LED_MS, 0),
+    };
+    memcpy(tasks, table, sizeof(table));
+    FCS_Sched_Init(tasks, TASK_COUNT, Coop_Now_Us);
+    static const osThreadAttr_t loop_attr = { .name = "LOOP", .priority = osPriorityNormal };
+    coop_thread = osThreadNew(Coop_Thread, NULL, &loop_attr);
+  }
+  osHostIsrThread(Isr_Thread, NULL);
+  if (coop) {
+    osKernelStart();
+    for (;;) pause();
+  }
+  FCS_Rtos_Start(); // Does not return; the ISR thread ends the run
+  return 0;
+}
@@ -0,0 +1,350 @@
+// Host run of the firmware scheduler (Core/Src/fcs_sched.c) on a virtual clock.
+//
+//   gcc -O2 -I../Core/Inc sched_sim.c ../Core/Src/fcs_sched.c -o sched_sim
+//   ./sched_sim [seconds] [seed] [quiet|stall]
+//
+// 'quiet' drops the link traffic and the operator: the UI_WAITING idle case.
+// 'stall' makes every BMP280 read run into its 100 ms I2C timeout from
+// half-time on, as with a bus held low: the watchdog must reset the loop.
+//
+// The task table mirrors main.c (same rates from fcs_sched.h, same priority
+// order, same idle key scan and event-driven display/serial). Task bodies only
+// advance the clock by a modelled cost; link frames, key presses and knob
+// moves arrive at random times as the ISRs would deliver them. Sleep follows
+// fcs_power.c: wake at the first 1 ms tick boundary at or after the next
+// release, or at the next interrupt. Costs are estimates from the bus
+// traffic, not measurements:
+//   KEY  4 polled ADC conversions + UI logic     ~60 us
+//   BMP  6-byte I2C read at 100 kHz              ~800 us
+//   LCD  full SSD1306 push, 1112 bytes at 100 kHz ~100 ms (compare only: ~20 us)
+//   SER  one request (parse + solve + reply)     ~400 us
+//
+// Checks (exit 1 on failure):
+// [1] No drift: for the purely periodic tasks, runs + skipped releases match
+//     the elapsed periods.
+// [2] Bounded blocking: the top-priority task (SER) starts no later than the
+//     longest run of any other task after its release. Lower tasks also wait
+//     for everything above them, so theirs is only reported.
+// [3] Every link frame is answered within that bound plus its own run.
+// [4] The panel is pushed once per change, never for an unchanged screen.
+// [5] Idle key scan: no scan runs unless a key, knob or sensor wake asked for it.
+// [6] Deadline watchdog, modelled as main.c feeds it (fcs_wdg.h): a normal run
+//     is never reset (panel pushes overrun the pass budget but do not saturate
+//     the loop); a stalled run is, within 4 x FCS_SCHED_TRIP_WINDOWS windows
+//     plus the watchdog timeout (pushes decide whether a window is missed, and
+//     a window closes only when a pass ends). The reset ends the run.
+// It also prints the busy time of the old 50 Hz superloop under the same load.
+#include "fcs_sched.h"
+#include "fcs_wdg.h"
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COST_KEY_US     60
+#define COST_BMP_US     800
+#define COST_LCD_US     100000
+#define COST_CMP_US     20
+#define COST_SER_US     400
+#define COST_POLL_US    20
+#define COST_LED_US     2
+#define COST_STALL_US   100000 // BMP280 read timing out (bmp280.c I2C timeout)
+
+#define FRAME_MEAN_MS   300   // Link requests
+#define KEY_MEAN_MS     1500  // Operator key presses
+#define KEY_HOLD_MS     150
+#define KNOB_MEAN_MS    20000 // Knob turns
+#define BMP_CHANGE_1_IN 4     // Samples that change the shown temperature
+
+#define KEYS_IDLE_SCANS 50    // As main.c
+
+static uint32_t v_now = 0;
+static uint32_t Sim_Now(void) { return v_now; }
+
+enum { TASK_SERIAL, TASK_KEYS, TASK_SENSOR, TASK_DISPLAY, TASK_LED, TASK_COUNT };
+static FCS_Task_t tasks[TASK_COUNT];
+
+// [Events] Next arrival of each source and what is waiting
+static uint32_t ev_frame_at, ev_key_at, ev_knob_at;
+static uint32_t rx_arrival[64];
+static int rx_count = 0;
+static uint32_t key_up_at = 0;  // Key held until
+static int key_edge = 0;
+static int knob_moved = 0;
+static int lcd_dirty = 1;
+static uint32_t resp_max_us = 0, frames = 0, pushes = 0, changes = 1;
+
+// Key scan mode (main.c): idle waits for the ADC watchdog
+static int keys_idle = 0, keys_armed = 0, keys_quiet = 0;
+static uint32_t idle_scans = 0, awd_wakes = 0, key_wait_max_us = 0, key_pressed_at = 0;
+
+static int quiet = 0;
+static int stall = 0;
+static uint32_t stall_at = 0;
+
+// Watchdog: fed after healthy passes; expiry is a reset and ends the run
+static uint32_t wdg_fed = 0, wdg_gap_max = 0;
+static jmp_buf wdg_reset;
+
+static void Sim_Wdg_Check(void) {
+  if (v_now - wdg_fed > FCS_WDG_TIMEOUT_MS * 1000U) longjmp(wdg_reset, 1);
+}
+
+static uint32_t Rand_Ms(uint32_t mean) {
+  if (quiet) return 0x7FFFFFFFU; // Never within the run
+  return (uint32_t)(rand() % (2 * mean) + 1) * 1000U;
+}
+
+// ISRs: whatever is due by v_now
+static void Sim_Deliver(void) {
+  while ((int32_t)(v_now - ev_frame_at) >= 0) {
+    if (rx_count < 64) rx_arrival[rx_count++] = ev_frame_at;
+    ev_frame_at += Rand_Ms(FRAME_MEAN_MS);
+    FCS_Sched_Signal(&tasks[TASK_SERIAL]);
+  }
+  while ((int32_t)(v_now - ev_key_at) >= 0) {
+    key_edge = 1; // Seen by the next key scan
+    key_up_at = ev_key_at + KEY_HOLD_MS * 1000U;
+    key_pressed_at = ev_key_at;
+    ev_key_at += KEY_HOLD_MS * 1000U + Rand_Ms(KEY_MEAN_MS);
+    if (keys_armed) {
+      keys_armed = 0; // HAL_ADC_LevelOutOfWindowCallback
+      awd_wakes++;
+      FCS_Sched_Signal(&tasks[TASK_KEYS]);
+    }
+  }
+  while ((int32_t)(v_now - ev_knob_at) >= 0) {
+    knob_moved = 1;
+    ev_knob_at += Rand_Ms(KNOB_MEAN_MS);
+  }
+}
+
+// Task body cost; interrupts keep arriving meanwhile
+static void Sim_Spend(uint32_t us) {
+  while (us > 0) {
+    uint32_t step = us < 100 ? us : 100;
+    v_now += step;
+    us -= step;
+    Sim_Deliver();
+    Sim_Wdg_Check();
+  }
+}
+
+static void Task_Serial(void) {
+  if (rx_count == 0) {
+    Sim_Spend(COST_POLL_US);
+  } else {
+    uint32_t arrival = rx_arrival[0];
+    for (int i = 1; i < rx_count; i++) rx_arrival[i - 1] = rx_arrival[i];
+    rx_count--;
+    Sim_Spend(COST_SER_US);
+    if (v_now - arrival > resp_max_us) resp_max_us = v_now - arrival;
+    frames++;
+    if (rx_count > 0) FCS_Sched_Signal(&tasks[TASK_SERIAL]); // FCS_Serial_Busy()
+  }
+  FCS_Sched_Set_Period(&tasks[TASK_SERIAL], 0);              // No telemetry subscribed
+  FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+}
+
+static void Keys_Set_Idle(int idle) {
+  keys_idle = idle;
+  keys_quiet = 0;
+  FCS_Sched_Set_Period(&tasks[TASK_KEYS], idle ? 0 : FCS_TASK_KEYS_MS);
+}
+
+static void Task_Keys(void) {
+  keys_armed = 0;
+  Sim_Spend(COST_KEY_US);
+  int held = (int32_t)(v_now - key_up_at) < 0;
+  if (keys_idle) idle_scans++;
+  if (key_edge) {
+    key_edge = 0;
+    lcd_dirty = 1;
+    changes++;
+    if (v_now - key_pressed_at > key_wait_max_us) key_wait_max_us = v_now - key_pressed_at;
+    FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+  }
+  if (held || knob_moved) {
+    if (knob_moved) {
+      knob_moved = 0;
+      lcd_dirty = 1;
+      changes++;
+      FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+    }
+    if (keys_idle) Keys_Set_Idle(0);
+    keys_quiet = 0;
+  } else if (!keys_idle && ++keys_quiet >= KEYS_IDLE_SCANS) {
+    Keys_Set_Idle(1);
+  }
+  if (keys_idle) keys_armed = 1;
+}
+
+static void Task_Sensor(void) {
+  Sim_Spend(stall && v_now >= stall_at ? COST_STALL_US : COST_BMP_US);
+  if (rand() % BMP_CHANGE_1_IN == 0) {
+    lcd_dirty = 1;
+    changes++;
+  }
+  FCS_Sched_Signal(&tasks[TASK_DISPLAY]);
+  if (keys_idle) FCS_Sched_Signal(&tasks[TASK_KEYS]);
+}
+
+static void Task_Display(void) {
+  Sim_Spend(COST_CMP_US);
+  if (!lcd_dirty) return;
+  lcd_dirty = 0;
+  pushes++;
+  Sim_Spend(COST_LCD_US);
+}
+
+static void Task_Led(void) {
+  Sim_Spend(COST_LED_US);
+}
+
+int main(int argc, char **argv) {
+  static uint32_t seconds;
+  seconds = (argc > 1) ? (uint32_t)atoi(argv[1]) : 600;
+  srand((argc > 2) ? (unsigned)atoi(argv[2]) : 1);
+  if (seconds == 0 || seconds > 3600) seconds = 600; // uint32_t us wraps at 71 min
+  quiet = (argc > 3) && strcmp(argv[3], "quiet") == 0;
+  stall = (argc > 3) && strcmp(argv[3], "stall") == 0;
+
+  // As main.c
+  FCS_Task_t table[TASK_COUNT] = {
+    [TASK_SERIAL]  = FCS_TASK("SER", Task_Serial, FCS_TASK_SERIAL_MS, 20),
+    [TASK_KEYS]    = FCS_TASK("KEY", Task_Keys, FCS_TASK_KEYS_MS, 0),
+    [TASK_SENSOR]  = FCS_TASK("BMP", Task_Sensor, FCS_TASK_SENSOR_MS, 0),
+    [TASK_DISPLAY] = FCS_TASK("LCD", Task_Display, FCS_TASK_DISPLAY_MS, 0),
+    [TASK_LED]     = FCS_TASK("LED", Task_Led, FCS_TASK_LED_MS, 0),
+  };
+  for (int i = 0; i < TASK_COUNT; i++) tasks[i] = table[i];
+
+  ev_frame_at = Rand_Ms(FRAME_MEAN_MS);
+  ev_key_at = Rand_Ms(KEY_MEAN_MS);
+  ev_knob_at = Rand_Ms(KNOB_MEAN_MS);
+  FCS_Sched_Init(tasks, TASK_COUNT, Sim_Now);
+
+  // Static: kept across the longjmp of a watchdog reset
+  static uint32_t end, wakes = 0, starved_at = 0, missed_max = 0;
+  static uint64_t busy = 0, slept = 0;
+  static int reset = 0;
+  end = seconds * 1000000U;
+  stall_at = end / 2;
+  if (setjmp(wdg_reset)) {
+    reset = 1;
+    end = v_now;
+  }
+  while (v_now < end) {
+    busy += FCS_Sched_Run();
+    if (FCS_Sched_Healthy()) {
+      if (v_now - wdg_fed > wdg_gap_max) wdg_gap_max = v_now - wdg_fed;
+      wdg_fed = v_now;
+    } else if (!starved_at) {
+      starved_at = v_now; // The monitor stopped feeding
+    }
+    if (FCS_Sched_Pass()->missed > missed_max) missed_max = FCS_Sched_Pass()->missed;
+    // Tickless WFI: to the first tick boundary at or after the next release
+    // (the tick itself if that is within 2 ticks), or the next interrupt
+    uint32_t idle = FCS_Sched_Idle_Us();
+    if (idle == 0) continue;
+    uint32_t tick0 = v_now - v_now % 1000U;
+    uint32_t ticks = (v_now - tick0 + (idle > 199000U ? 199000U : idle) + 999U) / 1000U;
+    uint32_t wake = tick0 + (ticks < 2 ? 1 : ticks) * 1000U;
+    // Interrupts: link bytes always; key presses only while the watchdog is armed
+    if ((int32_t)(ev_frame_at - wake) < 0) wake = ev_frame_at;
+    if (keys_armed && (int32_t)(ev_key_at - wake) < 0) wake = ev_key_at;
+    if ((int32_t)(wake - v_now) > 0) {
+      slept += wake - v_now;
+      v_now = wake;
+      Sim_Wdg_Check();
+    }
+    wakes++;
+    Sim_Deliver();
+  }
+
+  int fails = 0;
+  uint32_t longest = 0;
+  for (int i = 0; i < TASK_COUNT; i++) {
+    if (tasks[i].max_us > longest) longest = tasks[i].max_us;
+  }
+
+  printf("%u s virtual, %u frames, CPU busy %.1f%%, asleep %.1f%%, %.1f wake-ups/s (1 ms tick: 1000/s)\n",
+         (unsigned)(v_now / 1000000U), (unsigned)frames, 100.0 * (double)busy / v_now, 100.0 * (double)slept / v_now,
+         (double)wakes * 1e6 / v_now);
+  printf("%-4s %7s %8s %9s %8s %8s %8s %10s\n", "task", "period", "runs", "overruns", "skipped", "mean_us",
+         "max_us", "max_late");
+  for (int i = 0; i < TASK_COUNT; i++) {
+    const FCS_Task_t *t = FCS_Sched_Task((uint8_t)i);
+    printf("%-4s %5u ms %8u %9u %8u %8u %8u %10u\n", t->name, (unsigned)(t->period_us / 1000),
+           (unsigned)t->runs, (unsigned)t->overruns, (unsigned)t->skipped,
+           (unsigned)(t->runs ? t->total_us / t->runs : 0), (unsigned)t->max_us, (unsigned)t->max_late_us);
+
+    // [1] Drift: every elapsed period was either run or skipped (a reset cuts a pass short)
+    if (!reset && (i == TASK_SENSOR || i == TASK_LED)) {
+      uint32_t releases = (v_now - 1) / t->period_us + 1;
+      uint32_t seen = t->runs + t->skipped;
+      if (seen + 1 < releases || seen > releases) {
+        printf("FAIL: %s drift, %u releases, %u runs + skipped\n", t->name, (unsigned)releases, (unsigned)seen);
+        fails++;
+      }
+    }
+    // [2] Blocking bound
+    if (i == TASK_SERIAL && t->max_late_us > longest) {
+      printf("FAIL: %s started %u us late, longest run is %u us\n", t->name, (unsigned)t->max_late_us,
+             (unsigned)longest);
+      fails++;
+    }
+  }
+  // [3] Response bound
+  printf("Link response: worst %u us (bound %u us)\n", (unsigned)resp_max_us, (unsigned)(longest + COST_SER_US));
+  if (resp_max_us > longest + COST_SER_US) {
+    printf("FAIL: link response\n");
+    fails++;
+  }
+  // [4] Pushes per change (changes between two draws fold into one push)
+  printf("Panel: %u pushes for %u changes\n", (unsigned)pushes, (unsigned)changes);
+  if (pushes > changes) {
+    printf("FAIL: panel pushed without a change\n");
+    fails++;
+  }
+
+  // [5] Idle key scans: one per sensor wake and per watchdog trip, nothing else
+  printf("Keys: %u watchdog wakes, %u idle scans, worst press -> scan %u us\n", (unsigned)awd_wakes,
+         (unsigned)idle_scans, (unsigned)key_wait_max_us);
+  if (idle_scans > tasks[TASK_SENSOR].runs + awd_wakes) {
+    printf("FAIL: key scan ran while idle without a wake\n");
+    fails++;
+  }
+
+  // [6] Deadline monitor
+  const FCS_SchedPass_t *pass = FCS_Sched_Pass();
+  printf("Passes: %u, %u over %u ms, worst %u us (%s), %u in a row\n", (unsigned)pass->passes,
+         (unsigned)pass->overruns, FCS_SCHED_PASS_BUDGET_US / 1000U, (unsigned)pass->max_us,
+         pass->max_task >= 0 ? tasks[pass->max_task].name : "-", (unsigned)pass->max_streak);
+  printf("Watchdog: longest gap between feeds %u ms (timeout %u ms), most missed windows in a row %u of %u\n",
+         (unsigned)(wdg_gap_max / 1000U), FCS_WDG_TIMEOUT_MS, (unsigned)missed_max, FCS_SCHED_TRIP_WINDOWS);
+  if (stall) {
+    uint32_t bound = stall_at + 4U * FCS_SCHED_TRIP_WINDOWS * FCS_SCHED_WINDOW_US + FCS_WDG_TIMEOUT_MS * 1000U;
+    printf("Stall at %u ms: ", (unsigned)(stall_at / 1000U));
+    if (reset) {
+      printf("reset at %u ms (bound %u ms), %s\n", (unsigned)(v_now / 1000U), (unsigned)(bound / 1000U),
+             starved_at ? "monitor stopped feeding" : "a pass never returned");
+    } else {
+      printf("no reset\n");
+    }
+    if (!reset || v_now < stall_at || v_now > bound) {
+      printf("FAIL: stalled loop not reset by the watchdog\n");
+      fails++;
+    }
+  } else if (reset || starved_at) {
+    printf("FAIL: watchdog %s at %u ms without a stall\n", reset ? "reset" : "starved",
+           (unsigned)((reset ? v_now : starved_at) / 1000U));
+    fails++;
+  }
+
+  // Old superloop: every task each 20 ms and a full panel push every pass
+  double loop_pass = COST_KEY_US + COST_BMP_US + COST_LCD_US + COST_POLL_US;
+  printf("50 Hz superloop under the same model: %.0f ms per pass (CPU busy 100%%, %.1f Hz actual)\n",
+         loop_pass / 1000.0, 1e6 / loop_pass);
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,434 @@
+// Host stand-in for the link UART: the receive path of Core/Src/fcs_core.c
+// (ring, flow control, parser, job queue) under sustained overload.
+//
+//   SRC="../Core/Src/fcs_codec.c ../Core/Src/fcs_aead.c ../Core/Src/fcs_math.c ../Core/Src/fcs_sched.c
+//        ../Core/Src/fcs_probe.c ../Core/Src/fcs_fmt.c ../Core/Src/fcs_clock.c"
+//   gcc -O2 -Wall -DFCS_FLOW_CTRL=1 -DFCS_CLOCK_HOST -Ihal_host -I../Core/Inc uart_sim.c $SRC -lm -o uart_sim
+//   ./uart_sim [lag] [seconds]
+//
+// Build it with FCS_FLOW_CTRL=1 (RTS/CTS) and 2 (XON/XOFF), each with and
+// without -DFCS_PROTO_COBS=1 for the two parsers. Add -fsanitize=address to
+// also catch a copy past p_raw. Built with FCS_FLOW_CTRL=0 it only reports
+// what the same run loses.
+//
+// fcs_core.c is compiled into this file so the checks can read the ring.
+// The HAL calls it makes are the wire (hal_host/ has the types): a byte takes
+// 10 bit times at FCS_BAUD_DEFAULT each way, the RX interrupt runs between
+// main loop steps and during HAL_UART_Transmit, which blocks as on the target.
+// The main loop follows main.c: the serial task runs when a byte arrives (or
+// every FCS_TASK_SERIAL_MS while it has timed work) and a panel push blocks
+// everything else for 100 ms every 200 ms.
+//
+// The sender streams status and binary target requests back to back without
+// waiting for replies, so it offers the whole line while the firmware can
+// take about a fifth of it (replies are longer than requests). Every 2 s,
+// right after a resume, it sends 140 junk bytes closed by 0x00: longer than
+// any frame, and short enough to land in the ring whole from the low mark
+// while the pool is full and the parser leaves the ring alone. It stops after
+// 'lag' more bytes once RTS is raised or XOFF has arrived (default 16: module
+// FIFO and radio latency; the ring has 63 bytes above the high mark), and
+// starts again on release/XON.
+//
+// Checks (exit 1 on failure):
+// [1] No byte lost: no ring overflow, and every request is answered once, in
+//     order, by its own reply (no NAK).
+// [2] Water marks: the sender is paused with the ring at FCS_FLOW_HIGH_WATER
+//     and resumed at or below FCS_FLOW_LOW_WATER; the ring fills past the
+//     size of p_raw, so a wrapped span longer than a frame can be met.
+// [3] COBS: every junk run is dropped as a framing error (two at most: the
+//     part seen before its delimiter and the rest). With a lag of 16 or
+//     more some runs reach the parser whole and across the ring end: the
+//     span p_raw cannot hold.
+// Byte counts are from the model, not measured on hardware.
+#include "../Core/Src/fcs_core.c"
+#include <stdio.h>
+
+#if FCS_PROTO_AEAD
+#error "uart_sim models the XOR frame version: build without FCS_PROTO_AEAD"
+#endif
+
+#define LCD_PERIOD_MS    200
+#define LCD_PUSH_MS      100     // Full SSD1306 push at 100 kHz (estimate)
+#define PASS_COST_US     20      // One serial task pass with nothing to do
+#define JUNK_EVERY_MS    2000
+#define JUNK_LEN         140
+#define DRAIN_MS         5000    // After the run: let the last replies out
+#define MAX_REQS         8192
+
+// [HAL stand-in state]
+DWT_Type hal_host_dwt;
+CoreDebug_Type hal_host_coredebug;
+GPIO_TypeDef hal_host_gpio[3];
+USART_TypeDef hal_host_usart[2] = { { USART_SR_TXE, 0 }, { USART_SR_TXE, 0 } };
+uint32_t SystemCoreClock = 84000000U;
+UART_HandleTypeDef huart1 = { .Instance = USART1, .Init = { .BaudRate = FCS_BAUD_DEFAULT }, .gState = HAL_UART_STATE_READY };
+static FCS_System_t fcs;
+
+static uint64_t v_ns = 0;
+static uint64_t byte_ns;
+static uint8_t *rx_dst = NULL;     // Armed by HAL_UART_Receive_IT
+
+static int fails = 0;
+static void Fail(const char *what) {
+  if (fails++ < 10) printf("FAIL %s at %.3f s\n", what, v_ns / 1e9);
+}
+
+// [Sender]
+typedef struct { uint8_t seq, reply; } Expect_t;
+static Expect_t expect[MAX_REQS];
+static unsigned n_req = 0, n_answered = 0, n_missing = 0, n_nak = 0;
+static unsigned n_junk = 0, n_junk_wrap = 0, n_junk_whole = 0;
+static uint8_t s_q[256];            // Bytes of the item being sent
+static uint8_t s_q_len = 0, s_q_pos = 0;
+static uint8_t s_q_junk = 0;
+static uint8_t s_junk_h0;           // Ring index of the junk run's first byte
+static uint8_t s_junk_wrapped = 0;
+static uint16_t s_junk_err0;        // Framing errors before the run
+static uint8_t s_resumed = 0;       // No item started since the last resume
+static uint64_t s_next_ns = UINT64_MAX; // Next byte at the ISR, UINT64_MAX while stopped
+static uint8_t s_pause = 0;         // RTS raised or XOFF received
+static unsigned s_pause_left = 0;   // Bytes still on the way after the pause
+static uint8_t s_generate = 1;      // Cleared at the end of the run
+static uint64_t s_next_junk_ns;
+static uint64_t s_sent = 0;
+
+// Framing errors the last junk run caused: one if the parser met it whole
+static void Sender_Junk_Done(void) {
+  if (n_junk == 0) return;
+  if (FCS_Serial_GetFrameErrorCount() - s_junk_err0 == 1) {
+    n_junk_whole++;
+    if (s_junk_wrapped) n_junk_wrap++;
+  }
+}
+
+static void Sender_Next_Item(void) {
+  static uint8_t seq = 0;
+  // Junk is the first item after a resume: the ring is near the low mark then
+  // and takes the whole run before the sender stops again
+  if (v_ns >= s_next_junk_ns && (s_resumed || FCS_FLOW_CTRL == FCS_FLOW_NONE)) {
+    s_next_junk_ns = v_ns + JUNK_EVERY_MS * 1000000ULL;
+    Sender_Junk_Done();
+    s_junk_err0 = FCS_Serial_GetFrameErrorCount();
+    for (unsigned i = 0; i < JUNK_LEN; i++) s_q[i] = (uint8_t)(0x80 + (i * 37) % 0x80);
+    s_q[JUNK_LEN] = 0x00;
+    s_q_len = JUNK_LEN + 1;
+    s_q_junk = 1;
+    n_junk++;
+  } else {
+    uint8_t body[FCS_PROTO_OVERHEAD + PROTO_MAX_PAYLOAD];
+    uint8_t cmd = (n_req % 3 == 0) ? FCS_CMD_TARGET_BIN : FCS_CMD_STATUS_REQ;
+    uint8_t len = 0;
+    if (cmd == FCS_CMD_TARGET_BIN) {
+      FCS_TargetRecord_t t = { 52, 'S', 34000000U + n_req * 100U, 414000000U, 1200 };
+      memcpy(&body[5], &t, sizeof(t));
+      len = sizeof(t);
+    }
+    body[1] = cmd;
+    body[2] = ++seq;
+    body[3] = (uint8_t)(n_req * 7); // Salt
+    body[4] = len;
+    FCS_Codec_Seal(&body[1], FCS_PROTO_FLAGS, NULL, 0, 0, FCS_CODEC_DIR_TO_FCS);
+    s_q_len = FCS_Codec_Frame(body, FCS_PROTO_FLAGS);
+    memcpy(s_q, body, s_q_len);
+    s_q_junk = 0;
+    if (n_req < MAX_REQS) {
+      expect[n_req].seq = seq;
+      expect[n_req].reply = (cmd == FCS_CMD_TARGET_BIN) ? FCS_CMD_FIRE_RESULT : FCS_CMD_STATUS_ACK;
+    }
+    n_req++;
+  }
+  s_q_pos = 0;
+  s_resumed = 0;
+}
+
+static int Sender_May_Send(void) {
+  if (s_pause && s_pause_left == 0) return 0;
+  return s_q_pos < s_q_len || s_generate;
+}
+
+static void Sender_Schedule(uint64_t from) {
+  s_next_ns = Sender_May_Send() ? from + byte_ns : UINT64_MAX;
+}
+
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+static void Sender_Flow(uint8_t pause, unsigned lag) {
+  if (pause == s_pause) return;
+  s_pause = pause;
+  s_pause_left = lag;
+  s_resumed = !pause;
+  if (!pause && s_next_ns == UINT64_MAX) Sender_Schedule(v_ns);
+}
+#endif
+
+// [Replies] Firmware TX as the client sees it
+static unsigned s_lag = 16;
+static uint8_t r_buf[1024];
+static unsigned r_len = 0;
+#if FCS_FLOW_CTRL == FCS_FLOW_XONXOFF
+static uint8_t r_esc = 0;
+#endif
+
+static void Reply_Frame(const uint8_t *body) {
+  // Replies come back in request order; one that does not match means the
+  // requests before it were lost
+  while (n_answered + n_missing < n_req && n_answered + n_missing < MAX_REQS) {
+    const Expect_t *e = &expect[n_answered + n_missing];
+    if (e->seq == body[1]) {
+      if (body[0] == FCS_CMD_NAK) n_nak++;
+      else if (body[0] != e->reply) Fail("reply of the wrong type");
+      n_answered++;
+      return;
+    }
+    n_missing++;
+  }
+  Fail("reply to nothing");
+}
+
+static void Reply_Byte(uint8_t b) {
+#if FCS_FLOW_CTRL == FCS_FLOW_XONXOFF
+  if (b == FCS_FLOW_XOFF || b == FCS_FLOW_XON) {
+    Sender_Flow(b == FCS_FLOW_XOFF, s_lag);
+    return;
+  }
+  if (b == FCS_FLOW_ESC) {
+    r_esc = 1;
+    return;
+  }
+  if (r_esc) {
+    b ^= 0x20;
+    r_esc = 0;
+  }
+#endif
+  if (r_len == sizeof(r_buf)) r_len = 0;
+  r_buf[r_len++] = b;
+#if FCS_PROTO_COBS
+  if (b != 0x00) return;
+  if (r_len > 1 && FCS_Codec_Unframe(r_buf, (uint8_t)(r_len - 1), FCS_CODEC_F_COBS) > 0) Reply_Frame(r_buf);
+  else if (r_len > 1) Fail("reply not decodable");
+  r_len = 0;
+#else
+  uint32_t start, n;
+  while ((n = FCS_Codec_Scan(r_buf, r_len, &start)) > 0) {
+    if (start != 0) Fail("bytes between replies");
+    Reply_Frame(&r_buf[start + 1]);
+    r_len -= start + n;
+    memmove(r_buf, &r_buf[start + n], r_len);
+  }
+#endif
+}
+
+// [Wire]
+static unsigned ring_peak = 0, n_pause = 0, n_resume = 0;
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+static uint8_t w_paused = 0;        // Flow state when the wire last looked
+#endif
+
+// Counts a resume since the last look. Call it before time passes: the
+// firmware only drains the ring until then, so the fill is the one it resumed at.
+static void Wire_Watch_Flow(void) {
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+  if (w_paused && !u_flow_paused) {
+    n_resume++;
+    if (Serial_Ring_Fill() > FCS_FLOW_LOW_WATER) Fail("resumed above the low mark");
+  }
+  w_paused = u_flow_paused;
+#endif
+}
+
+static void Sim_Clock(uint64_t ns) {
+  v_ns = ns;
+  DWT->CYCCNT = (uint32_t)(ns * (SystemCoreClock / 1000000U) / 1000U);
+}
+
+// Flow bytes the ISR or the flush wrote straight into DR
+static void Wire_Take_Dr(void) {
+  if (USART1->DR == 0) return;
+  Reply_Byte((uint8_t)USART1->DR);
+  USART1->DR = 0;
+}
+
+static void Wire_Rx(uint8_t b) {
+  if (s_q_junk && s_q_pos == 0) s_junk_h0 = u_head;
+  if (rx_dst) {
+    *rx_dst = b;
+    rx_dst = NULL;
+    FCS_UART_RxCallback(&huart1);
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+    if (!w_paused && u_flow_paused) {
+      n_pause++;
+      if (Serial_Ring_Fill() != FCS_FLOW_HIGH_WATER) Fail("paused off the high mark");
+    }
+    w_paused = u_flow_paused;
+#endif
+    Wire_Take_Dr();
+  }
+  if (Serial_Ring_Fill() > ring_peak) ring_peak = Serial_Ring_Fill();
+  if (s_q_junk && s_q_pos == s_q_len - 1) s_junk_wrapped = (u_head < s_junk_h0);
+}
+
+// Delivers every sender byte due up to 'to'
+static void Sim_Advance(uint64_t to) {
+  while (s_next_ns <= to) {
+    Sim_Clock(s_next_ns);
+    if (s_q_pos == s_q_len) Sender_Next_Item();
+    Wire_Rx(s_q[s_q_pos]);
+    s_q_pos++;
+    s_sent++;
+    if (s_pause && s_pause_left > 0) s_pause_left--;
+    Sender_Schedule(v_ns);
+  }
+  if (to > v_ns) Sim_Clock(to);
+}
+
+uint32_t HAL_GetTick(void) {
+  return (uint32_t)(v_ns / 1000000U);
+}
+
+void HAL_Delay(uint32_t ms) {
+  Wire_Watch_Flow();
+  Sim_Advance(v_ns + ms * 1000000ULL);
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init) {
+  (void)port;
+  (void)init;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state) {
+  if (state == GPIO_PIN_SET) port->ODR |= pin;
+  else port->ODR &= ~(uint32_t)pin;
+#if FCS_FLOW_CTRL == FCS_FLOW_RTSCTS
+  if (port == FCS_FLOW_RTS_PORT && pin == FCS_FLOW_RTS_PIN) Sender_Flow(state == GPIO_PIN_SET, s_lag);
+#endif
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+  byte_ns = 10000000000ULL / huart->Init.BaudRate;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size, uint32_t timeout) {
+  (void)timeout;
+  Wire_Watch_Flow();
+  huart->gState = 0; // Busy: an XOFF from the ISR waits in u_flow_pending
+  for (uint16_t i = 0; i < size; i++) {
+    Sim_Advance(v_ns + byte_ns);
+    Reply_Byte(data[i]);
+  }
+  huart->gState = HAL_UART_STATE_READY;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size) {
+  (void)huart;
+  (void)size;
+  rx_dst = data;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart) {
+  (void)huart;
+  rx_dst = NULL;
+  return HAL_OK;
+}
+
+void Error_Handler(void) {
+  Fail("Error_Handler");
+}
+
+// [Other modules] Not part of the link path
+void BMP280_Read_All(BMP280_Data_t *data) {
+  data->temperature = 15.0f;
+  data->pressure = 1013.25f;
+}
+
+void Input_Read_All(ADC_HandleTypeDef *hadc, uint32_t *dest) {
+  (void)hadc;
+  for (int i = 0; i < 4; i++) dest[i] = 4000;
+}
+
+KeyState Input_Scan(uint32_t adc_value) {
+  (void)adc_value;
+  return KEY_NONE;
+}
+
+uint32_t FCS_Stack_Hwm(void) { return 0; }
+uint32_t FCS_Stack_Budget(void) { return 0; }
+
+int main(int argc, char **argv) {
+  if (argc > 1) s_lag = (unsigned)atoi(argv[1]);
+  unsigned seconds = (argc > 2) ? (unsigned)atoi(argv[2]) : 60;
+  if (seconds == 0) seconds = 60;
+
+  FCS_Init_System(&fcs);
+  fcs.user_pos = (UTM_Coord_t){ .zone = 52, .band = 'S', .easting = 333712, .northing = 4132894, .altitude = 100 };
+  fcs.env.air_temp = 15.0f;
+  fcs.env.air_pressure = 1013.25f;
+  fcs.fire.charge = 5;
+  HAL_UART_Init(&huart1);
+  FCS_Serial_Start(&huart1);
+
+  uint64_t end_ns = seconds * 1000000000ULL;
+  uint64_t next_lcd = LCD_PERIOD_MS * 1000000ULL;
+  s_next_junk_ns = JUNK_EVERY_MS * 1000000ULL / 2;
+  Sender_Schedule(0);
+
+  while (v_ns < end_ns + DRAIN_MS * 1000000ULL) {
+    if (v_ns >= end_ns && s_generate) {
+      s_generate = 0;
+      if (s_next_ns == UINT64_MAX) Sender_Schedule(v_ns);
+    }
+
+    // [Pass] Serial task, then the panel push when due
+    FCS_Task_Serial(&fcs, &huart1);
+    Wire_Watch_Flow();
+    Wire_Take_Dr();
+    Sim_Advance(v_ns + PASS_COST_US * 1000ULL);
+    if (v_ns >= next_lcd) {
+      Sim_Advance(v_ns + LCD_PUSH_MS * 1000000ULL);
+      next_lcd = v_ns + (LCD_PERIOD_MS - LCD_PUSH_MS) * 1000000ULL;
+    }
+
+    // [Sleep] Until a byte arrives, the push is due or timed work is
+    if (FCS_Serial_Busy()) continue;
+    uint64_t wake = next_lcd;
+    if (s_next_ns < wake) wake = s_next_ns;
+    if (FCS_Serial_Timed() && v_ns + FCS_TASK_SERIAL_MS * 1000000ULL < wake) wake = v_ns + FCS_TASK_SERIAL_MS * 1000000ULL;
+    Sim_Advance(wake);
+  }
+
+  Sender_Junk_Done();
+  unsigned unanswered = n_req - n_answered - n_missing;
+  uint32_t overflow = FCS_Serial_GetOverflowCount();
+  uint16_t frame_err = FCS_Serial_GetFrameErrorCount();
+  printf("Link UART, %u s at %u baud, %s, %s, lag %u bytes (model, not measured on hardware)\n", seconds,
+         (unsigned)huart1.Init.BaudRate, FCS_PROTO_COBS ? "COBS" : "STX/ETX",
+         FCS_FLOW_CTRL == FCS_FLOW_RTSCTS ? "RTS/CTS" : FCS_FLOW_CTRL == FCS_FLOW_XONXOFF ? "XON/XOFF" : "no flow control",
+         s_lag);
+  printf("  sent %llu bytes (%.0f %% of the line): %u requests, %u junk runs (%u met whole, %u of them wrapped)\n",
+         (unsigned long long)s_sent, s_sent * byte_ns * 100.0 / v_ns, n_req, n_junk, n_junk_whole, n_junk_wrap);
+  printf("  answered %u, lost %u, NAK %u, unanswered %u; ring overflow %u bytes, framing errors %u\n", n_answered,
+         n_missing, n_nak, unanswered, (unsigned)overflow, (unsigned)frame_err);
+  printf("  ring peak %u of %u (marks %u/%u), paused %u times, resumed %u\n", ring_peak, RING_SIZE - 1,
+         (unsigned)FCS_FLOW_HIGH_WATER, (unsigned)FCS_FLOW_LOW_WATER, n_pause, n_resume);
+
+#if FCS_FLOW_CTRL != FCS_FLOW_NONE
+  // [1]
+  if (overflow != 0) Fail("ring overflow");
+  if (n_missing != 0 || unanswered != 0 || n_nak != 0) Fail("requests lost or refused");
+  if (n_req > MAX_REQS) Fail("run too long for the reply check");
+  // [2]
+  if (n_pause == 0 || n_resume == 0) Fail("flow control never engaged");
+  if (ring_peak <= sizeof(p_raw)) Fail("ring never filled past p_raw");
+#if FCS_PROTO_COBS
+  // [3]
+  if (frame_err < n_junk || frame_err > 2 * n_junk) Fail("junk runs not dropped as framing errors");
+  if (n_junk_wrap == 0 && s_lag >= 16) Fail("no junk run met whole across the ring end");
+#endif
+  printf(fails ? "FAILED (%d)\n" : "ok\n", fails);
+  return fails ? 1 : 0;
+#else
+  printf("no flow control: loss reported only\n");
+  return 0;
+#endif
+}